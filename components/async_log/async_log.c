@@ -0,0 +1,287 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_memory_utils.h"
+#endif
+
+#include "async_log.h"
+#include "async_log_priv.h"
+
+// Menuconfig - Async log
+#define ASYNC_LOG_RING_LEN              CONFIG_ASYNC_LOG_RING_LEN
+#define ASYNC_LOG_DRAIN_PERIOD_MS       CONFIG_ASYNC_LOG_DRAIN_PERIOD_MS
+#define ASYNC_LOG_TASK_PRIORITY         CONFIG_ASYNC_LOG_TASK_PRIORITY
+#if CONFIG_IDF_TARGET_LINUX
+// Build linux - a task é uma pthread, o mínimo é PTHREAD_STACK_MIN
+#define ASYNC_LOG_TASK_STACK            16384
+#else
+#define ASYNC_LOG_TASK_STACK            3072
+#endif
+#define ASYNC_LOG_LINE_MAX              256
+
+_Static_assert((ASYNC_LOG_RING_LEN & (ASYNC_LOG_RING_LEN - 1)) == 0, "ASYNC_LOG_RING_LEN must be a power of two");
+
+#if !CONFIG_ASYNC_LOG_FORMAT_BINARY
+static const char *TAG = "async_log";
+#endif
+
+// Fila MPSC limitada sem locks: produtores reservam posições por CAS, a task de
+// drenagem é o único consumidor.
+static async_log_record_t s_ring[ASYNC_LOG_RING_LEN];
+static atomic_uint s_enqueue_pos;
+static uint32_t s_dequeue_pos;
+static atomic_uint s_dropped;
+
+// Geração do nível guardado pelos macros - começa em 1, o cache zerado do .bss nunca bate
+uint32_t async_log_level_generation = 1;
+
+// String que continua válida depois da chamada. No chip: constante na flash (literais, esp_err_to_name).
+// Build linux: dentro da imagem do executável (rodata, data, bss) - fora dela é pilha ou heap
+#if CONFIG_IDF_TARGET_LINUX
+extern char __executable_start[], end[];
+#endif
+
+static bool async_log_string_static(uintptr_t str) {
+
+#if CONFIG_IDF_TARGET_LINUX
+    return str >= (uintptr_t)__executable_start && str < (uintptr_t)end;
+#else
+    return esp_ptr_in_drom((const void *)str);
+#endif
+}
+
+void async_log_write(esp_log_level_t level, const char *tag, const char *format, int nargs, uint8_t strings, const uintptr_t *args) {
+
+    uint32_t pos = atomic_load_explicit(&s_enqueue_pos, memory_order_relaxed);
+    async_log_record_t *record;
+
+    for (;;) {
+        uint32_t index = pos & (ASYNC_LOG_RING_LEN - 1);
+        record = &s_ring[index];
+        int32_t diff = (int32_t)(atomic_load_explicit(&record->sequence, memory_order_acquire) + index - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s_enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Ring cheio - descarta em vez de bloquear o produtor
+            atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+            return;
+        } else {
+            pos = atomic_load_explicit(&s_enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    record->timestamp = esp_log_timestamp();
+    record->level = level;
+    record->tag = tag;
+    record->format = format;
+    record->nargs = nargs > ASYNC_LOG_MAX_ARGS ? ASYNC_LOG_MAX_ARGS : nargs;
+    record->strings = strings;
+    memcpy(record->args, args, record->nargs * sizeof(uintptr_t));
+
+    // A drenagem lê a string depois - pilha ou heap podem já ter sido liberados
+    for (int i = 0; i < record->nargs; i++) {
+        if ((strings & (1 << i)) && record->args[i] != 0 && !async_log_string_static(record->args[i])) {
+            record->args[i] = (uintptr_t)"(string volátil)";
+        }
+    }
+
+    atomic_store_explicit(&record->sequence, pos + 1 - (pos & (ASYNC_LOG_RING_LEN - 1)), memory_order_release);
+}
+
+uint32_t async_log_dropped(void) {
+
+    return atomic_load_explicit(&s_dropped, memory_order_relaxed);
+}
+
+void async_log_level_set(const char *tag, esp_log_level_t level) {
+
+    esp_log_level_set(tag, level);
+    __atomic_fetch_add(&async_log_level_generation, 1, __ATOMIC_RELAXED);
+}
+
+#if !CONFIG_ASYNC_LOG_FORMAT_BINARY
+static char async_log_level_letter(esp_log_level_t level) {
+
+    switch (level) {
+        case ESP_LOG_ERROR:     return 'E';
+        case ESP_LOG_WARN:      return 'W';
+        case ESP_LOG_INFO:      return 'I';
+        case ESP_LOG_DEBUG:     return 'D';
+        default:                return 'V';
+    }
+}
+
+// Tamanho do argumento pelo modificador da conversão
+typedef enum {
+    ASYNC_LOG_ARG_INT,              // nenhum, hh, h
+    ASYNC_LOG_ARG_LONG,             // l
+    ASYNC_LOG_ARG_LONG_LONG,        // ll, j
+    ASYNC_LOG_ARG_SIZE,             // z, t
+} async_log_arg_size_t;
+
+// Formata uma conversão com o tipo que ela espera. O argumento guardado é uintptr_t - passar ele direto ao
+// snprintf é UB para %d, %u e %x onde uintptr_t tem 64 bits (build linux)
+static int async_log_format_arg(char *out, size_t size, const char *spec, char conversion, async_log_arg_size_t arg_size, uintptr_t arg) {
+
+    switch (conversion) {
+        case 'd':
+        case 'i':
+            switch (arg_size) {
+                case ASYNC_LOG_ARG_INT:         return snprintf(out, size, spec, (int)(intptr_t)arg);
+                case ASYNC_LOG_ARG_LONG:        return snprintf(out, size, spec, (long)(intptr_t)arg);
+                case ASYNC_LOG_ARG_LONG_LONG:   return snprintf(out, size, spec, (long long)(intptr_t)arg);
+                default:                        return snprintf(out, size, spec, (ptrdiff_t)(intptr_t)arg);
+            }
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            switch (arg_size) {
+                case ASYNC_LOG_ARG_INT:         return snprintf(out, size, spec, (unsigned int)arg);
+                case ASYNC_LOG_ARG_LONG:        return snprintf(out, size, spec, (unsigned long)arg);
+                case ASYNC_LOG_ARG_LONG_LONG:   return snprintf(out, size, spec, (unsigned long long)arg);
+                default:                        return snprintf(out, size, spec, (size_t)arg);
+            }
+        case 'c':
+            return snprintf(out, size, spec, (int)arg);
+        case 's':
+            return snprintf(out, size, spec, arg != 0 ? (const char *)arg : "(null)");
+        case 'p':
+            return snprintf(out, size, spec, (void *)arg);
+        default:
+            return snprintf(out, size, "?");      // Ponto flutuante não cabe no registro
+    }
+}
+
+// printf com os argumentos do registro, uma conversão por vez. Retorna o tamanho escrito (sempre < size)
+static size_t async_log_format(char *out, size_t size, const char *format, const uintptr_t *args, int nargs) {
+
+    size_t len = 0;
+    int next = 0;
+
+    while (*format != '\0' && len + 1 < size) {
+        if (*format != '%') {
+            out[len++] = *format++;
+            continue;
+        }
+
+        // Flags, largura, precisão e modificador - '*' consome um argumento
+        char spec[24];
+        size_t spec_len = 0;
+        async_log_arg_size_t arg_size = ASYNC_LOG_ARG_INT;
+
+        spec[spec_len++] = *format++;
+        while (*format != '\0' && strchr("-+ #0123456789.*hlLjzt", *format) != NULL && spec_len < sizeof(spec) - 12) {
+            char c = *format++;
+            if (c == '*') {
+                spec_len += snprintf(&spec[spec_len], sizeof(spec) - spec_len, "%d", next < nargs ? (int)(intptr_t)args[next++] : 0);
+                continue;
+            }
+            if (c == 'l') {
+                arg_size = arg_size == ASYNC_LOG_ARG_LONG ? ASYNC_LOG_ARG_LONG_LONG : ASYNC_LOG_ARG_LONG;
+            } else if (c == 'j') {
+                arg_size = ASYNC_LOG_ARG_LONG_LONG;
+            } else if (c == 'z' || c == 't') {
+                arg_size = ASYNC_LOG_ARG_SIZE;
+            }
+            spec[spec_len++] = c;
+        }
+        if (*format == '\0') {
+            break;
+        }
+
+        char conversion = *format++;
+        if (conversion == '%') {
+            out[len++] = '%';
+            continue;
+        }
+        spec[spec_len++] = conversion;
+        spec[spec_len] = '\0';
+
+        int n = async_log_format_arg(&out[len], size - len, spec, conversion, arg_size, next < nargs ? args[next] : 0);
+        next++;
+        if (n > 0) {
+            len += (size_t)n < size - len ? (size_t)n : size - len - 1;
+        }
+    }
+    out[len] = '\0';
+    return len;
+}
+
+// Formata o registro e entrega aos sinks. Os argumentos que sobram são ignorados pelo formato
+static void async_log_emit(const async_log_record_t *record) {
+
+    static char line[ASYNC_LOG_LINE_MAX];
+
+    int prefix = snprintf(line, sizeof(line), "%c (%" PRIu32 ") %s: ",
+                          async_log_level_letter(record->level), record->timestamp, record->tag);
+    if (prefix > (int)sizeof(line) - 2) {
+        prefix = sizeof(line) - 2;
+    }
+    int len = prefix + async_log_format(line + prefix, sizeof(line) - prefix - 1, record->format, record->args, record->nargs);
+    line[len++] = '\n';
+    line[len] = '\0';
+
+    fwrite(line, 1, len, stdout);
+#if CONFIG_ASYNC_LOG_UDP_SYSLOG
+    async_log_udp_write_line(record->level, record->tag, line + prefix, len - prefix);
+#endif
+}
+#endif
+
+// Task - Drena o ring na prioridade baixa
+static void task_async_log_drain(void *pvParameters) {
+
+    uint32_t reported_drops = 0;
+
+    for (;;) {
+        async_log_record_t *record = &s_ring[s_dequeue_pos & (ASYNC_LOG_RING_LEN - 1)];
+        uint32_t index = s_dequeue_pos & (ASYNC_LOG_RING_LEN - 1);
+
+        if (atomic_load_explicit(&record->sequence, memory_order_acquire) + index == s_dequeue_pos + 1) {
+#if CONFIG_ASYNC_LOG_FORMAT_BINARY
+            async_log_binary_emit(record);
+#else
+            async_log_emit(record);
+#endif
+            // Libera o slot para a próxima volta do ring
+            atomic_store_explicit(&record->sequence, s_dequeue_pos + ASYNC_LOG_RING_LEN - index, memory_order_release);
+            s_dequeue_pos++;
+            continue;
+        }
+
+        // Ring vazio - relata descartes, esvazia os sinks e dorme
+        uint32_t drops = async_log_dropped();
+        if (drops != reported_drops) {
+#if CONFIG_ASYNC_LOG_FORMAT_BINARY
+            async_log_binary_dropped(drops);
+#else
+            ESP_LOGW(TAG, "%" PRIu32 " registros descartados (ring cheio)", drops - reported_drops);
+#endif
+            reported_drops = drops;
+        }
+        fflush(stdout);
+#if CONFIG_ASYNC_LOG_UDP_SYSLOG
+        async_log_udp_flush();
+#endif
+        vTaskDelay(pdMS_TO_TICKS(ASYNC_LOG_DRAIN_PERIOD_MS));
+    }
+}
+
+void async_log_init(void) {
+
+#if CONFIG_ASYNC_LOG_FORMAT_BINARY
+    async_log_binary_init();
+#endif
+    xTaskCreate(task_async_log_drain, "async_log", ASYNC_LOG_TASK_STACK, NULL, ASYNC_LOG_TASK_PRIORITY, NULL);
+}
@@ -0,0 +1,261 @@
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "driver/uart.h"
+#include "driver/uart_vfs.h"
+#endif
+
+#include "async_log_priv.h"
+
+// Formato binário (decodificado por tools/async_log_decode.py a partir do ELF):
+//
+//   frame:    0xA5 | len (u8) | corpo (len bytes) | xor8 do corpo
+//   registro: nível << 4 | nargs, máscara de strings, índice da tag, varint ID do
+//             formato, varint delta do timestamp (ms), argumentos
+//   controle: 0x00, tipo, dados (TAG, DROPS, TIME)
+//
+// Argumentos: inteiros em zigzag varint (valor como int32), strings em varint do
+// tamanho + bytes. A máscara (bit i = argumento i é string) vem do _Generic dos macros,
+// e o decoder usa ela em vez de adivinhar pelo %s do formato. O ID do formato é o
+// endereço da string na seção .async_log_fmt, que não ocupa flash.
+//
+// Texto na mesma UART: o ESP_LOG passa por async_log_binary_vprintf, que monta a linha
+// inteira e escreve com uma chamada só - o mutex de TX do driver (ou o lock do stdout, na
+// build linux) impede que texto e frame se misturem. O printf comum vai pelo VFS com o
+// driver da UART, uma escrita por vez. O que sobrar fora de um frame o decoder repassa
+// como texto: sync, tamanho e xor8 precisam bater para um trecho virar frame.
+#define ASYNC_LOG_FRAME_SYNC            0xA5
+#define ASYNC_LOG_FRAME_BODY_MAX        255
+#define ASYNC_LOG_CTRL_TAG              1
+#define ASYNC_LOG_CTRL_DROPS            2
+#define ASYNC_LOG_CTRL_TIME             3
+
+// Cache de tags - a tag é anunciada uma vez (endereço) e depois referenciada pelo índice
+#define ASYNC_LOG_TAG_CACHE_LEN         16
+// Reanuncia tags e o tempo absoluto de tempos em tempos (decoder conectado depois do boot)
+#define ASYNC_LOG_RESYNC_MS             10000
+
+#if !CONFIG_IDF_TARGET_LINUX
+#define ASYNC_LOG_UART_PORT             CONFIG_ESP_CONSOLE_UART_NUM
+#define ASYNC_LOG_UART_TX_BUFFER        1024
+#endif
+
+// Linha do ESP_LOG montada na stack - maiores vão para o heap
+#define ASYNC_LOG_TEXT_LINE_MAX         160
+
+static const char *s_tag_cache[ASYNC_LOG_TAG_CACHE_LEN];
+static uint8_t s_tag_next;
+static uint32_t s_last_timestamp;
+static uint32_t s_last_resync;
+static bool s_synced;
+
+typedef struct {
+    uint8_t data[2 + ASYNC_LOG_FRAME_BODY_MAX + 1];
+    size_t len;
+} async_log_frame_t;
+
+static void frame_begin(async_log_frame_t *frame) {
+
+    frame->data[0] = ASYNC_LOG_FRAME_SYNC;
+    frame->len = 2;
+}
+
+static size_t frame_room(const async_log_frame_t *frame) {
+
+    return 2 + ASYNC_LOG_FRAME_BODY_MAX - frame->len;
+}
+
+static void frame_put(async_log_frame_t *frame, uint8_t byte) {
+
+    if (frame_room(frame) > 0) {
+        frame->data[frame->len++] = byte;
+    }
+}
+
+static void frame_put_varint(async_log_frame_t *frame, uint32_t value) {
+
+    while (value >= 0x80) {
+        frame_put(frame, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    frame_put(frame, (uint8_t)value);
+}
+
+static void frame_put_string(async_log_frame_t *frame, const char *str) {
+
+    if (str == NULL) {
+        str = "(null)";
+    }
+
+    // Trunca para caber no frame (1 byte reservado para o tamanho)
+    size_t len = strlen(str);
+    size_t room = frame_room(frame);
+    room = room > 1 ? room - 1 : 0;
+    if (len > room) {
+        len = room;
+    }
+    if (len > 127) {
+        len = 127;
+    }
+
+    frame_put(frame, (uint8_t)len);
+    memcpy(&frame->data[frame->len], str, len);
+    frame->len += len;
+}
+
+// Uma escrita atômica no console - frame inteiro ou linha de texto inteira
+static void async_log_binary_write(const void *data, size_t len) {
+
+#if CONFIG_IDF_TARGET_LINUX
+    // Build linux - frames no stdout (redirecione para um arquivo e use --file no decoder)
+    fwrite(data, 1, len, stdout);
+#else
+    uart_write_bytes(ASYNC_LOG_UART_PORT, data, len);
+#endif
+}
+
+// Fecha o frame (tamanho + checksum) e entrega aos sinks
+static void frame_send(async_log_frame_t *frame) {
+
+    uint8_t checksum = 0;
+    for (size_t i = 2; i < frame->len; i++) {
+        checksum ^= frame->data[i];
+    }
+    frame->data[1] = (uint8_t)(frame->len - 2);
+    frame->data[frame->len++] = checksum;
+
+    async_log_binary_write(frame->data, frame->len);
+#if CONFIG_ASYNC_LOG_UDP_SYSLOG
+    async_log_udp_append(frame->data, frame->len);
+#endif
+}
+
+static void async_log_send_time(uint32_t timestamp) {
+
+    async_log_frame_t frame;
+    frame_begin(&frame);
+    frame_put(&frame, 0);
+    frame_put(&frame, ASYNC_LOG_CTRL_TIME);
+    frame_put_varint(&frame, timestamp);
+    frame_send(&frame);
+}
+
+// Índice da tag no cache. Tag nova ocupa a próxima posição e é anunciada ao decoder
+static uint8_t async_log_tag_index(const char *tag) {
+
+    for (uint8_t i = 0; i < ASYNC_LOG_TAG_CACHE_LEN; i++) {
+        if (s_tag_cache[i] == tag) {
+            return i;
+        }
+    }
+
+    uint8_t index = s_tag_next;
+    s_tag_next = (s_tag_next + 1) % ASYNC_LOG_TAG_CACHE_LEN;
+    s_tag_cache[index] = tag;
+
+    uint32_t address = (uint32_t)(uintptr_t)tag;
+    async_log_frame_t frame;
+    frame_begin(&frame);
+    frame_put(&frame, 0);
+    frame_put(&frame, ASYNC_LOG_CTRL_TAG);
+    frame_put(&frame, index);
+    for (int i = 0; i < 4; i++) {
+        frame_put(&frame, (uint8_t)(address >> (8 * i)));
+    }
+    frame_send(&frame);
+
+    return index;
+}
+
+void async_log_binary_emit(const async_log_record_t *record) {
+
+    // Primeiro registro ou resync periódico - tempo absoluto e cache de tags zerado
+    if (!s_synced || record->timestamp - s_last_resync >= ASYNC_LOG_RESYNC_MS) {
+        memset(s_tag_cache, 0, sizeof(s_tag_cache));
+        s_tag_next = 0;
+        s_last_resync = record->timestamp;
+        s_last_timestamp = record->timestamp;
+        s_synced = true;
+        async_log_send_time(record->timestamp);
+    }
+
+    uint8_t tag_index = async_log_tag_index(record->tag);
+
+    async_log_frame_t frame;
+    frame_begin(&frame);
+    frame_put(&frame, (uint8_t)((record->level << 4) | record->nargs));
+    frame_put(&frame, record->strings);
+    frame_put(&frame, tag_index);
+    frame_put_varint(&frame, (uint32_t)(uintptr_t)record->format);
+    frame_put_varint(&frame, record->timestamp - s_last_timestamp);
+    s_last_timestamp = record->timestamp;
+
+    for (int i = 0; i < record->nargs; i++) {
+        if (record->strings & (1 << i)) {
+            frame_put_string(&frame, (const char *)record->args[i]);
+        } else {
+            // Zigzag do valor como int32 - o decoder reinterpreta pelo especificador (%d, %u, %x)
+            int32_t value = (int32_t)record->args[i];
+            frame_put_varint(&frame, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+        }
+    }
+
+    frame_send(&frame);
+}
+
+void async_log_binary_dropped(uint32_t total) {
+
+    async_log_frame_t frame;
+    frame_begin(&frame);
+    frame_put(&frame, 0);
+    frame_put(&frame, ASYNC_LOG_CTRL_DROPS);
+    frame_put_varint(&frame, total);
+    frame_send(&frame);
+}
+
+// ESP_LOG síncrono (e o do próprio IDF) - a linha inteira em uma escrita, nunca no meio de um frame
+static int async_log_binary_vprintf(const char *format, va_list args) {
+
+    char line[ASYNC_LOG_TEXT_LINE_MAX];
+    va_list copy;
+
+    va_copy(copy, args);
+    int len = vsnprintf(line, sizeof(line), format, copy);
+    va_end(copy);
+    if (len < 0) {
+        return len;
+    }
+    if (len < (int)sizeof(line)) {
+        async_log_binary_write(line, len);
+        return len;
+    }
+
+    // Linha longa - heap; sem memória sai truncada
+    char *heap_line = malloc(len + 1);
+    if (heap_line == NULL) {
+        async_log_binary_write(line, sizeof(line) - 1);
+        return sizeof(line) - 1;
+    }
+    vsnprintf(heap_line, len + 1, format, args);
+    async_log_binary_write(heap_line, len);
+    free(heap_line);
+    return len;
+}
+
+void async_log_binary_init(void) {
+
+#if !CONFIG_IDF_TARGET_LINUX
+    // Driver da UART do console - escrita sem a conversão de '\n' do VFS
+    if (!uart_is_driver_installed(ASYNC_LOG_UART_PORT)) {
+        uart_driver_install(ASYNC_LOG_UART_PORT, 256, ASYNC_LOG_UART_TX_BUFFER, 0, NULL, 0);
+    }
+
+    // printf pelo driver também - cada escrita passa pelo mesmo mutex de TX dos frames
+    uart_vfs_dev_use_driver(ASYNC_LOG_UART_PORT);
+#endif
+    esp_log_set_vprintf(async_log_binary_vprintf);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "esp_log.h"
+
+#include "async_log.h"
+
+// Registro não formatado. sequence guarda (sequência - índice do slot), assim o ring
+// zerado do .bss já está pronto para uso antes mesmo do async_log_init().
+typedef struct {
+    atomic_uint sequence;
+    uint32_t timestamp;
+    uint8_t level;
+    uint8_t nargs;
+    uint8_t strings;
+    const char *tag;
+    const char *format;
+    uintptr_t args[ASYNC_LOG_MAX_ARGS];
+} async_log_record_t;
+
+// Formato binário - codifica o registro e envia para a UART / UDP
+void async_log_binary_init(void);
+void async_log_binary_emit(const async_log_record_t *record);
+void async_log_binary_dropped(uint32_t total);
+
+// Sink UDP (formato binário) - acumula frames em um datagrama e envia em lote
+void async_log_udp_append(const void *data, size_t len);
+
+// Sink UDP syslog (formato texto) - um datagrama "<PRI>tag: mensagem" por registro
+void async_log_udp_write_line(esp_log_level_t level, const char *tag, const char *message, size_t len);
+
+// Envia o lote de frames pendente (chamado quando o ring esvazia)
+void async_log_udp_flush(void);
@@ -0,0 +1,91 @@
+#include <string.h>
+#include "esp_log.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#else
+#include "lwip/sockets.h"
+#endif
+
+#include "async_log_priv.h"
+
+// Menuconfig - Sink UDP syslog
+#define SYSLOG_HOST                     CONFIG_ASYNC_LOG_UDP_HOST
+#define SYSLOG_PORT                     CONFIG_ASYNC_LOG_UDP_PORT
+#define SYSLOG_BATCH_SIZE               CONFIG_ASYNC_LOG_UDP_BATCH_SIZE
+#define SYSLOG_FACILITY_LOCAL0          16
+
+static char s_batch[SYSLOG_BATCH_SIZE];      // Binário: lote de frames. Texto: o datagrama do registro da vez
+static size_t s_batch_len;
+static int s_sock = -1;
+
+static int syslog_severity(esp_log_level_t level) {
+
+    switch (level) {
+        case ESP_LOG_ERROR:     return 3;
+        case ESP_LOG_WARN:      return 4;
+        case ESP_LOG_INFO:      return 6;
+        default:                return 7;
+    }
+}
+
+// Um datagrama - socket criado sob demanda, antes de existir um IP o envio simplesmente falha
+static void async_log_udp_send(const void *data, size_t len) {
+
+    if (s_sock < 0) {
+        s_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    }
+
+    if (s_sock >= 0) {
+        struct sockaddr_in dest = {
+            .sin_family = AF_INET,
+            .sin_port = htons(SYSLOG_PORT),
+            .sin_addr.s_addr = inet_addr(SYSLOG_HOST),
+        };
+        sendto(s_sock, data, len, 0, (struct sockaddr *)&dest, sizeof(dest));
+    }
+}
+
+void async_log_udp_flush(void) {
+
+    if (s_batch_len == 0) {
+        return;
+    }
+
+    async_log_udp_send(s_batch, s_batch_len);
+    s_batch_len = 0;
+}
+
+void async_log_udp_append(const void *data, size_t len) {
+
+    if (s_batch_len + len > sizeof(s_batch)) {
+        async_log_udp_flush();
+        if (len > sizeof(s_batch)) {
+            len = sizeof(s_batch);
+        }
+    }
+
+    memcpy(&s_batch[s_batch_len], data, len);
+    s_batch_len += len;
+}
+
+// Syslog sobre UDP (RFC 5426) - uma mensagem por datagrama, sem o '\n' do console
+void async_log_udp_write_line(esp_log_level_t level, const char *tag, const char *message, size_t len) {
+
+    while (len > 0 && message[len - 1] == '\n') {
+        len--;
+    }
+
+    int header_len = snprintf(s_batch, sizeof(s_batch), "<%d>%s: ", SYSLOG_FACILITY_LOCAL0 * 8 + syslog_severity(level), tag);
+    if (header_len >= (int)sizeof(s_batch)) {
+        header_len = sizeof(s_batch) - 1;
+    }
+    if (header_len + len > sizeof(s_batch)) {
+        len = sizeof(s_batch) - header_len;
+    }
+
+    memcpy(&s_batch[header_len], message, len);
+    async_log_udp_send(s_batch, header_len + len);
+}
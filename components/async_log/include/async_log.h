@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_ASYNC_LOG_ENABLE
+
+// Número máximo de argumentos por registro
+#define ASYNC_LOG_MAX_ARGS              6
+
+// Enfileira um registro sem formatar. A formatação (ou a codificação binária) acontece na
+// task de drenagem. Argumentos devem ser inteiros de até 32 bits ou ponteiros para
+// strings que continuam válidas depois da chamada (tags, literais) - string na pilha ou no
+// heap sai como "(string volátil)". Ponto flutuante não é suportado (sai "?"). strings marca
+// quais argumentos são strings (bit i = argumento i), calculado em tempo de compilação pelos macros.
+void async_log_write(esp_log_level_t level, const char *tag, const char *format, int nargs, uint8_t strings, const uintptr_t *args);
+
+// Cria a task de drenagem. Registros gravados antes do init ficam no ring
+void async_log_init(void);
+
+// Registros descartados porque o ring estava cheio
+uint32_t async_log_dropped(void);
+
+// Troca o nível de uma tag em tempo de execução (esp_log_level_set) e invalida o nível guardado
+// em cada chamada dos macros - use no lugar do esp_log_level_set para tags dos ASYNC_LOGx
+void async_log_level_set(const char *tag, esp_log_level_t level);
+
+// Nível da tag em tempo de execução, consultado antes de reservar o slot no ring. Cada chamada dos
+// macros guarda (geração << 3 | nível) em uma palavra: o esp_log_level_get, que pega o lock do log,
+// só roda na primeira vez e depois de um async_log_level_set
+extern uint32_t async_log_level_generation;
+
+static inline int async_log_level_enabled(esp_log_level_t level, const char *tag, uint32_t *cache) {
+
+    uint32_t generation = __atomic_load_n(&async_log_level_generation, __ATOMIC_RELAXED);
+    uint32_t cached = __atomic_load_n(cache, __ATOMIC_RELAXED);
+
+    if ((cached >> 3) != generation) {
+        cached = (generation << 3) | (uint32_t)esp_log_level_get(tag);
+        __atomic_store_n(cache, cached, __ATOMIC_RELAXED);
+    }
+    return (esp_log_level_t)(cached & 7) >= level;
+}
+
+// Contagem de argumentos (0..6) e conversão de cada um para uintptr_t
+#define ASYNC_LOG_NARGS(...)            ASYNC_LOG_NARGS_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define ASYNC_LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, N, ...) N
+#define ASYNC_LOG_CONCAT(a, b)          ASYNC_LOG_CONCAT_(a, b)
+#define ASYNC_LOG_CONCAT_(a, b)         a##b
+#define ASYNC_LOG_CAST_0()
+#define ASYNC_LOG_CAST_1(a)             (uintptr_t)(a)
+#define ASYNC_LOG_CAST_2(a, ...)        (uintptr_t)(a), ASYNC_LOG_CAST_1(__VA_ARGS__)
+#define ASYNC_LOG_CAST_3(a, ...)        (uintptr_t)(a), ASYNC_LOG_CAST_2(__VA_ARGS__)
+#define ASYNC_LOG_CAST_4(a, ...)        (uintptr_t)(a), ASYNC_LOG_CAST_3(__VA_ARGS__)
+#define ASYNC_LOG_CAST_5(a, ...)        (uintptr_t)(a), ASYNC_LOG_CAST_4(__VA_ARGS__)
+#define ASYNC_LOG_CAST_6(a, ...)        (uintptr_t)(a), ASYNC_LOG_CAST_5(__VA_ARGS__)
+
+// Argumentos que são strings (1 bit por argumento) - o formato binário copia o conteúdo,
+// os demais vão como inteiros de 32 bits
+#define ASYNC_LOG_IS_STRING(x)          _Generic((x), char *: 1, const char *: 1, default: 0)
+#define ASYNC_LOG_STRINGS_0()           0
+#define ASYNC_LOG_STRINGS_1(a)          ASYNC_LOG_IS_STRING(a)
+#define ASYNC_LOG_STRINGS_2(a, ...)     (ASYNC_LOG_IS_STRING(a) | (ASYNC_LOG_STRINGS_1(__VA_ARGS__) << 1))
+#define ASYNC_LOG_STRINGS_3(a, ...)     (ASYNC_LOG_IS_STRING(a) | (ASYNC_LOG_STRINGS_2(__VA_ARGS__) << 1))
+#define ASYNC_LOG_STRINGS_4(a, ...)     (ASYNC_LOG_IS_STRING(a) | (ASYNC_LOG_STRINGS_3(__VA_ARGS__) << 1))
+#define ASYNC_LOG_STRINGS_5(a, ...)     (ASYNC_LOG_IS_STRING(a) | (ASYNC_LOG_STRINGS_4(__VA_ARGS__) << 1))
+#define ASYNC_LOG_STRINGS_6(a, ...)     (ASYNC_LOG_IS_STRING(a) | (ASYNC_LOG_STRINGS_5(__VA_ARGS__) << 1))
+
+#if CONFIG_ASYNC_LOG_FORMAT_BINARY
+// Formato binário - a string de formato vai para a seção .async_log_fmt, que não é
+// carregada na flash (INFO no async_log.ld). O endereço dela na seção é o ID do formato.
+#define ASYNC_LOG_FORMAT_REF(format)    ({                                                  \
+        static const char async_log_fmt_[] __attribute__((section(".async_log_fmt"), used)) = format; \
+        async_log_fmt_;                                                                     \
+    })
+#else
+#define ASYNC_LOG_FORMAT_REF(format)    (format)
+#endif
+
+// Nível máximo da compilação (LOG_LOCAL_LEVEL) e nível da tag em tempo de execução, como o ESP_LOGx.
+// O nível guardado vale para a tag da chamada - a tag de cada chamada é fixa (o TAG do arquivo)
+#define ASYNC_LOG_LEVEL(level, tag, format, ...) do {                                               \
+        static uint32_t async_log_level_cache_;                                                     \
+        if (LOG_LOCAL_LEVEL >= (level) && async_log_level_enabled((level), (tag), &async_log_level_cache_)) { \
+            async_log_write((level), (tag), ASYNC_LOG_FORMAT_REF(format), ASYNC_LOG_NARGS(__VA_ARGS__), \
+                ASYNC_LOG_CONCAT(ASYNC_LOG_STRINGS_, ASYNC_LOG_NARGS(__VA_ARGS__))(__VA_ARGS__),    \
+                (const uintptr_t[]){ 0, ASYNC_LOG_CONCAT(ASYNC_LOG_CAST_, ASYNC_LOG_NARGS(__VA_ARGS__))(__VA_ARGS__) } + 1); \
+        }                                                                                           \
+    } while (0)
+
+#define ASYNC_LOGE(tag, format, ...)    ASYNC_LOG_LEVEL(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ASYNC_LOGW(tag, format, ...)    ASYNC_LOG_LEVEL(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ASYNC_LOGI(tag, format, ...)    ASYNC_LOG_LEVEL(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ASYNC_LOGD(tag, format, ...)    ASYNC_LOG_LEVEL(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+
+#else
+
+// Async log desabilitado - os macros caem no ESP_LOG síncrono
+static inline void async_log_init(void) {}
+static inline uint32_t async_log_dropped(void) { return 0; }
+static inline void async_log_level_set(const char *tag, esp_log_level_t level) { esp_log_level_set(tag, level); }
+
+#define ASYNC_LOGE(tag, format, ...)    ESP_LOGE(tag, format, ##__VA_ARGS__)
+#define ASYNC_LOGW(tag, format, ...)    ESP_LOGW(tag, format, ##__VA_ARGS__)
+#define ASYNC_LOGI(tag, format, ...)    ESP_LOGI(tag, format, ##__VA_ARGS__)
+#define ASYNC_LOGD(tag, format, ...)    ESP_LOGD(tag, format, ##__VA_ARGS__)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+"""Decoder do async_log no formato binário (CONFIG_ASYNC_LOG_FORMAT_BINARY).
+
+Lê as strings de formato da seção .async_log_fmt e as tags da memória
+de leitura do ELF da build e converte os frames de volta para linhas iguais às do
+ESP_LOG. Bytes fora de um frame (bootloader, printf, ESP_LOG) passam direto.
+
+Exemplos:
+    async_log_decode.py build/tcp-server-02.elf --serial /dev/ttyUSB0 --baud 115200
+    async_log_decode.py build/tcp-server-02.elf --udp 514
+    async_log_decode.py build/tcp-server-02.elf --file captura.bin
+
+Requer pyelftools (já instalado com o ESP-IDF) e pyserial para --serial.
+"""
+
+import argparse
+import re
+import socket
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+FRAME_SYNC = 0xA5
+CTRL_TAG = 1
+CTRL_DROPS = 2
+CTRL_TIME = 3
+
+LEVEL_LETTER = {1: 'E', 2: 'W', 3: 'I', 4: 'D', 5: 'V'}
+LEVEL_COLOR = {1: '\033[0;31m', 2: '\033[0;33m', 3: '\033[0;32m'}
+COLOR_RESET = '\033[0m'
+
+# Conversões do printf em C -> formato do Python (modificadores de tamanho removidos)
+C_SPEC = re.compile(r'%([-+ #0]*)(\d+|\*)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diuxXcspo%])')
+
+
+class Image:
+    """Strings de formato e tags resolvidas a partir do ELF."""
+
+    def __init__(self, path):
+        self._file = open(path, 'rb')
+        self._elf = ELFFile(self._file)
+        fmt = self._elf.get_section_by_name('.async_log_fmt')
+        if fmt is None:
+            sys.exit('{}: seção .async_log_fmt não encontrada (build sem CONFIG_ASYNC_LOG_FORMAT_BINARY?)'.format(path))
+        self._fmt_base = fmt['sh_addr']
+        self._fmt_data = fmt.data()
+
+    def format(self, fmt_id):
+        offset = fmt_id - self._fmt_base
+        if offset < 0 or offset >= len(self._fmt_data):
+            return None
+        end = self._fmt_data.index(b'\0', offset)
+        return self._fmt_data[offset:end].decode('utf-8', 'replace')
+
+    def string_at(self, address):
+        for section in self._elf.iter_sections():
+            start = section['sh_addr']
+            if section['sh_type'] == 'SHT_NOBITS' or not start:
+                continue
+            if start <= address < start + section['sh_size']:
+                data = section.data()[address - start:]
+                return data[:data.index(b'\0')].decode('utf-8', 'replace')
+        return '0x{:08x}'.format(address)
+
+
+def read_varint(body, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = body[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+
+
+def c_format(fmt, args):
+    """Aplica um formato do printf em C com os argumentos já decodificados."""
+    it = iter(args)
+
+    def convert(match):
+        flags, width, precision, _, conv = match.groups()
+        if conv == '%':
+            return '%'
+        if width == '*':
+            width = str(next(it, 0))
+        value = next(it, 0)
+        if conv == 'p':
+            conv, flags = 'x', '#' + (flags or '')
+        elif conv in 'iu':
+            conv = 'd'
+        elif conv == 'c':
+            value = chr(value & 0xFF)
+        spec = '%' + (flags or '') + (width or '') + ('.' + precision if precision else '') + conv
+        try:
+            return spec % value
+        except (TypeError, ValueError):
+            return str(value)
+
+    return C_SPEC.sub(convert, fmt)
+
+
+class Decoder:
+
+    def __init__(self, image, color):
+        self.image = image
+        self.color = color
+        self.tags = {}
+        self.timestamp = 0
+        self.pending = bytearray()
+
+    def feed(self, data, out):
+        self.pending += data
+        buf = self.pending
+        pos = 0
+        while pos < len(buf):
+            sync = buf.find(bytes([FRAME_SYNC]), pos)
+            if sync < 0:
+                out.write(buf[pos:].decode('utf-8', 'replace'))
+                pos = len(buf)
+                break
+            if sync > pos:
+                out.write(buf[pos:sync].decode('utf-8', 'replace'))
+                pos = sync
+            if len(buf) - pos < 2 or len(buf) - pos < buf[pos + 1] + 3:
+                break
+            length = buf[pos + 1]
+            body = bytes(buf[pos + 2:pos + 2 + length])
+            checksum = 0
+            for byte in body:
+                checksum ^= byte
+            if length == 0 or checksum != buf[pos + 2 + length]:
+                # Não é um frame - 0xA5 perdido no meio de texto
+                out.write(buf[pos:pos + 1].decode('utf-8', 'replace'))
+                pos += 1
+                continue
+            self._frame(body, out)
+            pos += length + 3
+        del buf[:pos]
+        out.flush()
+
+    def _frame(self, body, out):
+        try:
+            if body[0] == 0:
+                self._control(body, out)
+            else:
+                self._record(body, out)
+        except (IndexError, ValueError) as err:
+            out.write('async_log: frame inválido ({})\n'.format(err))
+
+    def _control(self, body, out):
+        kind = body[1]
+        if kind == CTRL_TAG:
+            address = int.from_bytes(body[3:7], 'little')
+            self.tags[body[2]] = self.image.string_at(address)
+        elif kind == CTRL_TIME:
+            self.timestamp, _ = read_varint(body, 2)
+        elif kind == CTRL_DROPS:
+            total, _ = read_varint(body, 2)
+            out.write('W ({}) async_log: {} registros descartados no total (ring cheio)\n'.format(self.timestamp, total))
+
+    def _record(self, body, out):
+        level = body[0] >> 4
+        nargs = body[0] & 0x0F
+        strings = body[1]
+        tag = self.tags.get(body[2], '?')
+        fmt_id, pos = read_varint(body, 3)
+        delta, pos = read_varint(body, pos)
+        self.timestamp += delta
+
+        fmt = self.image.format(fmt_id)
+        if fmt is None:
+            out.write('async_log: formato desconhecido 0x{:x} (ELF de outra build?)\n'.format(fmt_id))
+            return
+
+        # Strings pela máscara do frame (a mesma que o target usou para codificar). Os
+        # inteiros são reinterpretados pelo especificador do formato (%d, %u, %x)
+        convs = [m.group(5) for m in C_SPEC.finditer(fmt) if m.group(5) != '%']
+        args = []
+        for i in range(nargs):
+            conv = convs[i] if i < len(convs) else 'u'
+            if strings & (1 << i):
+                length, pos = read_varint(body, pos)
+                args.append(body[pos:pos + length].decode('utf-8', 'replace'))
+                pos += length
+            else:
+                value, pos = read_varint(body, pos)
+                value = (value >> 1) ^ -(value & 1)
+                if conv not in 'di':
+                    value &= 0xFFFFFFFF
+                args.append(value)
+
+        line = '{} ({}) {}: {}'.format(LEVEL_LETTER.get(level, 'V'), self.timestamp, tag, c_format(fmt, args))
+        if self.color and level in LEVEL_COLOR:
+            line = LEVEL_COLOR[level] + line + COLOR_RESET
+        out.write(line + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decodifica o log binário do async_log')
+    parser.add_argument('elf', help='ELF da build que gerou o log')
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--serial', metavar='PORTA', help='porta serial (ex.: /dev/ttyUSB0)')
+    source.add_argument('--udp', metavar='PORTA', type=int, help='escuta os frames enviados pelo sink UDP')
+    source.add_argument('--file', metavar='ARQUIVO', help='captura bruta ("-" para stdin)')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--color', action='store_true', help='colore as linhas como o ESP_LOG')
+    args = parser.parse_args()
+
+    decoder = Decoder(Image(args.elf), args.color)
+    out = sys.stdout
+
+    try:
+        if args.serial:
+            import serial
+            port = serial.Serial(args.serial, args.baud, timeout=0.1)
+            while True:
+                decoder.feed(port.read(4096), out)
+        elif args.udp:
+            sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            sock.bind(('0.0.0.0', args.udp))
+            while True:
+                data, _ = sock.recvfrom(2048)
+                decoder.feed(data, out)
+        else:
+            stream = sys.stdin.buffer if args.file == '-' else open(args.file, 'rb')
+            while True:
+                data = stream.read(4096)
+                if not data:
+                    break
+                decoder.feed(data, out)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
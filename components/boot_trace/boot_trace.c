@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#endif
+
+#include "boot_trace.h"
+
+// Tags de depuração:
+static const char *TAG_BOOT_TRACE = "DEBUG - BOOT-TRACE";
+
+#if CONFIG_BOOT_TRACE_ENABLE
+
+// Menuconfig - Histórico
+#define BOOT_TRACE_HISTORY              CONFIG_BOOT_TRACE_HISTORY
+
+#define BOOT_TRACE_MAGIC                0x42545243      // "BTRC"
+#define BOOT_TRACE_LINE_SIZE            192
+
+// Build linux - sem RTC: o histórico é só o processo atual
+#if CONFIG_IDF_TARGET_LINUX
+#define BOOT_TRACE_NOINIT
+#else
+#define BOOT_TRACE_NOINIT               RTC_NOINIT_ATTR
+#endif
+
+// Um boot - 40 bytes
+typedef struct {
+    uint32_t stamp_us[BOOT_TRACE_PHASE_COUNT];  // 0 = fase não aconteceu
+    uint32_t boot;                              // Número do boot desde que a RTC foi zerada
+    uint8_t reset_reason;                       // esp_reset_reason_t
+    uint8_t reserved[3];
+} boot_trace_record_t;
+
+// Memória RTC sem inicialização - vale só com o magic e o mesmo tamanho (BOOT_TRACE_HISTORY)
+typedef struct {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t head;                              // Slot do boot atual
+    uint32_t boots;
+    boot_trace_record_t records[BOOT_TRACE_HISTORY];
+} boot_trace_rtc_t;
+
+static BOOT_TRACE_NOINIT boot_trace_rtc_t s_rtc;
+static boot_trace_record_t *s_current;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const s_phase_names[BOOT_TRACE_PHASE_COUNT] = {
+    [BOOT_TRACE_APP_MAIN] = "app_main",
+    [BOOT_TRACE_NVS] = "nvs",
+    [BOOT_TRACE_NETIF] = "netif",
+    [BOOT_TRACE_WIFI_INIT] = "wifi_init",
+    [BOOT_TRACE_WIFI_START] = "wifi_start",
+    [BOOT_TRACE_ASSOCIATED] = "assoc",
+    [BOOT_TRACE_GOT_IP] = "ip",
+    [BOOT_TRACE_LISTEN] = "listen",
+};
+
+// Instante atual em µs, nunca 0 (0 marca fase que não aconteceu)
+static uint32_t boot_trace_now(void) {
+
+#if CONFIG_IDF_TARGET_LINUX
+    // Build linux - relativo à primeira chamada, que é o boot_trace_start
+    static int64_t base_us = -1;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t now_us = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    if (base_us < 0) {
+        base_us = now_us;
+    }
+    now_us -= base_us;
+#else
+    int64_t now_us = esp_timer_get_time();
+#endif
+    return now_us > 0 ? (uint32_t)now_us : 1;
+}
+
+static const char *boot_trace_reset_name(uint8_t reason) {
+
+#if CONFIG_IDF_TARGET_LINUX
+    return "host";
+#else
+    switch (reason) {
+    case ESP_RST_POWERON:   return "energia";
+    case ESP_RST_SW:        return "software";
+    case ESP_RST_PANIC:     return "panic";
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:       return "watchdog";
+    case ESP_RST_DEEPSLEEP: return "deep sleep";
+    case ESP_RST_BROWNOUT:  return "brownout";
+    default:                return "outro";
+    }
+#endif
+}
+
+// Uma linha por boot: instante do app_main, depois quanto cada fase levou desde a anterior
+// (@ms para a que terminou antes da anterior)
+static void boot_trace_print_record(const char *label, const boot_trace_record_t *record) {
+
+    char line[BOOT_TRACE_LINE_SIZE];
+    int len = snprintf(line, sizeof(line), "%s %lu (%s):", label, (unsigned long)record->boot,
+                       boot_trace_reset_name(record->reset_reason));
+    uint32_t last_us = 0;
+
+    for (int phase = 0; phase < BOOT_TRACE_PHASE_COUNT && len < (int)sizeof(line); phase++) {
+        uint32_t stamp_us = record->stamp_us[phase];
+        if (stamp_us == 0) {
+            len += snprintf(line + len, sizeof(line) - len, " %s -", s_phase_names[phase]);
+        } else if (phase == BOOT_TRACE_APP_MAIN) {
+            len += snprintf(line + len, sizeof(line) - len, " %s %lu", s_phase_names[phase], (unsigned long)(stamp_us / 1000));
+            last_us = stamp_us;
+        } else if (stamp_us < last_us) {
+            // Estágios em paralelo - fase fora de ordem (listen antes do IP, por exemplo) sai com o instante absoluto
+            len += snprintf(line + len, sizeof(line) - len, " %s @%lu", s_phase_names[phase], (unsigned long)(stamp_us / 1000));
+        } else {
+            len += snprintf(line + len, sizeof(line) - len, " %s +%lu", s_phase_names[phase], (unsigned long)((stamp_us - last_us) / 1000));
+            last_us = stamp_us;
+        }
+    }
+    if (len < (int)sizeof(line)) {
+        snprintf(line + len, sizeof(line) - len, " = %lu ms", (unsigned long)(last_us / 1000));
+    }
+
+    // Log síncrono - a linha é montada na pilha e só roda no fim do boot
+    ESP_LOGI(TAG_BOOT_TRACE, "%s", line);
+}
+
+void boot_trace_start(void) {
+
+#if CONFIG_IDF_TARGET_LINUX
+    uint8_t reset_reason = 0;
+#else
+    uint8_t reset_reason = esp_reset_reason();
+#endif
+
+    // Energia: a RTC veio com lixo. Sem o magic ou com outro tamanho, o histórico é descartado
+    bool valid = s_rtc.magic == BOOT_TRACE_MAGIC && s_rtc.size == sizeof(s_rtc) && s_rtc.head < BOOT_TRACE_HISTORY;
+#if !CONFIG_IDF_TARGET_LINUX
+    valid = valid && reset_reason != ESP_RST_POWERON && reset_reason != ESP_RST_BROWNOUT;
+#endif
+    if (!valid) {
+        memset(&s_rtc, 0, sizeof(s_rtc));
+        s_rtc.magic = BOOT_TRACE_MAGIC;
+        s_rtc.size = sizeof(s_rtc);
+        s_rtc.head = BOOT_TRACE_HISTORY - 1;
+    }
+
+    s_rtc.head = (s_rtc.head + 1) % BOOT_TRACE_HISTORY;
+    s_rtc.boots++;
+    s_current = &s_rtc.records[s_rtc.head];
+    memset(s_current, 0, sizeof(*s_current));
+    s_current->boot = s_rtc.boots;
+    s_current->reset_reason = reset_reason;
+    s_current->stamp_us[BOOT_TRACE_APP_MAIN] = boot_trace_now();
+}
+
+bool boot_trace_mark(boot_trace_phase_t phase) {
+
+    if (s_current == NULL || phase >= BOOT_TRACE_PHASE_COUNT) {
+        return false;
+    }
+
+    uint32_t now_us = boot_trace_now();
+    bool first = false;
+
+    // Vários shards fazem listen() - só o primeiro conta
+    taskENTER_CRITICAL(&s_lock);
+    if (s_current->stamp_us[phase] == 0) {
+        s_current->stamp_us[phase] = now_us;
+        first = true;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return first;
+}
+
+uint32_t boot_trace_get(boot_trace_phase_t phase) {
+
+    return s_current != NULL && phase < BOOT_TRACE_PHASE_COUNT ? s_current->stamp_us[phase] : 0;
+}
+
+void boot_trace_print(void) {
+
+    if (s_current == NULL) {
+        return;
+    }
+
+    boot_trace_record_t record;
+    taskENTER_CRITICAL(&s_lock);
+    record = *s_current;
+    taskEXIT_CRITICAL(&s_lock);
+    boot_trace_print_record("boot", &record);
+
+    // Boots anteriores, do mais recente para o mais antigo
+    uint32_t stored = s_rtc.boots < BOOT_TRACE_HISTORY ? s_rtc.boots : BOOT_TRACE_HISTORY;
+    for (uint32_t i = 1; i < stored; i++) {
+        uint32_t slot = (s_rtc.head + BOOT_TRACE_HISTORY - i) % BOOT_TRACE_HISTORY;
+        boot_trace_print_record("  antes", &s_rtc.records[slot]);
+    }
+}
+
+#else
+
+void boot_trace_start(void) {
+
+}
+
+bool boot_trace_mark(boot_trace_phase_t phase) {
+
+    return false;
+}
+
+uint32_t boot_trace_get(boot_trace_phase_t phase) {
+
+    return 0;
+}
+
+void boot_trace_print(void) {
+
+    ESP_LOGD(TAG_BOOT_TRACE, "Desabilitado no menuconfig");
+}
+
+#endif
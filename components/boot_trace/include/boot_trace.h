@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Linha do tempo do boot até a rede: cada fase guarda o instante em que terminou (µs desde
+// o início do esp_timer), só na primeira vez - reconexões não sobrescrevem o boot. O
+// registro fica na RTC junto com os boots anteriores.
+//
+// Onde marcar:
+//   início do app_main                 -> boot_trace_start()
+//   depois de cada init                -> boot_trace_mark(BOOT_TRACE_NVS ... WIFI_START)
+//   WIFI_EVENT_STA_CONNECTED           -> boot_trace_mark(BOOT_TRACE_ASSOCIATED)
+//   IP_EVENT_STA_GOT_IP (DHCP ou fixo) -> boot_trace_mark(BOOT_TRACE_GOT_IP)
+//   depois do primeiro listen()        -> boot_trace_mark(BOOT_TRACE_LISTEN)
+
+typedef enum {
+    BOOT_TRACE_APP_MAIN,
+    BOOT_TRACE_NVS,             // nvs_flash_init
+    BOOT_TRACE_NETIF,           // esp_netif_init
+    BOOT_TRACE_WIFI_INIT,       // esp_wifi_init
+    BOOT_TRACE_WIFI_START,      // esp_wifi_start
+    BOOT_TRACE_ASSOCIATED,      // WIFI_EVENT_STA_CONNECTED
+    BOOT_TRACE_GOT_IP,          // IP_EVENT_STA_GOT_IP
+    BOOT_TRACE_LISTEN,          // Primeiro listen()
+    BOOT_TRACE_PHASE_COUNT
+} boot_trace_phase_t;
+
+// Abre o registro deste boot na RTC e marca o app_main. Chamar antes de qualquer marcação
+void boot_trace_start(void);
+
+// Marca o fim da fase. Retorna true só na primeira marcação da fase neste boot
+bool boot_trace_mark(boot_trace_phase_t phase);
+
+// Instante da fase neste boot em µs, 0 se ela ainda não aconteceu
+uint32_t boot_trace_get(boot_trace_phase_t phase);
+
+// Mostra a linha do tempo deste boot e a dos boots anteriores guardados na RTC
+void boot_trace_print(void);
+
+#ifdef __cplusplus
+}
+#endif
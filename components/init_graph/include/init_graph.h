@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Orquestrador de inicialização: cada estágio declara de quais depende e roda em um pool de
+// tasks assim que eles terminam, em paralelo com os outros estágios prontos. O app_main monta
+// o grafo, chama init_graph_start e segue - o fim chega pelo callback on_done (ou por
+// init_graph_wait, para quem preferir esperar).
+//
+// Um estágio síncrono retorna o resultado do run. Um assíncrono (Wi-Fi esperando IP, sensor
+// aquecendo) dispara o trabalho, retorna INIT_STAGE_PENDING e libera a task do pool; quem
+// termina o trabalho chama init_graph_complete(id, err) de qualquer task ou callback.
+// Se um estágio falha, os que dependem dele (direta ou indiretamente) não rodam.
+
+#define INIT_GRAPH_MAX_STAGES           16
+#define INIT_STAGE_PENDING              ESP_ERR_NOT_FINISHED
+#define INIT_STAGE_BIT(id)              (1u << (id))
+
+typedef uint32_t init_stage_id_t;       // Índice no vetor de estágios
+
+typedef struct {
+    const char *name;
+    esp_err_t (*run)(init_stage_id_t id, void *arg);
+    void *arg;
+    uint32_t after;                     // INIT_STAGE_BIT dos estágios que precisam terminar antes
+} init_stage_t;
+
+// Roda uma vez, em uma task do pool. failed: INIT_STAGE_BIT dos estágios que falharam ou não
+// rodaram por dependência
+typedef void (*init_graph_done_t)(uint32_t failed, void *ctx);
+
+// Valida o grafo (dependências existentes, sem ciclo) e dispara os estágios sem dependência.
+// stages precisa continuar válido até o fim (static const). on_done pode ser NULL. Uma vez por boot
+esp_err_t init_graph_start(const init_stage_t *stages, size_t count, init_graph_done_t on_done, void *ctx);
+
+// Fim de um estágio que retornou INIT_STAGE_PENDING
+void init_graph_complete(init_stage_id_t id, esp_err_t err);
+
+// Estágio já terminou com sucesso, sem bloquear
+bool init_graph_is_done(init_stage_id_t id);
+
+// Espera o grafo inteiro por no máximo timeout. Retorna true se todos os estágios passaram
+bool init_graph_wait(TickType_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
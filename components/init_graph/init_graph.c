@@ -0,0 +1,290 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "async_log.h"
+
+#include "init_graph.h"
+
+// Menuconfig - Pool de estágios
+#define GRAPH_WORKERS                   CONFIG_INIT_GRAPH_WORKERS
+#define GRAPH_WORKER_PRIORITY           CONFIG_INIT_GRAPH_WORKER_PRIORITY
+
+// Build linux - as tasks são pthreads e o mínimo é PTHREAD_STACK_MIN
+#if CONFIG_IDF_TARGET_LINUX
+#define GRAPH_WORKER_STACK              16384
+#else
+#define GRAPH_WORKER_STACK              CONFIG_INIT_GRAPH_WORKER_STACK
+#endif
+
+// Sentinelas na fila do pool
+#define GRAPH_STOP                      UINT32_MAX      // A task do pool termina
+#define GRAPH_FINISH                    (UINT32_MAX - 1) // Grafo resolvido - on_done roda na task do pool
+
+// Bits do init_graph_wait
+#define GRAPH_DONE_BIT                  BIT0
+#define GRAPH_OK_BIT                    BIT1
+
+// Tags de depuração:
+static const char *TAG_INIT_GRAPH = "DEBUG - INIT-GRAPH";
+
+static const init_stage_t *s_stages;
+static uint32_t s_count;
+static uint32_t s_all;                  // INIT_STAGE_BIT de todos os estágios
+static uint32_t s_started;              // Enviados ao pool ou descartados por dependência
+static uint32_t s_done;
+static uint32_t s_failed;
+static bool s_finished;
+static uint32_t s_begin_ms;
+static uint32_t s_start_ms[INIT_GRAPH_MAX_STAGES];
+static init_graph_done_t s_on_done;
+static void *s_ctx;
+static QueueHandle_t s_ready;
+static EventGroupHandle_t s_events;
+static TaskHandle_t s_workers[GRAPH_WORKERS];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t graph_now_ms(void) {
+
+    return pdTICKS_TO_MS(xTaskGetTickCount());
+}
+
+// Function - Collect ready stages (com s_lock)
+// Marca como iniciados os estágios com todas as dependências prontas e descarta, em cadeia,
+// os que dependem de um estágio que falhou
+static uint32_t graph_collect(uint32_t *skipped) {
+
+    uint32_t ready = 0;
+    bool changed;
+
+    *skipped = 0;
+    do {
+        changed = false;
+        for (uint32_t id = 0; id < s_count; id++) {
+            uint32_t bit = INIT_STAGE_BIT(id);
+            if (s_started & bit) {
+                continue;
+            }
+            if (s_stages[id].after & s_failed) {
+                s_started |= bit;
+                s_failed |= bit;
+                *skipped |= bit;
+                changed = true;
+            } else if ((s_stages[id].after & ~s_done) == 0) {
+                s_started |= bit;
+                ready |= bit;
+            }
+        }
+    } while (changed);
+    return ready;
+}
+
+// Envia ao pool o que ficou pronto e fecha o grafo quando todos os estágios terminaram
+static void graph_advance(void) {
+
+    uint32_t skipped;
+
+    taskENTER_CRITICAL(&s_lock);
+    uint32_t ready = graph_collect(&skipped);
+    bool finished = !s_finished && (s_done | s_failed) == s_all;
+    s_finished |= finished;
+    uint32_t failed = s_failed;
+    taskEXIT_CRITICAL(&s_lock);
+
+    for (uint32_t id = 0; id < s_count; id++) {
+        if (skipped & INIT_STAGE_BIT(id)) {
+            ASYNC_LOGW(TAG_INIT_GRAPH, "Estágio %s não roda - dependência falhou", s_stages[id].name);
+        }
+        if (ready & INIT_STAGE_BIT(id)) {
+            s_start_ms[id] = graph_now_ms();
+            xQueueSend(s_ready, &id, portMAX_DELAY);
+        }
+    }
+
+    if (!finished) {
+        return;
+    }
+
+    ASYNC_LOGI(TAG_INIT_GRAPH, "Inicialização completa em %lu ms - %d estágio(s) com falha",
+               (unsigned long)(graph_now_ms() - s_begin_ms), __builtin_popcount(failed));
+
+    // O último estágio pode fechar no event loop ou em um callback de stack curta - o on_done roda
+    // na task do pool, que depois é encerrado com uma sentinela por task
+    uint32_t sentinel = GRAPH_FINISH;
+    xQueueSend(s_ready, &sentinel, portMAX_DELAY);
+    sentinel = GRAPH_STOP;
+    for (int i = 0; i < GRAPH_WORKERS; i++) {
+        xQueueSend(s_ready, &sentinel, portMAX_DELAY);
+    }
+}
+
+// Function - Graph finished (task do pool)
+static void graph_finish(void) {
+
+    taskENTER_CRITICAL(&s_lock);
+    uint32_t failed = s_failed;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (s_on_done != NULL) {
+        s_on_done(failed, s_ctx);
+    }
+    xEventGroupSetBits(s_events, GRAPH_DONE_BIT | (failed == 0 ? GRAPH_OK_BIT : 0));
+}
+
+// Task - Stage worker
+static void task_init_graph(void *pvParameters) {
+
+    init_stage_id_t id;
+
+    for (;;) {
+        xQueueReceive(s_ready, &id, portMAX_DELAY);
+        if (id == GRAPH_STOP) {
+            break;
+        }
+        if (id == GRAPH_FINISH) {
+            graph_finish();
+            continue;
+        }
+
+        esp_err_t err = s_stages[id].run(id, s_stages[id].arg);
+        if (err != INIT_STAGE_PENDING) {
+            init_graph_complete(id, err);
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+// Dependências dentro do grafo e sem ciclo: resolve em ordem topológica até não avançar mais
+static bool graph_is_valid(const init_stage_t *stages, uint32_t count, uint32_t all) {
+
+    uint32_t resolved = 0;
+    bool changed = true;
+
+    for (uint32_t id = 0; id < count; id++) {
+        if ((stages[id].after & ~all) != 0 || (stages[id].after & INIT_STAGE_BIT(id)) != 0 || stages[id].run == NULL) {
+            return false;
+        }
+    }
+    while (changed) {
+        changed = false;
+        for (uint32_t id = 0; id < count; id++) {
+            if (!(resolved & INIT_STAGE_BIT(id)) && (stages[id].after & ~resolved) == 0) {
+                resolved |= INIT_STAGE_BIT(id);
+                changed = true;
+            }
+        }
+    }
+    return resolved == all;
+}
+
+// Function - Rollback init_graph_start
+// Nenhum estágio foi enviado ainda: as tasks do pool estão bloqueadas na fila vazia e são apagadas
+// pelo handle antes da fila - uma sentinela deixaria a task ainda dentro do xQueueReceive da fila apagada
+static void graph_rollback(void) {
+
+    for (int i = 0; i < GRAPH_WORKERS; i++) {
+        if (s_workers[i] != NULL) {
+            vTaskDelete(s_workers[i]);
+            s_workers[i] = NULL;
+        }
+    }
+    if (s_ready != NULL) {
+        vQueueDelete(s_ready);
+        s_ready = NULL;
+    }
+    if (s_events != NULL) {
+        vEventGroupDelete(s_events);
+        s_events = NULL;
+    }
+    s_stages = NULL;
+    s_count = 0;
+}
+
+esp_err_t init_graph_start(const init_stage_t *stages, size_t count, init_graph_done_t on_done, void *ctx) {
+
+    if (stages == NULL || count == 0 || count > INIT_GRAPH_MAX_STAGES || s_stages != NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t all = INIT_STAGE_BIT(count) - 1;
+    if (!graph_is_valid(stages, count, all)) {
+        ASYNC_LOGE(TAG_INIT_GRAPH, "Grafo inválido - dependência inexistente ou ciclo");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Cabe todo estágio e todas as sentinelas - o xQueueSend nunca bloqueia
+    s_ready = xQueueCreate(count + GRAPH_WORKERS + 1, sizeof(init_stage_id_t));
+    s_events = xEventGroupCreate();
+    if (s_ready == NULL || s_events == NULL) {
+        graph_rollback();
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_stages = stages;
+    s_count = count;
+    s_all = all;
+    s_on_done = on_done;
+    s_ctx = ctx;
+    s_begin_ms = graph_now_ms();
+
+    for (int i = 0; i < GRAPH_WORKERS; i++) {
+        if (xTaskCreate(task_init_graph, "init_graph", GRAPH_WORKER_STACK, NULL, GRAPH_WORKER_PRIORITY, &s_workers[i]) != pdPASS) {
+            ASYNC_LOGE(TAG_INIT_GRAPH, "Falha ao criar a task %d do pool", i);
+            s_workers[i] = NULL;
+            graph_rollback();
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    graph_advance();
+    return ESP_OK;
+}
+
+void init_graph_complete(init_stage_id_t id, esp_err_t err) {
+
+    if (id >= s_count) {
+        return;
+    }
+
+    uint32_t bit = INIT_STAGE_BIT(id);
+    taskENTER_CRITICAL(&s_lock);
+    bool first = ((s_done | s_failed) & bit) == 0;
+    if (first) {
+        if (err == ESP_OK) {
+            s_done |= bit;
+        } else {
+            s_failed |= bit;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    if (!first) {
+        return;
+    }
+
+    uint32_t elapsed_ms = graph_now_ms() - s_start_ms[id];
+    if (err == ESP_OK) {
+        ASYNC_LOGI(TAG_INIT_GRAPH, "Estágio %s pronto em %lu ms", s_stages[id].name, (unsigned long)elapsed_ms);
+    } else {
+        ASYNC_LOGW(TAG_INIT_GRAPH, "Estágio %s falhou em %lu ms: %s", s_stages[id].name, (unsigned long)elapsed_ms, esp_err_to_name(err));
+    }
+    graph_advance();
+}
+
+bool init_graph_is_done(init_stage_id_t id) {
+
+    taskENTER_CRITICAL(&s_lock);
+    bool done = id < s_count && (s_done & INIT_STAGE_BIT(id)) != 0;
+    taskEXIT_CRITICAL(&s_lock);
+    return done;
+}
+
+bool init_graph_wait(TickType_t timeout) {
+
+    if (s_events == NULL) {
+        return false;
+    }
+    EventBits_t bits = xEventGroupWaitBits(s_events, GRAPH_DONE_BIT, pdFALSE, pdTRUE, timeout);
+    return (bits & GRAPH_OK_BIT) != 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Papel de cada task criada pelos labs - o perfil (Kconfig) define core e prioridade
+typedef enum {
+    TASK_PROFILE_ROLE_SERVER,       // Task do servidor (accept)
+    TASK_PROFILE_ROLE_CLIENT,       // Tasks por cliente e workers do pool
+    TASK_PROFILE_ROLE_EVENT_LOOP,   // Event loop e seus shards
+    TASK_PROFILE_ROLE_APP,          // LED, blink e demais tasks da aplicação
+    TASK_PROFILE_ROLE_COUNT,
+} task_profile_role_t;
+
+typedef struct {
+    BaseType_t core;                // tskNO_AFFINITY ou o core
+    UBaseType_t priority;
+} task_profile_t;
+
+// Core e prioridade do papel no perfil ativo. Em chips de um core o core vira tskNO_AFFINITY
+const task_profile_t *task_profile_get(task_profile_role_t role);
+
+// Core da i-ésima task do papel (ex.: shard i do event loop). Com core fixo no perfil,
+// (core + index) % núcleos; sem afinidade, index % núcleos - as réplicas sempre se espalham
+BaseType_t task_profile_core(task_profile_role_t role, int index);
+
+// xTaskCreatePinnedToCore com o core e a prioridade do papel
+BaseType_t task_profile_create(TaskFunction_t task, const char *name, uint32_t stack_size,
+                               void *arg, task_profile_role_t role, TaskHandle_t *handle);
+
+// Nome do perfil ativo (para logs e resultados de benchmark)
+const char *task_profile_name(void);
+
+// Mostra a tabela do perfil e onde estão as tasks do Wi-Fi e da tcpip (sdkconfig). Avisa
+// se a tcpip não estiver no core que o perfil espera
+void task_profile_log(void);
+
+#ifdef __cplusplus
+}
+#endif
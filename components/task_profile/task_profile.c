@@ -0,0 +1,134 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_task.h"
+#endif
+
+#include "task_profile.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+// Build linux - sem tcpip do lwIP, mesma prioridade que ela teria no ESP32
+#define TASK_PROFILE_TCPIP_PRIORITY     (configMAX_PRIORITIES - 7)
+#else
+#define TASK_PROFILE_TCPIP_PRIORITY     ESP_TASK_TCPIP_PRIO
+#endif
+
+// Chips de um core (ESP32-C3, build linux) - o perfil vira só prioridades
+#if portNUM_PROCESSORS > 1
+#define TASK_PROFILE_PIN(core)          ((BaseType_t)(core))
+#else
+#define TASK_PROFILE_PIN(core)          tskNO_AFFINITY
+#endif
+
+// Core do Kconfig (-1 = sem afinidade)
+#define TASK_PROFILE_CORE(core)         ((core) < 0 ? tskNO_AFFINITY : TASK_PROFILE_PIN(core))
+
+// Tags de depuração:
+static const char *TAG_TASK_PROFILE = "DEBUG - TASK-PROFILE";
+
+#if CONFIG_TASK_PROFILE_SPLIT
+#define TASK_PROFILE_NAME               "split"
+#define TASK_PROFILE_TCPIP_CORE         0
+static const task_profile_t s_profile[TASK_PROFILE_ROLE_COUNT] = {
+    [TASK_PROFILE_ROLE_SERVER]     = { .core = TASK_PROFILE_PIN(1), .priority = 5 },
+    [TASK_PROFILE_ROLE_CLIENT]     = { .core = TASK_PROFILE_PIN(1), .priority = 5 },
+    [TASK_PROFILE_ROLE_EVENT_LOOP] = { .core = TASK_PROFILE_PIN(1), .priority = 5 },
+    [TASK_PROFILE_ROLE_APP]        = { .core = TASK_PROFILE_PIN(1), .priority = 1 },
+};
+#elif CONFIG_TASK_PROFILE_LATENCY
+#define TASK_PROFILE_NAME               "latency"
+#define TASK_PROFILE_TCPIP_CORE         0
+// Logo abaixo da tcpip - acima das tasks da aplicação, sem preemptar a pilha de rede
+static const task_profile_t s_profile[TASK_PROFILE_ROLE_COUNT] = {
+    [TASK_PROFILE_ROLE_SERVER]     = { .core = TASK_PROFILE_PIN(0), .priority = TASK_PROFILE_TCPIP_PRIORITY - 1 },
+    [TASK_PROFILE_ROLE_CLIENT]     = { .core = TASK_PROFILE_PIN(0), .priority = TASK_PROFILE_TCPIP_PRIORITY - 1 },
+    [TASK_PROFILE_ROLE_EVENT_LOOP] = { .core = TASK_PROFILE_PIN(0), .priority = TASK_PROFILE_TCPIP_PRIORITY - 1 },
+    [TASK_PROFILE_ROLE_APP]        = { .core = TASK_PROFILE_PIN(1), .priority = 1 },
+};
+#elif CONFIG_TASK_PROFILE_CUSTOM
+#define TASK_PROFILE_NAME               "custom"
+static const task_profile_t s_profile[TASK_PROFILE_ROLE_COUNT] = {
+    [TASK_PROFILE_ROLE_SERVER]     = { TASK_PROFILE_CORE(CONFIG_TASK_PROFILE_SERVER_CORE), CONFIG_TASK_PROFILE_SERVER_PRIORITY },
+    [TASK_PROFILE_ROLE_CLIENT]     = { TASK_PROFILE_CORE(CONFIG_TASK_PROFILE_CLIENT_CORE), CONFIG_TASK_PROFILE_CLIENT_PRIORITY },
+    [TASK_PROFILE_ROLE_EVENT_LOOP] = { TASK_PROFILE_CORE(CONFIG_TASK_PROFILE_EVENT_LOOP_CORE), CONFIG_TASK_PROFILE_EVENT_LOOP_PRIORITY },
+    [TASK_PROFILE_ROLE_APP]        = { TASK_PROFILE_CORE(CONFIG_TASK_PROFILE_APP_CORE), CONFIG_TASK_PROFILE_APP_PRIORITY },
+};
+#else
+#define TASK_PROFILE_NAME               "unpinned"
+static const task_profile_t s_profile[TASK_PROFILE_ROLE_COUNT] = {
+    [TASK_PROFILE_ROLE_SERVER]     = { .core = tskNO_AFFINITY, .priority = 5 },
+    [TASK_PROFILE_ROLE_CLIENT]     = { .core = tskNO_AFFINITY, .priority = 5 },
+    [TASK_PROFILE_ROLE_EVENT_LOOP] = { .core = tskNO_AFFINITY, .priority = 5 },
+    [TASK_PROFILE_ROLE_APP]        = { .core = tskNO_AFFINITY, .priority = 1 },
+};
+#endif
+
+static const char *const s_role_names[TASK_PROFILE_ROLE_COUNT] = {
+    [TASK_PROFILE_ROLE_SERVER]     = "servidor",
+    [TASK_PROFILE_ROLE_CLIENT]     = "clientes",
+    [TASK_PROFILE_ROLE_EVENT_LOOP] = "event loop",
+    [TASK_PROFILE_ROLE_APP]        = "aplicação",
+};
+
+const task_profile_t *task_profile_get(task_profile_role_t role) {
+
+    return &s_profile[role < TASK_PROFILE_ROLE_COUNT ? role : TASK_PROFILE_ROLE_APP];
+}
+
+BaseType_t task_profile_core(task_profile_role_t role, int index) {
+
+    BaseType_t core = task_profile_get(role)->core;
+    if (core == tskNO_AFFINITY) {
+        return index % portNUM_PROCESSORS;
+    }
+    return (core + index) % portNUM_PROCESSORS;
+}
+
+BaseType_t task_profile_create(TaskFunction_t task, const char *name, uint32_t stack_size,
+                               void *arg, task_profile_role_t role, TaskHandle_t *handle) {
+
+    const task_profile_t *profile = task_profile_get(role);
+    return xTaskCreatePinnedToCore(task, name, stack_size, arg, profile->priority, handle, profile->core);
+}
+
+const char *task_profile_name(void) {
+
+    return TASK_PROFILE_NAME;
+}
+
+void task_profile_log(void) {
+
+    ESP_LOGI(TAG_TASK_PROFILE, "Perfil de tasks: %s (%d cores)", TASK_PROFILE_NAME, portNUM_PROCESSORS);
+    for (int i = 0; i < TASK_PROFILE_ROLE_COUNT; i++) {
+        if (s_profile[i].core == tskNO_AFFINITY) {
+            ESP_LOGI(TAG_TASK_PROFILE, "  %-10s - sem afinidade, prioridade %u", s_role_names[i], (unsigned)s_profile[i].priority);
+        } else {
+            ESP_LOGI(TAG_TASK_PROFILE, "  %-10s - core %d, prioridade %u", s_role_names[i], (int)s_profile[i].core, (unsigned)s_profile[i].priority);
+        }
+    }
+
+#if !CONFIG_IDF_TARGET_LINUX
+    // Wi-Fi e tcpip são configurados no sdkconfig (ESP_WIFI_TASK_*, LWIP_TCPIP_TASK_AFFINITY)
+#if CONFIG_LWIP_TCPIP_TASK_AFFINITY_CPU0
+    int tcpip_core = 0;
+#elif CONFIG_LWIP_TCPIP_TASK_AFFINITY_CPU1
+    int tcpip_core = 1;
+#else
+    int tcpip_core = -1;
+#endif
+#if CONFIG_ESP_WIFI_TASK_PINNED_TO_CORE_1
+    int wifi_core = 1;
+#else
+    int wifi_core = 0;
+#endif
+    ESP_LOGI(TAG_TASK_PROFILE, "  tcpip      - core %d, prioridade %d | Wi-Fi - core %d", tcpip_core, ESP_TASK_TCPIP_PRIO, wifi_core);
+
+#if defined(TASK_PROFILE_TCPIP_CORE) && portNUM_PROCESSORS > 1
+    if (tcpip_core != TASK_PROFILE_TCPIP_CORE) {
+        ESP_LOGW(TAG_TASK_PROFILE, "O perfil %s espera a tcpip no core %d - ajuste LWIP_TCPIP_TASK_AFFINITY",
+                 TASK_PROFILE_NAME, TASK_PROFILE_TCPIP_CORE);
+    }
+#endif
+#endif
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_wifi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Conexão rápida do Wi-Fi STA: o BSSID e o canal do último AP associado ficam na NVS e a
+// primeira tentativa vai direto para ele (scan de um canal, sem varrer os 13). A chave do
+// handshake não precisa de cache próprio: com WIFI_STORAGE_FLASH o driver já guarda na NVS
+// o PMK derivado da senha (WPA2) e o PMKSA do SAE (WPA3) fica em RAM para as reconexões.
+//
+// Os callbacks rodam no event loop padrão, dentro do event handler do Wi-Fi do projeto:
+//   antes do esp_wifi_set_config       -> wifi_fast_connect_apply(&config)
+//   WIFI_EVENT_STA_CONNECTED           -> wifi_fast_connect_on_connected(event_data)
+//   WIFI_EVENT_STA_DISCONNECTED        -> wifi_fast_connect_on_disconnected(event_data)
+//   IP_EVENT_STA_GOT_IP                -> wifi_fast_connect_on_got_ip()
+
+// Tempo até a rede da última conexão (boot ou reconexão)
+typedef struct {
+    uint32_t assoc_ms;      // Início da tentativa -> WIFI_EVENT_STA_CONNECTED
+    uint32_t connect_ms;    // Início da tentativa -> IP_EVENT_STA_GOT_IP
+    uint32_t attempts;      // Tentativas até associar (inclui a do cache)
+    bool cached;            // Associou pelo BSSID e canal em cache
+    bool valid;             // Já houve uma conexão completa
+} wifi_fast_connect_metrics_t;
+
+// Lê o cache e, se ele for do mesmo SSID, fixa BSSID e canal na config. Marca o início da
+// medição. Chamar depois do nvs_flash_init e do esp_wifi_init. Retorna true se usou o cache
+bool wifi_fast_connect_apply(wifi_config_t *config);
+
+// Associou - grava BSSID e canal na NVS se mudaram
+void wifi_fast_connect_on_connected(const wifi_event_sta_connected_t *event);
+
+// Desconectou. Se a tentativa era pelo cache, troca a config para o scan completo e retorna
+// true: o chamador reconecta na hora, sem contar como tentativa. Após uma conexão que caiu,
+// volta a fixar o AP em cache para a reconexão e reinicia a medição
+bool wifi_fast_connect_on_disconnected(const wifi_event_sta_disconnected_t *event);
+
+// Obteve IP - fecha a medição e mostra o tempo de conexão no log
+void wifi_fast_connect_on_got_ip(void);
+
+// Métrica da última conexão completa
+void wifi_fast_connect_get_metrics(wifi_fast_connect_metrics_t *metrics);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,206 @@
+#include <string.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+#include "async_log.h"
+
+#include "wifi_fast_connect.h"
+
+// Tags de depuração:
+static const char *TAG_FAST_CONNECT = "DEBUG - WIFI-FAST";
+
+#if CONFIG_WIFI_FAST_CONNECT_ENABLE
+#define FAST_CONNECT_NVS_KEY            "ap"
+
+// Registro na NVS - o SSID confirma que o cache é da rede configurada
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t bssid[6];
+    uint8_t channel;
+} fast_connect_ap_t;
+
+static fast_connect_ap_t s_ap;          // Cópia do que está na NVS
+static bool s_ap_valid;
+static bool s_attempt_cached;           // Tentativa atual fixada no AP em cache
+#endif
+
+// Medição da tentativa em andamento
+static int64_t s_start_us;
+static uint32_t s_assoc_ms;
+static uint32_t s_attempts;
+static bool s_connected;
+static wifi_fast_connect_metrics_t s_metrics;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t fast_connect_elapsed_ms(void) {
+
+    return (uint32_t)((esp_timer_get_time() - s_start_us) / 1000);
+}
+
+static void fast_connect_begin(void) {
+
+    s_start_us = esp_timer_get_time();
+    s_assoc_ms = 0;
+    s_attempts = 1;
+    s_connected = false;
+}
+
+#if CONFIG_WIFI_FAST_CONNECT_ENABLE
+static void fast_connect_load(void) {
+
+    nvs_handle_t nvs;
+    size_t len = sizeof(s_ap);
+
+    s_ap_valid = false;
+    if (nvs_open(CONFIG_WIFI_FAST_CONNECT_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return;     // Primeiro boot - namespace ainda não existe
+    }
+    s_ap_valid = nvs_get_blob(nvs, FAST_CONNECT_NVS_KEY, &s_ap, &len) == ESP_OK && len == sizeof(s_ap);
+    nvs_close(nvs);
+}
+
+static void fast_connect_store(void) {
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(CONFIG_WIFI_FAST_CONNECT_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, FAST_CONNECT_NVS_KEY, &s_ap, sizeof(s_ap));
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        ASYNC_LOGW(TAG_FAST_CONNECT, "Falha ao gravar o AP na NVS: %s", esp_err_to_name(err));
+    }
+}
+
+// Fixa o AP em cache na config (true) ou volta ao scan normal, sem BSSID nem canal (false)
+static void fast_connect_pin(wifi_config_t *config, bool pin) {
+
+    s_attempt_cached = pin;
+    config->sta.bssid_set = pin;
+    if (pin) {
+        memcpy(config->sta.bssid, s_ap.bssid, sizeof(s_ap.bssid));
+        config->sta.channel = s_ap.channel;
+    } else {
+        config->sta.channel = 0;
+    }
+}
+
+static bool fast_connect_matches(const wifi_config_t *config) {
+
+    return s_ap_valid && memcmp(s_ap.ssid, config->sta.ssid, sizeof(s_ap.ssid)) == 0;
+}
+
+// Troca a config já aplicada no driver (reconexão ou volta ao scan completo)
+static void fast_connect_repin(bool pin) {
+
+    wifi_config_t config;
+
+    if (esp_wifi_get_config(WIFI_IF_STA, &config) != ESP_OK) {
+        return;
+    }
+    if (pin && !fast_connect_matches(&config)) {
+        return;
+    }
+    fast_connect_pin(&config, pin);
+    esp_wifi_set_config(WIFI_IF_STA, &config);
+}
+#endif
+
+bool wifi_fast_connect_apply(wifi_config_t *config) {
+
+    fast_connect_begin();
+#if CONFIG_WIFI_FAST_CONNECT_ENABLE
+    // PMK da senha guardado pelo driver na NVS - não recalcula o PBKDF2 a cada boot
+    esp_wifi_set_storage(WIFI_STORAGE_FLASH);
+
+    fast_connect_load();
+    if (fast_connect_matches(config)) {
+        fast_connect_pin(config, true);
+        ASYNC_LOGI(TAG_FAST_CONNECT, "AP em cache - " MACSTR ", canal %d", MAC2STR(s_ap.bssid), s_ap.channel);
+        return true;
+    }
+    fast_connect_pin(config, false);
+    ASYNC_LOGI(TAG_FAST_CONNECT, "Sem AP em cache - scan completo");
+#endif
+    return false;
+}
+
+void wifi_fast_connect_on_connected(const wifi_event_sta_connected_t *event) {
+
+    s_assoc_ms = fast_connect_elapsed_ms();
+    s_connected = true;
+
+#if CONFIG_WIFI_FAST_CONNECT_ENABLE
+    fast_connect_ap_t ap = {
+        .channel = event->channel,
+    };
+    memcpy(ap.ssid, event->ssid, MIN(event->ssid_len, sizeof(ap.ssid)));
+    memcpy(ap.bssid, event->bssid, sizeof(ap.bssid));
+
+    // Mesmo AP e canal - nada a gravar, a flash não se desgasta a cada boot
+    if (!s_ap_valid || memcmp(&ap, &s_ap, sizeof(ap)) != 0) {
+        s_ap = ap;
+        s_ap_valid = true;
+        fast_connect_store();
+    }
+#endif
+}
+
+bool wifi_fast_connect_on_disconnected(const wifi_event_sta_disconnected_t *event) {
+
+    if (s_connected) {
+        // Conexão caiu - nova medição e a reconexão tenta primeiro o mesmo AP
+        fast_connect_begin();
+#if CONFIG_WIFI_FAST_CONNECT_ENABLE
+        fast_connect_repin(true);
+#endif
+        return false;
+    }
+
+    s_attempts++;
+#if CONFIG_WIFI_FAST_CONNECT_ENABLE
+    if (s_attempt_cached) {
+        // AP em cache não respondeu (desligado, mudou de canal) - scan completo em seguida
+        ASYNC_LOGW(TAG_FAST_CONNECT, "AP em cache falhou (motivo %d) - scan completo", event->reason);
+        fast_connect_repin(false);
+        return true;
+    }
+#endif
+    return false;
+}
+
+void wifi_fast_connect_on_got_ip(void) {
+
+    wifi_fast_connect_metrics_t metrics = {
+        .assoc_ms = s_assoc_ms,
+        .connect_ms = fast_connect_elapsed_ms(),
+        .attempts = s_attempts,
+#if CONFIG_WIFI_FAST_CONNECT_ENABLE
+        .cached = s_attempt_cached,
+#endif
+        .valid = true,
+    };
+
+    taskENTER_CRITICAL(&s_lock);
+    s_metrics = metrics;
+    taskEXIT_CRITICAL(&s_lock);
+
+    ASYNC_LOGI(TAG_FAST_CONNECT, "Conectado em %lu ms (associação %lu ms, %lu tentativa(s), %s)",
+               (unsigned long)metrics.connect_ms, (unsigned long)metrics.assoc_ms, (unsigned long)metrics.attempts,
+               metrics.cached ? "AP em cache" : "scan completo");
+}
+
+void wifi_fast_connect_get_metrics(wifi_fast_connect_metrics_t *metrics) {
+
+    taskENTER_CRITICAL(&s_lock);
+    *metrics = s_metrics;
+    taskEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_wifi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Gerenciador de conexão do Wi-Fi STA: é o único que chama esp_wifi_connect. Depois de uma
+// queda (ou no boot) tenta de novo com espera exponencial e sorteio (jitter), primeiro na
+// fase rápida (esperas curtas, WIFI_MANAGER_FAST_*) e depois, sem limite de tentativas, na
+// fase lenta (WIFI_MANAGER_SLOW_*). Os event handlers do projeto continuam recebendo os
+// mesmos eventos, mas não reconectam mais.
+
+typedef enum {
+    WIFI_MANAGER_STOPPED,       // Wi-Fi não iniciado
+    WIFI_MANAGER_CONNECTING,    // Tentativa em andamento
+    WIFI_MANAGER_ASSOCIATED,    // Associado ao AP, esperando IP
+    WIFI_MANAGER_ONLINE,        // Com IP
+    WIFI_MANAGER_RETRY_FAST,    // Esperando a próxima tentativa - fase rápida
+    WIFI_MANAGER_RETRY_SLOW,    // Esperando a próxima tentativa - fase lenta
+} wifi_manager_state_t;
+
+typedef struct {
+    wifi_manager_state_t state;
+    uint32_t attempts;          // Tentativas sem sucesso desde a última conexão
+    uint32_t next_retry_ms;     // RETRY_*: ms até a próxima tentativa
+    uint32_t disconnects;       // Quedas de conexão desde o boot
+    uint8_t last_reason;        // Motivo da última desconexão (wifi_err_reason_t)
+} wifi_manager_status_t;
+
+typedef struct {
+    // Tentativas da fase rápida. 0 = CONFIG_WIFI_MANAGER_FAST_RETRIES
+    uint32_t fast_retries;
+    // Opcional - chamado a cada desconexão, antes do backoff. Retorna true para reconectar na
+    // hora sem avançar o backoff (ex.: wifi_fast_connect_on_disconnected)
+    bool (*on_disconnected)(const wifi_event_sta_disconnected_t *event);
+    // Opcional - o wifi_manager_wait sem bloquear: chamado uma vez, no primeiro IP (true) ou
+    // ao fim da fase rápida (false), no event loop ou na task do esp_timer
+    void (*on_ready)(bool online);
+} wifi_manager_config_t;
+
+// Registra os event handlers. Chamar depois do esp_event_loop_create_default e antes do
+// esp_wifi_start - a primeira tentativa sai no WIFI_EVENT_STA_START. config pode ser NULL
+esp_err_t wifi_manager_start(const wifi_manager_config_t *config);
+
+// Estado atual, sem bloquear. Pode ser chamado de qualquer task
+wifi_manager_state_t wifi_manager_get_state(void);
+
+// Estado, tentativas e prazo da próxima tentativa, sem bloquear
+void wifi_manager_get_status(wifi_manager_status_t *status);
+
+static inline bool wifi_manager_is_online(void) {
+    return wifi_manager_get_state() == WIFI_MANAGER_ONLINE;
+}
+
+// Nome do estado (logs)
+const char *wifi_manager_state_name(wifi_manager_state_t state);
+
+// Espera até ter IP ou a fase rápida acabar, por no máximo timeout. Retorna true se tem IP.
+// Com false as tentativas continuam em segundo plano
+bool wifi_manager_wait(TickType_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
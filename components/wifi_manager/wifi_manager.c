@@ -0,0 +1,268 @@
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+
+#include "async_log.h"
+
+#include "wifi_manager.h"
+
+// Menuconfig - Backoff
+#define MANAGER_FAST_BASE_MS            CONFIG_WIFI_MANAGER_FAST_BASE_MS
+#define MANAGER_FAST_MAX_MS             MAX(CONFIG_WIFI_MANAGER_FAST_MAX_MS, CONFIG_WIFI_MANAGER_FAST_BASE_MS)
+#define MANAGER_SLOW_BASE_MS            CONFIG_WIFI_MANAGER_SLOW_BASE_MS
+#define MANAGER_SLOW_MAX_MS             MAX(CONFIG_WIFI_MANAGER_SLOW_MAX_MS, CONFIG_WIFI_MANAGER_SLOW_BASE_MS)
+
+// Bits do wifi_manager_wait
+#define MANAGER_ONLINE_BIT              BIT0
+#define MANAGER_FAST_EXHAUSTED_BIT      BIT1
+
+// Tags de depuração:
+static const char *TAG_WIFI_MANAGER = "DEBUG - WIFI-MANAGER";
+
+// Estado compartilhado entre o event loop, a task do esp_timer e quem consulta
+static struct {
+    wifi_manager_state_t state;
+    uint32_t attempts;
+    uint32_t disconnects;
+    uint8_t last_reason;
+    int64_t retry_at_us;
+} s_manager;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_fast_retries;
+static bool (*s_on_disconnected)(const wifi_event_sta_disconnected_t *event);
+static void (*s_on_ready)(bool online);
+static bool s_ready_notified;
+static esp_timer_handle_t s_retry_timer;
+static EventGroupHandle_t s_events;
+
+static void manager_set_state(wifi_manager_state_t state) {
+
+    taskENTER_CRITICAL(&s_lock);
+    s_manager.state = state;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+// Function - Backoff before attempt n (0 = primeira após a queda)
+// Dobra a cada tentativa até o teto da fase; a espera é sorteada entre metade e o valor cheio
+static uint32_t manager_backoff_ms(uint32_t attempt) {
+
+    bool slow = attempt >= s_fast_retries;
+    uint32_t n = slow ? attempt - s_fast_retries : attempt;
+    uint32_t max_ms = slow ? MANAGER_SLOW_MAX_MS : MANAGER_FAST_MAX_MS;
+    uint32_t delay_ms = slow ? MANAGER_SLOW_BASE_MS : MANAGER_FAST_BASE_MS;
+
+    while (n-- > 0 && delay_ms < max_ms) {
+        delay_ms *= 2;
+    }
+    delay_ms = MIN(delay_ms, max_ms);
+    return delay_ms / 2 + esp_random() % (delay_ms / 2 + 1);
+}
+
+// Primeiro IP ou fim da fase rápida - on_ready uma vez só
+static void manager_notify_ready(bool online) {
+
+    taskENTER_CRITICAL(&s_lock);
+    bool notify = s_on_ready != NULL && !s_ready_notified;
+    s_ready_notified = true;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (notify) {
+        s_on_ready(online);
+    }
+}
+
+static void manager_schedule_retry(void);
+
+static void manager_connect(void) {
+
+    manager_set_state(WIFI_MANAGER_CONNECTING);
+    esp_err_t err = esp_wifi_connect();
+    if (err != ESP_OK) {
+        // Driver ocupado ou parado - conta como tentativa e espera o backoff
+        ASYNC_LOGW(TAG_WIFI_MANAGER, "esp_wifi_connect falhou: %s", esp_err_to_name(err));
+        taskENTER_CRITICAL(&s_lock);
+        s_manager.attempts++;
+        taskEXIT_CRITICAL(&s_lock);
+        manager_schedule_retry();
+    }
+}
+
+static void manager_schedule_retry(void) {
+
+    taskENTER_CRITICAL(&s_lock);
+    uint32_t attempts = s_manager.attempts;
+    taskEXIT_CRITICAL(&s_lock);
+    uint32_t delay_ms = manager_backoff_ms(attempts);
+    bool slow = attempts >= s_fast_retries;
+
+    taskENTER_CRITICAL(&s_lock);
+    s_manager.state = slow ? WIFI_MANAGER_RETRY_SLOW : WIFI_MANAGER_RETRY_FAST;
+    s_manager.retry_at_us = esp_timer_get_time() + (int64_t)delay_ms * 1000;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (attempts == s_fast_retries) {
+        ASYNC_LOGW(TAG_WIFI_MANAGER, "AP indisponível após %lu tentativas - continuando em segundo plano", (unsigned long)attempts);
+        xEventGroupSetBits(s_events, MANAGER_FAST_EXHAUSTED_BIT);
+        manager_notify_ready(false);
+    }
+    ASYNC_LOGI(TAG_WIFI_MANAGER, "Nova tentativa em %lu ms (fase %s)", (unsigned long)delay_ms, slow ? "lenta" : "rápida");
+
+    esp_timer_stop(s_retry_timer);
+    esp_timer_start_once(s_retry_timer, (uint64_t)delay_ms * 1000);
+}
+
+// Timer - Backoff expired (task do esp_timer)
+static void manager_retry_timer(void *arg) {
+
+    manager_connect();
+}
+
+static void manager_on_disconnected(const wifi_event_sta_disconnected_t *event) {
+
+    bool was_online = s_manager.state == WIFI_MANAGER_ONLINE;
+    bool retry_now = s_on_disconnected != NULL && s_on_disconnected(event);
+
+    taskENTER_CRITICAL(&s_lock);
+    s_manager.last_reason = event->reason;
+    if (was_online) {
+        // Queda - o backoff recomeça na fase rápida
+        s_manager.disconnects++;
+        s_manager.attempts = 0;
+    } else if (!retry_now) {
+        s_manager.attempts++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    xEventGroupClearBits(s_events, MANAGER_ONLINE_BIT);
+
+    ASYNC_LOGI(TAG_WIFI_MANAGER, "Desconectado (motivo %d)", event->reason);
+    if (retry_now) {
+        manager_connect();
+    } else {
+        manager_schedule_retry();
+    }
+}
+
+// Function - Event handlers
+static void manager_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
+
+    if (event_base == WIFI_EVENT) {
+        switch (event_id) {
+        case WIFI_EVENT_STA_START:
+            taskENTER_CRITICAL(&s_lock);
+            s_manager.attempts = 0;
+            taskEXIT_CRITICAL(&s_lock);
+            manager_connect();
+            break;
+        case WIFI_EVENT_STA_CONNECTED:
+            manager_set_state(WIFI_MANAGER_ASSOCIATED);
+            break;
+        case WIFI_EVENT_STA_DISCONNECTED:
+            // Desconexão do esp_wifi_stop - sem reconectar
+            if (s_manager.state != WIFI_MANAGER_STOPPED) {
+                manager_on_disconnected(event_data);
+            }
+            break;
+        case WIFI_EVENT_STA_STOP:
+            esp_timer_stop(s_retry_timer);
+            manager_set_state(WIFI_MANAGER_STOPPED);
+            xEventGroupClearBits(s_events, MANAGER_ONLINE_BIT);
+            break;
+        default:
+            break;
+        }
+    } else if (event_id == IP_EVENT_STA_GOT_IP) {
+        taskENTER_CRITICAL(&s_lock);
+        s_manager.state = WIFI_MANAGER_ONLINE;
+        s_manager.attempts = 0;
+        taskEXIT_CRITICAL(&s_lock);
+        xEventGroupClearBits(s_events, MANAGER_FAST_EXHAUSTED_BIT);
+        xEventGroupSetBits(s_events, MANAGER_ONLINE_BIT);
+        manager_notify_ready(true);
+    } else if (event_id == IP_EVENT_STA_LOST_IP) {
+        // Ainda associado - o DHCP tenta de novo sozinho
+        if (s_manager.state == WIFI_MANAGER_ONLINE) {
+            manager_set_state(WIFI_MANAGER_ASSOCIATED);
+        }
+        xEventGroupClearBits(s_events, MANAGER_ONLINE_BIT);
+    }
+}
+
+esp_err_t wifi_manager_start(const wifi_manager_config_t *config) {
+
+    s_fast_retries = config != NULL && config->fast_retries > 0 ? config->fast_retries : CONFIG_WIFI_MANAGER_FAST_RETRIES;
+    s_on_disconnected = config != NULL ? config->on_disconnected : NULL;
+    s_on_ready = config != NULL ? config->on_ready : NULL;
+    s_manager.state = WIFI_MANAGER_STOPPED;
+
+    s_events = xEventGroupCreate();
+    if (s_events == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = manager_retry_timer,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "wifi_retry",
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &s_retry_timer);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &manager_event_handler, NULL, NULL);
+    if (err == ESP_OK) {
+        err = esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &manager_event_handler, NULL, NULL);
+    }
+    if (err == ESP_OK) {
+        err = esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_LOST_IP, &manager_event_handler, NULL, NULL);
+    }
+    return err;
+}
+
+wifi_manager_state_t wifi_manager_get_state(void) {
+
+    taskENTER_CRITICAL(&s_lock);
+    wifi_manager_state_t state = s_manager.state;
+    taskEXIT_CRITICAL(&s_lock);
+    return state;
+}
+
+void wifi_manager_get_status(wifi_manager_status_t *status) {
+
+    int64_t now_us = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&s_lock);
+    status->state = s_manager.state;
+    status->attempts = s_manager.attempts;
+    status->disconnects = s_manager.disconnects;
+    status->last_reason = s_manager.last_reason;
+    status->next_retry_ms = 0;
+    if ((s_manager.state == WIFI_MANAGER_RETRY_FAST || s_manager.state == WIFI_MANAGER_RETRY_SLOW) && s_manager.retry_at_us > now_us) {
+        status->next_retry_ms = (uint32_t)((s_manager.retry_at_us - now_us) / 1000);
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+const char *wifi_manager_state_name(wifi_manager_state_t state) {
+
+    static const char *const s_names[] = {
+        [WIFI_MANAGER_STOPPED] = "parado",
+        [WIFI_MANAGER_CONNECTING] = "conectando",
+        [WIFI_MANAGER_ASSOCIATED] = "associado",
+        [WIFI_MANAGER_ONLINE] = "online",
+        [WIFI_MANAGER_RETRY_FAST] = "espera (rápida)",
+        [WIFI_MANAGER_RETRY_SLOW] = "espera (lenta)",
+    };
+    return (unsigned)state < sizeof(s_names) / sizeof(s_names[0]) ? s_names[state] : "?";
+}
+
+bool wifi_manager_wait(TickType_t timeout) {
+
+    EventBits_t bits = xEventGroupWaitBits(s_events, MANAGER_ONLINE_BIT | MANAGER_FAST_EXHAUSTED_BIT, pdFALSE, pdFALSE, timeout);
+    return (bits & MANAGER_ONLINE_BIT) != 0;
+}
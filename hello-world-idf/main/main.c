@@ -10,6 +10,8 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 
+#include "task_profile.h"
+
 /*
  Pisca um LED conectado no pino GPIO_12 do ESP32.
  Esquema Oficial: https://dl.espressif.com/dl/schematics/ESP32-Core-Board-V2_sch.pdf
@@ -30,6 +32,6 @@ void blink_task(void *pvParameter) {
 }
  
 void app_main() {	
-    xTaskCreate(blink_task,"blink_task",1024,NULL,1,NULL);
+    task_profile_create(blink_task, "blink_task", 1024, NULL, TASK_PROFILE_ROLE_APP, NULL);
     printf("blink task  started\n");
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <freertos/task.h>
 #include <driver/gpio.h>
 
+#include "task_profile.h"
+
 #define TIME_BLINK 1000
 
 void vBlinkTask(void *Parameters) {
@@ -22,6 +24,6 @@ void vBlinkTask(void *Parameters) {
 }
 
 void app_main(void) {
-    xTaskCreate(vBlinkTask, "Task-Blink", 1024, NULL, 1, NULL);
+    task_profile_create(vBlinkTask, "Task-Blink", 1024, NULL, TASK_PROFILE_ROLE_APP, NULL);
     printf("Blink task started\n");
 }
\ No newline at end of file
@@ -16,6 +16,8 @@
 #include <freertos/task.h>
 #include <driver/gpio.h>
 
+#include "task_profile.h"
+
 #define LED     GPIO_NUM_12
 #define BUTTON  GPIO_NUM_14
 
@@ -48,6 +50,6 @@ void vTaksLed(void *Parameters) {
 }
 
 void app_main(void) {
-    xTaskCreate(vTaksLed, "Task-Led", 1024, NULL, 1, NULL);
+    task_profile_create(vTaksLed, "Task-Led", 1024, NULL, TASK_PROFILE_ROLE_APP, NULL);
     printf("Task LED iniciada com sucesso!\n");
 }
\ No newline at end of file
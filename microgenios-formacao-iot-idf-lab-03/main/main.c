@@ -11,6 +11,8 @@
 #include <freertos/task.h>
 #include <driver/gpio.h>
 
+#include "task_profile.h"
+
 #define LED_1 GPIO_NUM_12  
 #define LED_2 GPIO_NUM_13 
 #define GPIO_OUTPUT_PIN_OUTPUTS  ((1ULL<<LED_1) | (1ULL<<LED_2)) // Mascara de bits
@@ -47,7 +49,7 @@ void Task_LED(void *pvParameter) {
 }
  
 void app_main() {	
-    xTaskCreate(Task_LED, "Task_LED", 2048, NULL, 2, NULL);
+    task_profile_create(Task_LED, "Task_LED", 2048, NULL, TASK_PROFILE_ROLE_APP, NULL);
     printf("Task_LED iniciada com sucesso.\n");
 }
 
@@ -3,6 +3,8 @@
 #include <freertos/task.h>
 #include <driver/gpio.h>
 
+#include "task_profile.h"
+
 #define LED_1 GPIO_NUM_12
 #define LED_2 GPIO_NUM_13   
 #define GPIO_OUTPUT_PIN_SEL  ((1ULL<<LED_1) | (1ULL<<LED_2))
@@ -80,6 +82,6 @@ void Task_LED(void *pvParameters) {
 }
 
 void app_main(void) {
-    xTaskCreate(Task_LED, "Task-LED", 2048, NULL, 1, NULL);
+    task_profile_create(Task_LED, "Task-LED", 2048, NULL, TASK_PROFILE_ROLE_APP, NULL);
     printf("Task-LED iniciada com sucesso!\n");
 }
\ No newline at end of file
@@ -27,11 +27,14 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/event_groups.h"
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "async_log.h"
+#include "wifi_fast_connect.h"
+#include "wifi_manager.h"
+#include "boot_trace.h"
 #include "nvs_flash.h"
 
 #include "lwip/err.h"
@@ -70,73 +73,54 @@
 #define ESP_WIFI_SCAN_AUTH_MODE_THRESHOLD   WIFI_AUTH_WAPI_PSK
 #endif
 
-/* Grupo de eventos FreeRTOS para sinalizar quando estamos conectados */
-static EventGroupHandle_t s_wifi_event_group;
-
-#define WIFI_CONNECTED_BIT BIT0
-#define WIFI_FAIL_BIT      BIT1
-
 static const char *TAG = "wifi station";
 
-static int s_retry_num = 0;
-
-/* event_handler é usada para gerenciar os principais eventos de conexão Wi-Fi no ESP32
+/* event_handler é usada para acompanhar os principais eventos de conexão Wi-Fi no ESP32
 
-    Essa função event_handler é usada para gerenciar os principais eventos de conexão Wi-Fi no ESP32. Ela tenta reconectar automaticamente 
-    em caso de desconexão e registra os estados da conexão, como sucesso ou falha, usando grupos de eventos e logs. Este é um padrão comum 
-    para lidar com a conectividade Wi-Fi em aplicações embarcadas usando o ESP-IDF.
+    A reconexão não fica mais aqui: o wifi_manager (components/wifi_manager) é o único que chama esp_wifi_connect(), no 
+    WIFI_EVENT_STA_START e após cada desconexão, com espera exponencial e sorteio entre as tentativas. Esta função só registra 
+    os estados da conexão nos logs e alimenta o cache da conexão rápida.
 */
 static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
     
-    /* Tratamento do Evento WIFI_EVENT_STA_START
+    /* Tratamento do Evento WIFI_EVENT_STA_CONNECTED
 
-        Quando a base do evento é WIFI_EVENT e o evento específico é WIFI_EVENT_STA_START, a função chama esp_wifi_connect() para 
-        tentar conectar à rede Wi-Fi configurada.
+        Associado ao AP (ainda sem IP). O BSSID e o canal vão para o cache da conexão rápida, usados na primeira 
+        tentativa do próximo boot.
     */
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        esp_wifi_connect();
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        wifi_fast_connect_on_connected((wifi_event_sta_connected_t*) event_data);
+        boot_trace_mark(BOOT_TRACE_ASSOCIATED);
     } else 
     /* Tratamento do Evento WIFI_EVENT_STA_DISCONNECTED
 
-        Esse bloco trata o evento WIFI_EVENT_STA_DISCONNECTED, que é acionado quando a conexão Wi-Fi é perdida.
-        Se o número de tentativas de reconexão (s_retry_num) for menor que o máximo permitido (EXAMPLE_ESP_MAXIMUM_RETRY), ele 
-        tenta reconectar chamando esp_wifi_connect() novamente e incrementa s_retry_num.
-        Se o número de tentativas exceder o máximo permitido, o código define um bit em um grupo de eventos (s_wifi_event_group) 
-        para indicar a falha na conexão (WIFI_FAIL_BIT).
-        Logs informativos (ESP_LOGI) são usados para relatar as tentativas de reconexão e falhas.
-
+        Acionado quando a conexão Wi-Fi é perdida ou uma tentativa falha. A nova tentativa é agendada pelo wifi_manager: 
+        na fase rápida as esperas começam em centenas de ms; esgotadas as EXAMPLE_ESP_MAXIMUM_RETRY tentativas, ele segue na 
+        fase lenta, sem limite, com esperas de segundos a minutos.
     */
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        if (s_retry_num < EXAMPLE_ESP_MAXIMUM_RETRY) {
-            esp_wifi_connect();
-            s_retry_num++;
-            ESP_LOGI(TAG, "retry to connect to the AP");
-        } else {
-            xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
-        }
-        ESP_LOGI(TAG, "connect to the AP fail");
+        wifi_manager_status_t status;
+        wifi_manager_get_status(&status);
+        ASYNC_LOGI(TAG, "connect to the AP fail - %s", wifi_manager_state_name(status.state));
     
     } else 
     /* Tratamento do Evento IP_EVENT_STA_GOT_IP
 
         Esse bloco é acionado quando o evento IP_EVENT_STA_GOT_IP ocorre, indicando que o dispositivo obteve um endereço IP válido.
-        A função extrai o endereço IP dos dados do evento (event_data) e o imprime nos logs.
-        O contador de tentativas de reconexão (s_retry_num) é resetado para 0, pois a conexão foi bem-sucedida.
-        Um bit é definido no grupo de eventos (s_wifi_event_group) para indicar que a conexão foi estabelecida com sucesso 
-        (WIFI_CONNECTED_BIT).
+        A função extrai o endereço IP dos dados do evento (event_data) e o imprime nos logs, e fecha a medição do tempo de conexão.
     */
     if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
-        ESP_LOGI(TAG, "got ip:" IPSTR, IP2STR(&event->ip_info.ip));
-        s_retry_num = 0;
-        xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+        ASYNC_LOGI(TAG, "got ip:" IPSTR, IP2STR(&event->ip_info.ip));
+        wifi_fast_connect_on_got_ip();
+        boot_trace_mark(BOOT_TRACE_GOT_IP);
     }
 }
 
 /* Função responsável por configurar e inicializar a interface Wi-Fi em modo station (STA)
 
     A função também configura o tratamento de eventos relacionados à conexão Wi-Fi, esperando 
-    até que a conexão seja estabelecida com sucesso ou que as tentativas de conexão sejam esgotadas.
+    até que a conexão seja estabelecida com sucesso ou que a fase rápida de tentativas se esgote.
 */
 void wifi_init_sta(void) {
 
@@ -146,6 +130,7 @@ void wifi_init_sta(void) {
     Wi-Fi e Ethernet.
     */
     ESP_ERROR_CHECK(esp_netif_init());
+    boot_trace_mark(BOOT_TRACE_NETIF);
 
     /* Criação do Loop de Eventos
 
@@ -167,6 +152,18 @@ void wifi_init_sta(void) {
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &event_handler, NULL, &instance_any_id));
     ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &event_handler, NULL, &instance_got_ip));
 
+    /* Gerenciador de Conexão
+
+        wifi_manager_start() registra os handlers que conectam e reconectam. fast_retries define a fase rápida; depois dela as 
+        tentativas continuam sem limite. on_disconnected deixa a conexão rápida voltar ao scan completo na hora quando o AP em 
+        cache falha, sem avançar a espera.
+    */
+    const wifi_manager_config_t manager_config = {
+        .fast_retries = EXAMPLE_ESP_MAXIMUM_RETRY,
+        .on_disconnected = wifi_fast_connect_on_disconnected,
+    };
+    ESP_ERROR_CHECK(wifi_manager_start(&manager_config));
+
     /* Cria uma interface de rede Wifi
 
         esp_netif_create_default_wifi_sta() cria uma interface de rede Wi-Fi padrão configurada para o modo station (STA), que permite ao ESP32 conectar-se 
@@ -180,6 +177,7 @@ void wifi_init_sta(void) {
     */
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+    boot_trace_mark(BOOT_TRACE_WIFI_INIT);
 
     /* Configuração da Interface Wi-Fi
 
@@ -208,39 +206,50 @@ void wifi_init_sta(void) {
         },
     };
 
+    /* Conexão Rápida
+
+        wifi_fast_connect_apply() fixa na config o BSSID e o canal do último AP associado (NVS), se forem do mesmo SSID. 
+        A primeira tentativa varre um canal só, em vez de todos, e o tempo até o IP aparece no log ao final.
+    */
+    wifi_fast_connect_apply(&wifi_config);
+
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
+    boot_trace_mark(BOOT_TRACE_WIFI_START);
 
-    ESP_LOGI(TAG, "wifi_init_sta finished.");
+    ASYNC_LOGI(TAG, "wifi_init_sta finished.");
 
     /* Aguardando Conexão ou Falha 
 
-        xEventGroupWaitBits() espera até que um dos bits de evento seja definido (WIFI_CONNECTED_BIT ou WIFI_FAIL_BIT), indicando que a conexão foi 
-        estabelecida ou falhou.
-        portMAX_DELAY faz com que a função espere indefinidamente até que um dos eventos ocorra.
+        wifi_manager_wait() espera até que o dispositivo obtenha IP ou que a fase rápida de tentativas se esgote.
+        portMAX_DELAY faz com que a função espere indefinidamente até que um dos dois ocorra. Na falha, as tentativas continuam em 
+        segundo plano; wifi_manager_get_state() informa o estado a qualquer momento, sem bloquear.
     */
-    EventBits_t eventBits = xEventGroupWaitBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT, pdFALSE, pdFALSE, portMAX_DELAY);
+    if (wifi_manager_wait(portMAX_DELAY)) {
+        ASYNC_LOGI(TAG, "connected to ap SSID:%s password:%s", EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
+    } else {
+        ASYNC_LOGI(TAG, "Failed to connect to SSID:%s, password:%s - retrying in background", EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
+    }
 
-    /* Verificação do Resultado
+    /* Linha do Tempo do Boot
 
-        O código verifica qual bit foi definido e imprime um log correspondente:
-        Se WIFI_CONNECTED_BIT foi definido, indica que a conexão foi bem-sucedida.
-        Se WIFI_FAIL_BIT foi definido, indica que a conexão falhou após o número máximo de tentativas.
-        Qualquer outro caso é tratado como um evento inesperado. 
+        boot_trace_print() mostra em que instante o app_main começou e quanto cada fase levou desde a anterior (NVS, netif, 
+        Wi-Fi, associação e IP), seguido dos boots anteriores guardados na memória RTC. Uma fase que ficou mais lenta de um 
+        boot para o outro aparece lado a lado.
     */
-    if (eventBits & WIFI_CONNECTED_BIT) {
-        ESP_LOGI(TAG, "connected to ap SSID:%s password:%s", EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
-    } else if (eventBits & WIFI_FAIL_BIT) {
-        ESP_LOGI(TAG, "Failed to connect to SSID:%s, password:%s", EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
-    } else {
-        ESP_LOGE(TAG, "UNEXPECTED EVENT");
-    }
+    boot_trace_print();
 
 }
 
 /* Função principal */
 void app_main(void) {
+
+    // Linha do tempo do boot - marca o início do app_main e abre o registro na memória RTC
+    boot_trace_start();
+
+    // Log assíncrono - formatação (ou codificação binária) fora do chamador
+    async_log_init();
    
     /*  Inicialização do NVS (Non-Volatile Storage)
        
@@ -268,13 +277,7 @@ void app_main(void) {
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
-
-    /* Criação de um Grupo de Eventos
-        
-        Um grupo de eventos é criado usando xEventGroupCreate(). Esse grupo (s_wifi_event_group) será usado para sinalizar eventos como sucesso ou falha 
-        na conexão Wi-Fi.
-    */
-    s_wifi_event_group = xEventGroupCreate();
+    boot_trace_mark(BOOT_TRACE_NVS);
 
     /* Log de Modo Wi-Fi
         
@@ -282,18 +285,17 @@ void app_main(void) {
         configurado e inicializado. TAG é geralmente uma string que identifica o módulo ou componente que está emitindo o log, e ESP_LOGI é uma 
         função de log de informações.
     */
-    ESP_LOGI(TAG, "ESP_WIFI_MODE_STA");
+    ASYNC_LOGI(TAG, "ESP_WIFI_MODE_STA");
 
     /* Esta função configura e inicia o Wi-Fi em modo station (STA). 
     
         Isso inclui:
 
-        - Criação de um grupo de eventos.
         - Inicialização da interface de rede.
         - Configuração dos parâmetros Wi-Fi (SSID e senha).
         - Registro de manipuladores de eventos para tratar conexão, desconexão e obtenção de IP.
-        - Tentativa de conexão ao ponto de acesso especificado.
-        - Espera até que a conexão seja estabelecida ou que todas as tentativas falhem.
+        - Tentativas de conexão ao ponto de acesso especificado, com espera exponencial (wifi_manager).
+        - Espera até que a conexão seja estabelecida ou que a fase rápida de tentativas se esgote.
     */
     wifi_init_sta();
 }
\ No newline at end of file
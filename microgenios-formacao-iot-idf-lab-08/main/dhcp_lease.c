@@ -0,0 +1,550 @@
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "lwip/sockets.h"
+#include "lwip/dhcp.h"
+#include "async_log.h"
+
+#include "dhcp_lease.h"
+
+#define LEASE_NVS_NAMESPACE                 "dhcp_lease"
+#define LEASE_NVS_KEY                       "lease"
+
+#define LEASE_TASK_STACK                    3072
+#define LEASE_TASK_PRIORITY                 2
+#define LEASE_REQUEST_TRIES                 3                       // Espera de 1, 2 e 4 s pela resposta
+#define LEASE_RETRY_MS                      (60 * 1000)             // Servidor sem resposta - nova tentativa
+#define LEASE_RENEW_MAX_MS                  (12 * 60 * 60 * 1000)   // Teto da renovação (lease infinito)
+#define LEASE_INFINITE                      UINT32_MAX              // Opção 51 com 0xffffffff (RFC 2132 9.2)
+#define LEASE_CLOCK_VALID_S                 1577836800              // 2020-01-01 - antes disso o relógio não foi acertado
+
+/* Mensagem DHCP (RFC 2131): cabeçalho BOOTP de 236 bytes, cookie e opções */
+#define DHCP_SERVER_PORT                    67
+#define DHCP_CLIENT_PORT                    68
+#define DHCP_PACKET_SIZE                    548
+#define DHCP_OFFSET_XID                     4
+#define DHCP_OFFSET_CIADDR                  12
+#define DHCP_OFFSET_YIADDR                  16
+#define DHCP_OFFSET_CHADDR                  28
+#define DHCP_OFFSET_COOKIE                  236
+#define DHCP_OFFSET_OPTIONS                 240
+#define DHCP_MAGIC_COOKIE                   0x63825363
+
+#define DHCP_OPTION_PAD                     0
+#define DHCP_OPTION_SUBNET_MASK             1
+#define DHCP_OPTION_ROUTER                  3
+#define DHCP_OPTION_DNS                     6
+#define DHCP_OPTION_LEASE_TIME              51
+#define DHCP_OPTION_MESSAGE_TYPE            53
+#define DHCP_OPTION_SERVER_ID               54
+#define DHCP_OPTION_PARAM_LIST              55
+#define DHCP_OPTION_END                     255
+
+#define DHCP_REQUEST                        3
+#define DHCP_ACK                            5
+#define DHCP_NAK                            6
+
+static const char *TAG = "dhcp_lease";
+
+/* Registro na NVS - o SSID confirma que o lease é da rede associada. Endereços na ordem de rede, como no esp_netif.
+   O vencimento é acquired + lease_s no relógio do sistema */
+typedef struct {
+    uint8_t ssid[32];
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gw;
+    esp_ip4_addr_t dns_main;
+    esp_ip4_addr_t dns_backup;
+    esp_ip4_addr_t server;          // Servidor do último ACK (opção 54) - a renovação vai direto para ele
+    uint32_t acquired;              // time() do ACK gravado - atrasa no máximo lease_s/4, o vencimento calculado é conservador
+    uint32_t lease_s;               // Tempo de lease do último ACK
+} lease_record_t;
+
+/* Resposta do servidor ao DHCPREQUEST */
+typedef struct {
+    uint8_t type;                   // DHCP_ACK, DHCP_NAK ou 0 sem resposta
+    lease_record_t lease;
+    uint32_t lease_s;
+    esp_ip4_addr_t server;
+} lease_reply_t;
+
+static esp_netif_t *s_netif;
+static TaskHandle_t s_task;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static lease_record_t s_lease;      // Cópia do que está na NVS
+static bool s_lease_valid;
+static bool s_active;               // Lease em cache aplicado - a renovação é da task, o cliente DHCP está parado
+static uint8_t s_ssid[32];          // Rede da associação atual
+static int64_t s_acquired_us;       // esp_timer do último ACK neste boot - 0 = lease lido da NVS
+
+static void lease_load(void) {
+
+    nvs_handle_t nvs;
+    size_t len = sizeof(s_lease);
+
+    s_lease_valid = false;
+    if (nvs_open(LEASE_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return;     // Primeiro boot - namespace ainda não existe
+    }
+    s_lease_valid = nvs_get_blob(nvs, LEASE_NVS_KEY, &s_lease, &len) == ESP_OK && len == sizeof(s_lease);
+    nvs_close(nvs);
+}
+
+static bool lease_same_address(const lease_record_t *a, const lease_record_t *b) {
+
+    return a->ip.addr == b->ip.addr && a->netmask.addr == b->netmask.addr && a->gw.addr == b->gw.addr
+           && a->dns_main.addr == b->dns_main.addr && a->dns_backup.addr == b->dns_backup.addr;
+}
+
+/* A renovação só precisa ir para a flash se mudou o lease ou se o vencimento gravado ficou longe do real.
+   O horário do ACK só conta com o relógio acertado e com desvio acima de lease_s/4 - um T1 a cada metade do lease
+   com os mesmos dados não grava nada */
+static bool lease_outdated(const lease_record_t *stored, const lease_record_t *lease) {
+
+    if (memcmp(stored->ssid, lease->ssid, sizeof(stored->ssid)) != 0 || !lease_same_address(stored, lease)
+        || stored->server.addr != lease->server.addr || stored->lease_s != lease->lease_s) {
+        return true;
+    }
+    if (lease->acquired < LEASE_CLOCK_VALID_S) {
+        return false;       // Sem relógio o horário novo não vale mais que o gravado
+    }
+    if (stored->acquired < LEASE_CLOCK_VALID_S) {
+        return true;        // Primeiro ACK com o relógio acertado - o gravado não servia para calcular o vencimento
+    }
+    // Mesmo lease_s - o desvio do vencimento é o desvio do horário do ACK
+    int64_t drift_s = (int64_t)lease->acquired - stored->acquired;
+    return (drift_s < 0 ? -drift_s : drift_s) > lease->lease_s / 4;
+}
+
+/* Grava só o que mudou (ver lease_outdated) - a cópia em RAM segue a NVS, a idade do lease neste boot vem do
+   esp_timer */
+static void lease_store(const lease_record_t *lease) {
+
+    taskENTER_CRITICAL(&s_lock);
+    bool unchanged = s_lease_valid && !lease_outdated(&s_lease, lease);
+    taskEXIT_CRITICAL(&s_lock);
+    if (unchanged) {
+        return;
+    }
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(LEASE_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, LEASE_NVS_KEY, lease, sizeof(*lease));
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        ASYNC_LOGW(TAG, "Falha ao gravar o lease na NVS: %s", esp_err_to_name(err));
+        return;
+    }
+    taskENTER_CRITICAL(&s_lock);
+    s_lease = *lease;
+    s_lease_valid = true;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/* ACK (ou GOT_IP do cliente DHCP) neste boot - a idade do lease passa a vir do esp_timer */
+static void lease_acquired(lease_record_t *lease) {
+
+    lease->acquired = time(NULL);
+    taskENTER_CRITICAL(&s_lock);
+    s_acquired_us = esp_timer_get_time();
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+static void lease_erase(void) {
+
+    nvs_handle_t nvs;
+
+    if (nvs_open(LEASE_NVS_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+        nvs_erase_key(nvs, LEASE_NVS_KEY);
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+    taskENTER_CRITICAL(&s_lock);
+    s_lease_valid = false;
+    s_acquired_us = 0;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/* Mesmo endereço, máscara, gateway e DNS - o resto do registro muda a cada ACK */
+/* Segundos até o vencimento (<= 0 vencido, INT64_MAX para lease infinito). Retorna false se a idade é desconhecida:
+   lease lido da NVS e relógio nunca acertado - sem SNTP ele volta a 1970 no power-on */
+static bool lease_remaining(const lease_record_t *lease, int64_t *remaining_s) {
+
+    int64_t age_s;
+    int64_t now = time(NULL);
+
+    taskENTER_CRITICAL(&s_lock);
+    int64_t acquired_us = s_acquired_us;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (acquired_us != 0) {
+        age_s = (esp_timer_get_time() - acquired_us) / 1000000;
+    } else if (now >= LEASE_CLOCK_VALID_S && lease->acquired >= LEASE_CLOCK_VALID_S && now >= lease->acquired) {
+        age_s = now - lease->acquired;
+    } else {
+        return false;
+    }
+    *remaining_s = lease->lease_s == LEASE_INFINITE ? INT64_MAX : (int64_t)lease->lease_s - age_s;
+    return true;
+}
+
+static void lease_set_dns(esp_netif_dns_type_t type, esp_ip4_addr_t addr) {
+
+    if (addr.addr == 0) {
+        return;
+    }
+    esp_netif_dns_info_t dns = {
+        .ip.u_addr.ip4 = addr,
+        .ip.type = ESP_IPADDR_TYPE_V4,
+    };
+    esp_netif_set_dns_info(s_netif, type, &dns);
+}
+
+/* Aplica o lease como IP fixo - o esp_netif publica o IP_EVENT_STA_GOT_IP */
+static void lease_apply(const lease_record_t *lease) {
+
+    esp_err_t err = esp_netif_dhcpc_stop(s_netif);
+    if (err != ESP_OK && err != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED) {
+        ASYNC_LOGE(TAG, "Failed to stop dhcp client");
+        return;
+    }
+
+    esp_netif_ip_info_t ip_info = {
+        .ip = lease->ip,
+        .netmask = lease->netmask,
+        .gw = lease->gw,
+    };
+    if (esp_netif_set_ip_info(s_netif, &ip_info) != ESP_OK) {
+        ASYNC_LOGE(TAG, "Failed to set ip info");
+        return;
+    }
+    lease_set_dns(ESP_NETIF_DNS_MAIN, lease->dns_main);
+    lease_set_dns(ESP_NETIF_DNS_BACKUP, lease->dns_backup);
+}
+
+/* Abandona o lease em cache: tira o IP fixo da interface e o cliente DHCP do esp_netif faz a troca completa */
+static void lease_drop(void) {
+
+    taskENTER_CRITICAL(&s_lock);
+    s_active = false;
+    taskEXIT_CRITICAL(&s_lock);
+    lease_erase();
+
+    esp_netif_ip_info_t ip_info = { 0 };
+    esp_netif_set_ip_info(s_netif, &ip_info);
+    esp_netif_dhcpc_start(s_netif);
+}
+
+/* DHCPREQUEST com o IP atual em ciaddr (renovação, RFC 2131 4.3.2) - sem "requested IP" nem "server id" */
+static int lease_build_request(uint8_t *packet, uint32_t xid, esp_ip4_addr_t ip) {
+
+    memset(packet, 0, DHCP_PACKET_SIZE);
+    packet[0] = 1;          // BOOTREQUEST
+    packet[1] = 1;          // Ethernet
+    packet[2] = 6;          // Tamanho do MAC
+    memcpy(&packet[DHCP_OFFSET_XID], &xid, sizeof(xid));
+    memcpy(&packet[DHCP_OFFSET_CIADDR], &ip.addr, sizeof(ip.addr));
+    esp_netif_get_mac(s_netif, &packet[DHCP_OFFSET_CHADDR]);
+
+    uint32_t cookie = htonl(DHCP_MAGIC_COOKIE);
+    memcpy(&packet[DHCP_OFFSET_COOKIE], &cookie, sizeof(cookie));
+
+    uint8_t *option = &packet[DHCP_OFFSET_OPTIONS];
+    *option++ = DHCP_OPTION_MESSAGE_TYPE;
+    *option++ = 1;
+    *option++ = DHCP_REQUEST;
+    *option++ = DHCP_OPTION_PARAM_LIST;
+    *option++ = 4;
+    *option++ = DHCP_OPTION_SUBNET_MASK;
+    *option++ = DHCP_OPTION_ROUTER;
+    *option++ = DHCP_OPTION_DNS;
+    *option++ = DHCP_OPTION_LEASE_TIME;
+    *option++ = DHCP_OPTION_END;
+
+    // Mínimo de 300 bytes do BOOTP - alguns servidores descartam mensagens menores
+    return MAX((int)(option - packet), 300);
+}
+
+/* Lê a resposta. Retorna false se ela não for para esta requisição */
+static bool lease_parse_reply(const uint8_t *packet, int len, uint32_t xid, const uint8_t *mac, lease_reply_t *reply) {
+
+    uint32_t cookie;
+
+    if (len < DHCP_OFFSET_OPTIONS || packet[0] != 2 || memcmp(&packet[DHCP_OFFSET_XID], &xid, sizeof(xid)) != 0
+        || memcmp(&packet[DHCP_OFFSET_CHADDR], mac, 6) != 0) {
+        return false;
+    }
+    memcpy(&cookie, &packet[DHCP_OFFSET_COOKIE], sizeof(cookie));
+    if (cookie != htonl(DHCP_MAGIC_COOKIE)) {
+        return false;
+    }
+
+    memcpy(&reply->lease.ip.addr, &packet[DHCP_OFFSET_YIADDR], sizeof(reply->lease.ip.addr));
+
+    // Opções em TLV - as que faltarem ficam com o valor do lease em cache
+    int pos = DHCP_OFFSET_OPTIONS;
+    while (pos < len && packet[pos] != DHCP_OPTION_END) {
+        uint8_t code = packet[pos];
+        if (code == DHCP_OPTION_PAD) {
+            pos++;
+            continue;
+        }
+        if (pos + 2 > len || pos + 2 + packet[pos + 1] > len) {
+            break;
+        }
+        uint8_t size = packet[pos + 1];
+        const uint8_t *value = &packet[pos + 2];
+
+        switch (code) {
+        case DHCP_OPTION_MESSAGE_TYPE:
+            reply->type = size >= 1 ? value[0] : 0;
+            break;
+        case DHCP_OPTION_SUBNET_MASK:
+            if (size >= 4) memcpy(&reply->lease.netmask.addr, value, 4);
+            break;
+        case DHCP_OPTION_ROUTER:
+            if (size >= 4) memcpy(&reply->lease.gw.addr, value, 4);
+            break;
+        case DHCP_OPTION_DNS:
+            if (size >= 4) memcpy(&reply->lease.dns_main.addr, value, 4);
+            if (size >= 8) memcpy(&reply->lease.dns_backup.addr, value + 4, 4);
+            break;
+        case DHCP_OPTION_LEASE_TIME:
+            if (size >= 4) {
+                memcpy(&reply->lease_s, value, 4);
+                reply->lease_s = ntohl(reply->lease_s);
+            }
+            break;
+        case DHCP_OPTION_SERVER_ID:
+            if (size >= 4) memcpy(&reply->server.addr, value, 4);
+            break;
+        default:
+            break;
+        }
+        pos += 2 + size;
+    }
+    return reply->type == DHCP_ACK || reply->type == DHCP_NAK;
+}
+
+/* Renovação: unicast para o servidor conhecido, broadcast (rebinding) sem ele */
+static void lease_request(const lease_record_t *lease, lease_reply_t *reply) {
+
+    uint8_t packet[DHCP_PACKET_SIZE];
+    uint8_t mac[6];
+    uint32_t xid = esp_random();
+    int len = lease_build_request(packet, xid, lease->ip);
+
+    memset(reply, 0, sizeof(*reply));
+    esp_netif_get_mac(s_netif, mac);
+
+    // Com o cliente DHCP parado, a porta 68 está livre no lwIP
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ASYNC_LOGE(TAG, "Não foi possível criar o socket: errno %d", errno);
+        return;
+    }
+    int opt = 1;
+    setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &opt, sizeof(opt));
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in local = {
+        .sin_family = AF_INET,
+        .sin_port = htons(DHCP_CLIENT_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(sock, (struct sockaddr *)&local, sizeof(local)) != 0) {
+        ASYNC_LOGE(TAG, "Porta %d ocupada: errno %d", DHCP_CLIENT_PORT, errno);
+        close(sock);
+        return;
+    }
+
+    struct sockaddr_in dest = {
+        .sin_family = AF_INET,
+        .sin_port = htons(DHCP_SERVER_PORT),
+        .sin_addr.s_addr = lease->server.addr != 0 ? lease->server.addr : htonl(INADDR_BROADCAST),
+    };
+
+    for (int attempt = 0; attempt < LEASE_REQUEST_TRIES && reply->type == 0; attempt++) {
+        struct timeval timeout = { .tv_sec = 1 << attempt };
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        if (sendto(sock, packet, len, 0, (struct sockaddr *)&dest, sizeof(dest)) < 0) {
+            ASYNC_LOGW(TAG, "Falha ao enviar o DHCPREQUEST: errno %d", errno);
+            continue;
+        }
+        // Descarta respostas de outras requisições até o timeout
+        for (;;) {
+            uint8_t response[DHCP_PACKET_SIZE];
+            reply->lease = *lease;
+            int received = recv(sock, response, sizeof(response), 0);
+            if (received < 0) {
+                break;
+            }
+            if (lease_parse_reply(response, received, xid, mac, reply)) {
+                break;
+            }
+            reply->type = 0;
+        }
+    }
+    close(sock);
+}
+
+// Task - Lease renewal
+static void task_dhcp_lease(void *pvParameters) {
+
+    TickType_t wait = portMAX_DELAY;
+
+    for (;;) {
+        // Acorda na associação (lease recém-aplicado) ou no vencimento da renovação
+        ulTaskNotifyTake(pdTRUE, wait);
+        wait = portMAX_DELAY;
+
+        taskENTER_CRITICAL(&s_lock);
+        bool active = s_active;
+        lease_record_t lease = s_lease;
+        taskEXIT_CRITICAL(&s_lock);
+        if (!active) {
+            continue;
+        }
+
+        lease_reply_t reply;
+        lease_request(&lease, &reply);
+
+        if (reply.type == DHCP_NAK) {
+            // Lease recusado - o cliente DHCP do esp_netif assume e grava o novo no GOT_IP
+            ASYNC_LOGW(TAG, "Lease " IPSTR " recusado (NAK) - DHCP completo", IP2STR(&lease.ip));
+            lease_drop();
+            continue;
+        }
+        if (reply.type != DHCP_ACK) {
+            // Sem resposta o lease vale até o vencimento. Com idade desconhecida só um ACK o mantém
+            int64_t remaining_s;
+            if (!lease_remaining(&lease, &remaining_s) || remaining_s <= 0) {
+                ASYNC_LOGW(TAG, "Lease " IPSTR " vencido sem ACK - DHCP completo", IP2STR(&lease.ip));
+                lease_drop();
+                continue;
+            }
+            ASYNC_LOGW(TAG, "Servidor DHCP sem resposta - mantendo " IPSTR, IP2STR(&lease.ip));
+            wait = pdMS_TO_TICKS(MIN(remaining_s, LEASE_RETRY_MS / 1000) * 1000);
+            continue;
+        }
+
+        // Servidor, aquisição e tempo do ACK - opção ausente mantém o valor anterior
+        if (reply.server.addr != 0) {
+            reply.lease.server = reply.server;
+        }
+        lease_acquired(&reply.lease);
+        if (reply.lease_s != 0) {
+            reply.lease.lease_s = reply.lease_s;
+        }
+
+        // Só troca de endereço se o lease mudou
+        if (!lease_same_address(&reply.lease, &lease)) {
+            ASYNC_LOGI(TAG, "Lease mudou - " IPSTR, IP2STR(&reply.lease.ip));
+            lease_apply(&reply.lease);
+        } else {
+            ASYNC_LOGI(TAG, "Lease " IPSTR " confirmado por %lu s", IP2STR(&lease.ip), (unsigned long)reply.lease.lease_s);
+        }
+        lease_store(&reply.lease);
+
+        // Renova na metade do lease (T1)
+        uint64_t renew_ms = (uint64_t)reply.lease.lease_s * 1000 / 2;
+        wait = pdMS_TO_TICKS(MIN(MAX(renew_ms, LEASE_RETRY_MS), LEASE_RENEW_MAX_MS));
+    }
+}
+
+void dhcp_lease_init(esp_netif_t *netif) {
+
+    s_netif = netif;
+    lease_load();
+    xTaskCreate(task_dhcp_lease, "dhcp_lease", LEASE_TASK_STACK, NULL, LEASE_TASK_PRIORITY, &s_task);
+}
+
+void dhcp_lease_on_connected(const wifi_event_sta_connected_t *event) {
+
+    memset(s_ssid, 0, sizeof(s_ssid));
+    memcpy(s_ssid, event->ssid, MIN(event->ssid_len, sizeof(s_ssid)));
+
+    taskENTER_CRITICAL(&s_lock);
+    lease_record_t lease = s_lease;
+    bool cached = s_lease_valid && memcmp(lease.ssid, s_ssid, sizeof(s_ssid)) == 0;
+    taskEXIT_CRITICAL(&s_lock);
+
+    // Lease sabidamente vencido não vira IP fixo. Idade desconhecida (power-on) segue no caminho rápido
+    int64_t remaining_s;
+    if (cached && lease_remaining(&lease, &remaining_s) && remaining_s <= 0) {
+        ASYNC_LOGI(TAG, "Lease em cache vencido - DHCP completo");
+        cached = false;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    s_active = cached;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (!cached) {
+        // Sem cache desta rede - o cliente DHCP faz a troca completa
+        ASYNC_LOGI(TAG, "Sem lease em cache - DHCP completo");
+        esp_netif_dhcpc_start(s_netif);
+        return;
+    }
+
+    ASYNC_LOGI(TAG, "Lease em cache - " IPSTR, IP2STR(&lease.ip));
+    lease_apply(&lease);
+    xTaskNotifyGive(s_task);
+}
+
+/* Tempo de lease e servidor do cliente DHCP do lwIP - a struct dhcp é da task tcpip */
+static esp_err_t lease_read_dhcp(void *ctx) {
+
+    lease_record_t *lease = ctx;
+    struct dhcp *dhcp = netif_dhcp_data((struct netif *)esp_netif_get_netif_impl(s_netif));
+
+    if (dhcp != NULL) {
+        lease->lease_s = dhcp->offered_t0_lease;
+        lease->server.addr = ip4_addr_get_u32(ip_2_ip4(&dhcp->server_ip_addr));
+    }
+    return ESP_OK;
+}
+
+void dhcp_lease_on_got_ip(const esp_netif_ip_info_t *ip_info) {
+
+    esp_netif_dhcp_status_t status;
+
+    // IP do lease em cache (cliente parado) - a task cuida dele
+    if (esp_netif_dhcpc_get_status(s_netif, &status) != ESP_OK || status != ESP_NETIF_DHCP_STARTED) {
+        return;
+    }
+
+    lease_record_t lease = {
+        .ip = ip_info->ip,
+        .netmask = ip_info->netmask,
+        .gw = ip_info->gw,
+    };
+    memcpy(lease.ssid, s_ssid, sizeof(lease.ssid));
+
+    esp_netif_dns_info_t dns;
+    if (esp_netif_get_dns_info(s_netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK && dns.ip.type == ESP_IPADDR_TYPE_V4) {
+        lease.dns_main = dns.ip.u_addr.ip4;
+    }
+    if (esp_netif_get_dns_info(s_netif, ESP_NETIF_DNS_BACKUP, &dns) == ESP_OK && dns.ip.type == ESP_IPADDR_TYPE_V4) {
+        lease.dns_backup = dns.ip.u_addr.ip4;
+    }
+
+    lease_acquired(&lease);
+    esp_netif_tcpip_exec(lease_read_dhcp, &lease);
+
+    ASYNC_LOGI(TAG, "Lease DHCP gravado - " IPSTR " por %lu s", IP2STR(&lease.ip), (unsigned long)lease.lease_s);
+    lease_store(&lease);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "esp_netif.h"
+#include "esp_wifi.h"
+
+/* Lease DHCP em cache (modo híbrido)
+
+    O último lease obtido por DHCP (IP, máscara, gateway, DNS, servidor e vencimento) fica na NVS. Na associação ele é
+    aplicado na hora, como um IP fixo, e o IP_EVENT_STA_GOT_IP sai sem esperar o DISCOVER/OFFER/REQUEST/ACK. Uma task
+    confirma o lease com o servidor em segundo plano (DHCPREQUEST, RFC 2131 4.3.2) e o renova na metade do tempo de lease:
+
+    - ACK com os mesmos dados: nada muda.
+    - ACK com outros dados: o novo lease é aplicado e gravado.
+    - NAK: o cache é apagado e o cliente DHCP do esp_netif assume, com a troca completa.
+    - Sem resposta: o lease em cache continua até vencer e a task tenta de novo mais tarde. Vencido, o IP fixo sai e o
+      cliente DHCP do esp_netif assume. Sem relógio acertado (SNTP) a idade de um lease da NVS é desconhecida: só um ACK
+      o mantém.
+
+    Lease em cache já vencido não usa o caminho rápido. Sem cache (primeiro boot ou outra rede), o cliente DHCP do esp_netif
+    faz a troca completa e o lease é gravado no GOT_IP.
+*/
+
+// Cria a task de renovação. Chamar depois do esp_netif_create_default_wifi_sta
+void dhcp_lease_init(esp_netif_t *netif);
+
+// WIFI_EVENT_STA_CONNECTED - aplica o lease em cache, se for da mesma rede
+void dhcp_lease_on_connected(const wifi_event_sta_connected_t *event);
+
+// IP_EVENT_STA_GOT_IP - grava o lease quando ele veio do cliente DHCP do esp_netif
+void dhcp_lease_on_got_ip(const esp_netif_ip_info_t *ip_info);
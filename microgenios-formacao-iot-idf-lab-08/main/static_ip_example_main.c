@@ -25,11 +25,16 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/event_groups.h"
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "async_log.h"
+#include "wifi_manager.h"
+#include "boot_trace.h"
+#if CONFIG_EXAMPLE_IP_MODE_CACHED_LEASE
+#include "dhcp_lease.h"
+#endif
 #include <netdb.h>
 #include "nvs_flash.h"
 
@@ -37,6 +42,7 @@
 #define EXAMPLE_WIFI_SSID                   CONFIG_EXAMPLE_WIFI_SSID
 #define EXAMPLE_WIFI_PASS                   CONFIG_EXAMPLE_WIFI_PASSWORD
 #define EXAMPLE_MAXIMUM_RETRY               CONFIG_EXAMPLE_MAXIMUM_RETRY
+#if CONFIG_EXAMPLE_IP_MODE_STATIC
 #define EXAMPLE_STATIC_IP_ADDR              CONFIG_EXAMPLE_STATIC_IP_ADDR
 #define EXAMPLE_STATIC_NETMASK_ADDR         CONFIG_EXAMPLE_STATIC_NETMASK_ADDR
 #define EXAMPLE_STATIC_GW_ADDR              CONFIG_EXAMPLE_STATIC_GW_ADDR
@@ -47,24 +53,14 @@
 #define EXAMPLE_MAIN_DNS_SERVER             CONFIG_EXAMPLE_STATIC_DNS_SERVER_MAIN
 #define EXAMPLE_BACKUP_DNS_SERVER           CONFIG_EXAMPLE_STATIC_DNS_SERVER_BACKUP
 #endif
+#endif
 #ifdef CONFIG_EXAMPLE_STATIC_DNS_RESOLVE_TEST
 #define EXAMPLE_RESOLVE_DOMAIN              CONFIG_EXAMPLE_STATIC_RESOLVE_DOMAIN
 #endif
 
-/* Grupo de eventos FreeRTOS para sinalizar quando estamos conectados */
-static EventGroupHandle_t s_wifi_event_group;
-
-/* O grupo de eventos permite vários bits para cada evento, mas só nos preocupamos com dois eventos:
-  - estamos conectados ao ponto de acesso (AP) com um IP
-  - falhamos ao tentar conectar após o número máximo de tentativas
-*/
-#define WIFI_CONNECTED_BIT BIT0
-#define WIFI_FAIL_BIT BIT1
-
 static const char *TAG = "static_ip";
 
-static int s_retry_num = 0;
-
+#if CONFIG_EXAMPLE_IP_MODE_STATIC
 static esp_err_t example_set_dns_server(esp_netif_t *netif, uint32_t addr, esp_netif_dns_type_t type) {
     
     if (addr && (addr != IPADDR_NONE)) {
@@ -80,7 +76,7 @@ static esp_err_t example_set_dns_server(esp_netif_t *netif, uint32_t addr, esp_n
 static void example_set_static_ip(esp_netif_t *netif) {
 
     if (esp_netif_dhcpc_stop(netif) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to stop dhcp client");
+        ASYNC_LOGE(TAG, "Failed to stop dhcp client");
         return;
     }
 
@@ -91,60 +87,70 @@ static void example_set_static_ip(esp_netif_t *netif) {
     ip.gw.addr = ipaddr_addr(EXAMPLE_STATIC_GW_ADDR);
     
     if (esp_netif_set_ip_info(netif, &ip) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set ip info");
+        ASYNC_LOGE(TAG, "Failed to set ip info");
         return;
     }
 
-    ESP_LOGD(TAG, "Success to set static ip: %s, netmask: %s, gw: %s", EXAMPLE_STATIC_IP_ADDR, EXAMPLE_STATIC_NETMASK_ADDR, EXAMPLE_STATIC_GW_ADDR);
+    ASYNC_LOGD(TAG, "Success to set static ip: %s, netmask: %s, gw: %s", EXAMPLE_STATIC_IP_ADDR, EXAMPLE_STATIC_NETMASK_ADDR, EXAMPLE_STATIC_GW_ADDR);
     ESP_ERROR_CHECK(example_set_dns_server(netif, ipaddr_addr(EXAMPLE_MAIN_DNS_SERVER), ESP_NETIF_DNS_MAIN));
     ESP_ERROR_CHECK(example_set_dns_server(netif, ipaddr_addr(EXAMPLE_BACKUP_DNS_SERVER), ESP_NETIF_DNS_BACKUP));\
 }
+#endif
 
+// Reconexão com o wifi_manager - aqui o IP (fixo ou do lease em cache) a cada associação e os logs
 static void event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
 
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        esp_wifi_connect();
-    }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        boot_trace_mark(BOOT_TRACE_ASSOCIATED);
+#if CONFIG_EXAMPLE_IP_MODE_CACHED_LEASE
+        dhcp_lease_on_connected((wifi_event_sta_connected_t *)event_data);
+#else
         example_set_static_ip(arg);
+#endif
     }
     else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        if (s_retry_num < EXAMPLE_MAXIMUM_RETRY) {
-            esp_wifi_connect();
-            s_retry_num++;
-            ESP_LOGI(TAG, "retry to connect to the AP");
-        }
-        else {
-            xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
-        }
-
-        ESP_LOGI(TAG, "connect to the AP fail");
+        ASYNC_LOGI(TAG, "connect to the AP fail - %s", wifi_manager_state_name(wifi_manager_get_state()));
     }
     else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
-        ESP_LOGI(TAG, "static ip:" IPSTR, IP2STR(&event->ip_info.ip));
-        s_retry_num = 0;
-        xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+        ASYNC_LOGI(TAG, "static ip:" IPSTR, IP2STR(&event->ip_info.ip));
+#if CONFIG_EXAMPLE_IP_MODE_CACHED_LEASE
+        dhcp_lease_on_got_ip(&event->ip_info);
+#endif
+        boot_trace_mark(BOOT_TRACE_GOT_IP);
     }
 }
 
 void wifi_init_sta(void) {
 
     ESP_ERROR_CHECK(esp_netif_init());
+    boot_trace_mark(BOOT_TRACE_NETIF);
 
     ESP_ERROR_CHECK(esp_event_loop_create_default());
 
     esp_netif_t *sta_netif = esp_netif_create_default_wifi_sta();
     assert(sta_netif);
 
+#if CONFIG_EXAMPLE_IP_MODE_CACHED_LEASE
+    /* Lease DHCP em cache - lido da NVS agora, aplicado na associação e renovado por uma task */
+    dhcp_lease_init(sta_netif);
+#endif
+
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+    boot_trace_mark(BOOT_TRACE_WIFI_INIT);
 
     esp_event_handler_instance_t instance_any_id;
     esp_event_handler_instance_t instance_got_ip;
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &event_handler, sta_netif, &instance_any_id));
     ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &event_handler, sta_netif, &instance_got_ip));
 
+    /* Conexão e reconexão com backoff - EXAMPLE_MAXIMUM_RETRY tentativas rápidas, depois sem limite */
+    const wifi_manager_config_t manager_config = {
+        .fast_retries = EXAMPLE_MAXIMUM_RETRY,
+    };
+    ESP_ERROR_CHECK(wifi_manager_start(&manager_config));
+
     wifi_config_t wifi_config = {
         .sta = {
             .ssid = EXAMPLE_WIFI_SSID,
@@ -156,22 +162,21 @@ void wifi_init_sta(void) {
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
+    boot_trace_mark(BOOT_TRACE_WIFI_START);
 
-    ESP_LOGI(TAG, "wifi_init_sta finished.");
-
-    /* Aguarda evento */
-    EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT, pdFALSE, pdFALSE, portMAX_DELAY);
+    ASYNC_LOGI(TAG, "wifi_init_sta finished.");
 
-    if (bits & WIFI_CONNECTED_BIT) {
-        ESP_LOGI(TAG, "connected to ap SSID:%s password:%s", EXAMPLE_WIFI_SSID, EXAMPLE_WIFI_PASS);
-    }
-    else if (bits & WIFI_FAIL_BIT) {
-        ESP_LOGI(TAG, "Failed to connect to SSID:%s, password:%s", EXAMPLE_WIFI_SSID, EXAMPLE_WIFI_PASS);
+    /* Aguarda o IP ou o fim da fase rápida - as tentativas seguem em segundo plano */
+    if (wifi_manager_wait(portMAX_DELAY)) {
+        ASYNC_LOGI(TAG, "connected to ap SSID:%s password:%s", EXAMPLE_WIFI_SSID, EXAMPLE_WIFI_PASS);
     }
     else {
-        ESP_LOGE(TAG, "UNEXPECTED EVENT");
+        ASYNC_LOGI(TAG, "Failed to connect to SSID:%s, password:%s - retrying in background", EXAMPLE_WIFI_SSID, EXAMPLE_WIFI_PASS);
     }
 
+    /* Linha do tempo do boot - com IP fixo ou lease em cache, "ip" é o esp_netif_set_ip_info logo após a associação */
+    boot_trace_print();
+
 #ifdef CONFIG_EXAMPLE_STATIC_DNS_RESOLVE_TEST
     struct addrinfo *address_info;
     struct addrinfo hints;
@@ -182,9 +187,9 @@ void wifi_init_sta(void) {
     int res = getaddrinfo(EXAMPLE_RESOLVE_DOMAIN, NULL, &hints, &address_info);
     if (res != 0 || address_info == NULL)
     {
-        ESP_LOGE(TAG, "couldn't get hostname for :%s: "
-                      "getaddrinfo() returns %d, addrinfo=%p",
-                 EXAMPLE_RESOLVE_DOMAIN, res, address_info);
+        ASYNC_LOGE(TAG, "couldn't get hostname for :%s: "
+                        "getaddrinfo() returns %d, addrinfo=%p",
+                   EXAMPLE_RESOLVE_DOMAIN, res, address_info);
     }
     else
     {
@@ -202,14 +207,17 @@ void wifi_init_sta(void) {
 #endif
     }
 #endif
-    /* O evento não será processado após o cancelamento da inscrição */
-    ESP_ERROR_CHECK(esp_event_handler_instance_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, instance_got_ip));
-    ESP_ERROR_CHECK(esp_event_handler_instance_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, instance_any_id));
-    vEventGroupDelete(s_wifi_event_group);
+    /* Os handlers continuam registrados - cada reconexão do wifi_manager aplica o IP de novo */
 }
 
 void app_main(void)
 {
+    // Linha do tempo do boot - marca o início do app_main e abre o registro na memória RTC
+    boot_trace_start();
+
+    // Log assíncrono - formatação (ou codificação binária) fora do chamador
+    async_log_init();
+
     // Inicia a NVS
     esp_err_t ret = nvs_flash_init();
 
@@ -219,10 +227,8 @@ void app_main(void)
     }
 
     ESP_ERROR_CHECK(ret);
+    boot_trace_mark(BOOT_TRACE_NVS);
 
-    // Cria EventGroup
-    s_wifi_event_group = xEventGroupCreate();
-
-    ESP_LOGI(TAG, "ESP_WIFI_MODE_STA");
+    ASYNC_LOGI(TAG, "ESP_WIFI_MODE_STA");
     wifi_init_sta();
 }
@@ -0,0 +1,225 @@
+// Microbenchmark do line_scan (main/line_scan.c): procura de '\n' byte a byte, memchr,
+// SWAR com palavras de 4 (ESP32) e 8 bytes e o line_scan do servidor (byte a byte abaixo
+// de 8 bytes, memchr acima), sobre buffers com linhas de vários tamanhos.
+// Confere antes que todas as versões acham o mesmo índice em todos os alinhamentos.
+#define _GNU_SOURCE
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "line_scan.h"
+
+// Mesma fonte compilada com LINE_SCAN_WORD=uint32_t (CMakeLists.txt)
+uint32_t line_scan_swar_32(const uint8_t *data, uint32_t len);
+
+typedef uint32_t (*scan_fn_t)(const uint8_t *data, uint32_t len);
+
+// Referência - o laço que o line_scan substitui
+__attribute__((noinline)) static uint32_t scan_naive(const uint8_t *data, uint32_t len) {
+
+    for (uint32_t i = 0; i < len; i++) {
+        if (data[i] == '\n') {
+            return i;
+        }
+    }
+    return len;
+}
+
+static uint32_t scan_memchr(const uint8_t *data, uint32_t len) {
+
+    const uint8_t *eol = memchr(data, '\n', len);
+    return eol != NULL ? (uint32_t)(eol - data) : len;
+}
+
+static const struct {
+    const char *name;
+    scan_fn_t scan;
+} s_scanners[] = {
+    { "naive", scan_naive },
+    { "memchr", scan_memchr },
+    { "swar32", line_scan_swar_32 },
+    { "swar64", line_scan_swar },
+    { "line_scan", line_scan },
+};
+
+#define SCANNERS        (sizeof(s_scanners) / sizeof(s_scanners[0]))
+
+static double now_s(void) {
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Texto sem '\n' com um '\n' a cada line_len bytes (o último byte da linha)
+static void fill_lines(uint8_t *buffer, uint32_t size, uint32_t line_len) {
+
+    for (uint32_t i = 0; i < size; i++) {
+        buffer[i] = (i + 1) % line_len == 0 ? '\n' : (uint8_t)(' ' + rand() % 94);
+    }
+}
+
+// Todas as versões devem concordar em todos os alinhamentos e tamanhos
+static int check(void) {
+
+    uint8_t buffer[256];
+
+    for (int round = 0; round < 2000; round++) {
+        for (uint32_t i = 0; i < sizeof(buffer); i++) {
+            // Bytes vizinhos de '\n' (0x0A) exercitam os falsos positivos do SWAR
+            buffer[i] = rand() % 8 == 0 ? (uint8_t)(0x08 + rand() % 5) : (uint8_t)rand();
+            if (buffer[i] == '\n' && rand() % 4 != 0) {
+                buffer[i] = 0x8A;
+            }
+        }
+        for (uint32_t offset = 0; offset < 16; offset++) {
+            uint32_t len = rand() % (sizeof(buffer) - offset);
+            uint32_t expected = scan_naive(buffer + offset, len);
+            for (size_t s = 1; s < SCANNERS; s++) {
+                uint32_t got = s_scanners[s].scan(buffer + offset, len);
+                if (got != expected) {
+                    fprintf(stderr, "%s: offset %u len %u: %u, esperado %u\n", s_scanners[s].name, offset, len, got, expected);
+                    return -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Percorre o buffer linha a linha, como o line_framing faz com o RX ring
+static double bench(scan_fn_t scan, const uint8_t *buffer, uint32_t size, double min_time, uint64_t *lines) {
+
+    uint64_t found = 0;
+    uint64_t rounds = 0;
+    double start = now_s();
+    double elapsed;
+
+    do {
+        for (uint32_t pos = 0; pos < size; ) {
+            uint32_t eol = pos + scan(buffer + pos, size - pos);
+            found += eol < size;
+            pos = eol + 1;
+        }
+        rounds++;
+        elapsed = now_s() - start;
+    } while (elapsed < min_time);
+
+    *lines = found / rounds;
+    return (double)size * rounds / elapsed;
+}
+
+// Varreduras de scan_len bytes com o '\n' no último - um comando curto no RX ring
+static double bench_short(scan_fn_t scan, const uint8_t *buffer, uint32_t size, uint32_t scan_len, double min_time) {
+
+    uint64_t bytes = 0;
+    uint32_t sink = 0;
+    double start = now_s();
+    double elapsed;
+
+    do {
+        for (uint32_t pos = 0; pos + scan_len <= size; pos += scan_len) {
+            sink += scan(buffer + pos, scan_len);
+        }
+        bytes += size - size % scan_len;
+        elapsed = now_s() - start;
+    } while (elapsed < min_time);
+
+    // Impede que o compilador descarte as chamadas
+    if (sink == UINT32_MAX) {
+        printf(" ");
+    }
+    return (double)bytes / elapsed;
+}
+
+static void usage(const char *prog) {
+
+    fprintf(stderr, "uso: %s [-s BYTES] [-t SEGUNDOS]\n"
+                    "  -s, --size BYTES      tamanho do buffer (padrão 65536)\n"
+                    "  -t, --time SEGUNDOS   tempo mínimo por medida (padrão 0.2)\n", prog);
+}
+
+int main(int argc, char **argv) {
+
+    static const struct option options[] = {
+        { "size", required_argument, NULL, 's' },
+        { "time", required_argument, NULL, 't' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    static const uint32_t line_lengths[] = { 8, 16, 32, 64, 128, 512, 1024 };
+    static const uint32_t scan_lengths[] = { 4, 8, 12, 16, 24, 32 };
+    uint32_t size = 65536;
+    double min_time = 0.2;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "s:t:h", options, NULL)) != -1) {
+        switch (opt) {
+        case 's':
+            size = strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            min_time = strtod(optarg, NULL);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    srand(1);
+    if (check() != 0) {
+        return 1;
+    }
+
+    uint8_t *buffer = aligned_alloc(64, (size + 63) & ~63u);
+    if (buffer == NULL) {
+        return 1;
+    }
+
+    printf("%8s", "linha");
+    for (size_t s = 0; s < SCANNERS; s++) {
+        printf(" %10s", s_scanners[s].name);
+    }
+    printf("   (MB/s, buffer de %u bytes)\n", size);
+
+    for (size_t l = 0; l < sizeof(line_lengths) / sizeof(line_lengths[0]); l++) {
+        fill_lines(buffer, size, line_lengths[l]);
+        printf("%8u", line_lengths[l]);
+        uint64_t expected_lines = 0;
+        for (size_t s = 0; s < SCANNERS; s++) {
+            uint64_t lines;
+            double rate = bench(s_scanners[s].scan, buffer, size, min_time, &lines);
+            if (s == 0) {
+                expected_lines = lines;
+            } else if (lines != expected_lines) {
+                fprintf(stderr, "\n%s: %llu linhas, esperado %llu\n", s_scanners[s].name,
+                        (unsigned long long)lines, (unsigned long long)expected_lines);
+                return 1;
+            }
+            printf(" %10.0f", rate / 1e6);
+        }
+        printf("\n");
+    }
+
+    printf("\n%8s", "varredura");
+    for (size_t s = 0; s < SCANNERS; s++) {
+        printf(" %10s", s_scanners[s].name);
+    }
+    printf("   (MB/s, uma linha por varredura)\n");
+
+    for (size_t l = 0; l < sizeof(scan_lengths) / sizeof(scan_lengths[0]); l++) {
+        fill_lines(buffer, size, scan_lengths[l]);
+        printf("%8u", scan_lengths[l]);
+        for (size_t s = 0; s < SCANNERS; s++) {
+            printf(" %10.0f", bench_short(s_scanners[s].scan, buffer, size, scan_lengths[l], min_time) / 1e6);
+        }
+        printf("\n");
+    }
+
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,89 @@
+#!/usr/bin/env bash
+# Compara os perfis de tasks (components/task_profile) no tcp-server-02: para cada perfil
+# compila, grava a placa, roda o tcp_bench e no fim mostra vazão e latência lado a lado.
+#
+# uso: ./profile_sweep.sh -H IP_DA_PLACA -P /dev/ttyUSB0 [-b SEGUNDOS] [-- opções do tcp_bench]
+#
+# Parte do sdkconfig atual do projeto (Wi-Fi, modo do servidor...) e troca só o perfil.
+# Os perfis que fixam a rede no core 0 recebem também LWIP_TCPIP_TASK_AFFINITY_CPU0.
+
+set -euo pipefail
+
+BENCH_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_DIR="$(dirname "$BENCH_DIR")"
+TCP_BENCH="${TCP_BENCH:-$BENCH_DIR/build/tcp_bench}"
+PROFILES="UNPINNED SPLIT LATENCY"
+
+host=""
+port=""
+boot_wait=8
+while getopts "H:P:b:h" opt; do
+    case "$opt" in
+        H) host="$OPTARG" ;;
+        P) port="$OPTARG" ;;
+        b) boot_wait="$OPTARG" ;;
+        *) sed -n '2,8p' "$0"; exit 2 ;;
+    esac
+done
+shift $((OPTIND - 1))
+bench_args=("$@")
+
+if [ -z "$host" ] || [ -z "$port" ]; then
+    sed -n '2,8p' "$0"
+    exit 2
+fi
+if [ ! -x "$TCP_BENCH" ]; then
+    echo "tcp_bench não encontrado em $TCP_BENCH - compile com cmake -S . -B build" >&2
+    exit 1
+fi
+
+results_dir="$PROJECT_DIR/build_profiles/results"
+mkdir -p "$results_dir"
+
+for profile in $PROFILES; do
+    build_dir="$PROJECT_DIR/build_profiles/$profile"
+    mkdir -p "$build_dir"
+
+    # Fragmento do perfil - aplicado depois do sdkconfig do projeto
+    overlay="$build_dir/sdkconfig.profile"
+    : > "$overlay"
+    for other in $PROFILES CUSTOM; do
+        if [ "$other" = "$profile" ]; then
+            echo "CONFIG_TASK_PROFILE_$other=y" >> "$overlay"
+        else
+            echo "# CONFIG_TASK_PROFILE_$other is not set" >> "$overlay"
+        fi
+    done
+    if [ "$profile" != "UNPINNED" ]; then
+        printf '%s\n' "CONFIG_LWIP_TCPIP_TASK_AFFINITY_CPU0=y" \
+                      "# CONFIG_LWIP_TCPIP_TASK_AFFINITY_NO_AFFINITY is not set" \
+                      "# CONFIG_LWIP_TCPIP_TASK_AFFINITY_CPU1 is not set" >> "$overlay"
+    fi
+
+    echo "=== Perfil $profile: build e gravação" >&2
+    rm -f "$build_dir/sdkconfig"
+    idf.py -C "$PROJECT_DIR" -B "$build_dir" \
+        -D SDKCONFIG="$build_dir/sdkconfig" \
+        -D SDKCONFIG_DEFAULTS="$PROJECT_DIR/sdkconfig;$overlay" \
+        -p "$port" build flash >&2
+
+    # Espera o boot e a conexão Wi-Fi antes de medir
+    sleep "$boot_wait"
+
+    echo "=== Perfil $profile: tcp_bench" >&2
+    "$TCP_BENCH" -H "$host" -l "$profile" -o "$results_dir/$profile.json" ${bench_args[@]+"${bench_args[@]}"}
+done
+
+# Tabela final - um JSON do tcp_bench por perfil
+python3 - "$results_dir" $PROFILES <<'PY'
+import json, os, sys
+
+results_dir, profiles = sys.argv[1], sys.argv[2:]
+print(f"{'perfil':<10} {'msg/s':>10} {'p50 us':>8} {'p99 us':>8} {'p999 us':>8} {'erros':>6}")
+for profile in profiles:
+    with open(os.path.join(results_dir, profile + ".json")) as f:
+        r = json.load(f)
+    lat = r["latency_us"]
+    errors = sum(v for k, v in r["errors"].items() if k not in ("connect_attempts", "connect_ok"))
+    print(f"{profile:<10} {r['throughput']['messages_per_s']:>10.0f} {lat['p50']:>8} {lat['p99']:>8} {lat['p999']:>8} {errors:>6}")
+PY
@@ -0,0 +1,660 @@
+// Benchmark de eco para o tcp-server-02 - roda no Linux contra a placa ou contra a
+// build linux do servidor. N conexões simultâneas, mensagens de tamanho e taxa
+// configuráveis, resultado em JSON (vazão, latência p50/p99/p999, tempo de conexão, erros).
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#define BENCH_DEFAULT_PORT              3333
+#define BENCH_MAX_PIPELINE              64
+#define BENCH_MAX_EVENTS                256
+#define BENCH_RECV_CHUNK                16384
+#define BENCH_CONNECT_TIMEOUT_NS        (5 * NS_PER_SEC)
+
+#define NS_PER_SEC                      1000000000ULL
+#define NS_PER_US                       1000ULL
+
+// Histograma log-linear: exato até 127 us, depois 64 sub-faixas por potência de 2 (< 1,6% de erro)
+#define HIST_SUB_BITS                   6
+#define HIST_SUB_COUNT                  (1 << HIST_SUB_BITS)
+#define HIST_LINEAR                     (2 * HIST_SUB_COUNT)
+#define HIST_BUCKETS                    (HIST_LINEAR + 40 * HIST_SUB_COUNT)
+
+typedef struct {
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+} histogram_t;
+
+typedef struct {
+    const char *host;
+    int port;
+    int connections;
+    int threads;
+    size_t size;
+    double rate;            // mensagens/s por conexão, 0 = laço fechado
+    double duration;
+    double warmup;
+    int pipeline;
+    bool framing;
+    int frame_type;
+    const char *output;
+    const char *label;      // Identificação da execução no JSON (ex.: perfil de tasks)
+} bench_config_t;
+
+typedef enum {
+    CONN_CONNECTING,
+    CONN_ACTIVE,
+    CONN_CLOSED,
+} conn_state_t;
+
+typedef struct {
+    int fd;
+    conn_state_t state;
+    uint64_t connect_start;
+    uint64_t next_send;                         // próximo envio agendado (modo com taxa)
+    uint64_t inflight[BENCH_MAX_PIPELINE];      // instante de envio de cada mensagem sem resposta
+    unsigned inflight_head;
+    unsigned inflight_tail;
+    size_t out_queued;                          // bytes de mensagens iniciadas ainda não enviados
+    size_t out_offset;                          // posição do próximo byte dentro da mensagem
+    size_t in_offset;                           // posição do próximo byte esperado da resposta
+    bool want_write;
+} bench_conn_t;
+
+typedef struct {
+    uint64_t connect_attempts;
+    uint64_t connect_ok;
+    uint64_t connect_failed;
+    uint64_t connect_timeout;
+    uint64_t resets;
+    uint64_t send_errors;
+    uint64_t corrupt;
+    uint64_t in_flight;
+    uint64_t messages_sent;
+    uint64_t messages_received;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+} bench_counters_t;
+
+typedef struct {
+    int id;
+    pthread_t thread;
+    bench_conn_t *conns;
+    int nconns;
+    histogram_t latency;
+    histogram_t setup;
+    bench_counters_t counters;
+} bench_worker_t;
+
+static bench_config_t s_config = {
+    .host = "127.0.0.1",
+    .port = BENCH_DEFAULT_PORT,
+    .connections = 16,
+    .threads = 1,
+    .size = 64,
+    .rate = 0,
+    .duration = 10,
+    .warmup = 1,
+    .pipeline = 1,
+    .framing = false,
+    .frame_type = 1,
+    .output = NULL,
+};
+
+static struct sockaddr_storage s_addr;
+static socklen_t s_addr_len;
+static uint8_t *s_message;
+static size_t s_message_len;
+static uint64_t s_start;
+static uint64_t s_measure_start;
+static uint64_t s_end;
+static pthread_barrier_t s_barrier;
+
+static uint64_t now_ns(void) {
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+// Function - Histograma
+static unsigned hist_index(uint64_t value) {
+
+    if (value < HIST_LINEAR) {
+        return value;
+    }
+    unsigned shift = 63 - __builtin_clzll(value) - HIST_SUB_BITS;
+    unsigned index = HIST_LINEAR + (shift - 1) * HIST_SUB_COUNT + (unsigned)((value >> shift) - HIST_SUB_COUNT);
+    return index < HIST_BUCKETS ? index : HIST_BUCKETS - 1;
+}
+
+static uint64_t hist_value(unsigned index) {
+
+    if (index < HIST_LINEAR) {
+        return index;
+    }
+    unsigned shift = (index - HIST_LINEAR) / HIST_SUB_COUNT + 1;
+    uint64_t sub = (index - HIST_LINEAR) % HIST_SUB_COUNT + HIST_SUB_COUNT;
+    // Meio da faixa
+    return (sub << shift) + ((1ULL << shift) >> 1);
+}
+
+static void hist_record(histogram_t *hist, uint64_t value) {
+
+    hist->counts[hist_index(value)]++;
+    if (hist->total == 0 || value < hist->min) {
+        hist->min = value;
+    }
+    if (value > hist->max) {
+        hist->max = value;
+    }
+    hist->total++;
+    hist->sum += value;
+}
+
+static void hist_merge(histogram_t *dst, const histogram_t *src) {
+
+    if (src->total == 0) {
+        return;
+    }
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    if (dst->total == 0 || src->min < dst->min) {
+        dst->min = src->min;
+    }
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+    dst->total += src->total;
+    dst->sum += src->sum;
+}
+
+static uint64_t hist_percentile(const histogram_t *hist, double percentile) {
+
+    if (hist->total == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(percentile / 100.0 * hist->total + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            uint64_t value = hist_value(i);
+            return value > hist->max ? hist->max : value < hist->min ? hist->min : value;
+        }
+    }
+    return hist->max;
+}
+
+// Function - Conexões
+static void conn_close(bench_conn_t *conn, int epfd) {
+
+    if (conn->fd >= 0) {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+        close(conn->fd);
+        conn->fd = -1;
+    }
+    conn->state = CONN_CLOSED;
+}
+
+static void conn_update_events(bench_conn_t *conn, int epfd, bool want_write) {
+
+    if (conn->want_write == want_write) {
+        return;
+    }
+    struct epoll_event ev = {
+        .events = EPOLLIN | (want_write ? EPOLLOUT : 0),
+        .data.ptr = conn,
+    };
+    epoll_ctl(epfd, EPOLL_CTL_MOD, conn->fd, &ev);
+    conn->want_write = want_write;
+}
+
+static void conn_start(bench_worker_t *worker, bench_conn_t *conn, int epfd) {
+
+    worker->counters.connect_attempts++;
+    conn->fd = socket(s_addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (conn->fd < 0) {
+        worker->counters.connect_failed++;
+        conn->state = CONN_CLOSED;
+        return;
+    }
+
+    int one = 1;
+    setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    conn->connect_start = now_ns();
+    conn->state = CONN_CONNECTING;
+    conn->want_write = true;
+    if (connect(conn->fd, (struct sockaddr *)&s_addr, s_addr_len) < 0 && errno != EINPROGRESS) {
+        worker->counters.connect_failed++;
+        close(conn->fd);
+        conn->fd = -1;
+        conn->state = CONN_CLOSED;
+        return;
+    }
+
+    struct epoll_event ev = { .events = EPOLLIN | EPOLLOUT, .data.ptr = conn };
+    epoll_ctl(epfd, EPOLL_CTL_ADD, conn->fd, &ev);
+}
+
+// Inicia as mensagens que já podem sair (pipeline livre e, no modo com taxa, horário vencido)
+static void conn_schedule(bench_conn_t *conn, uint64_t now) {
+
+    while (conn->inflight_head - conn->inflight_tail < (unsigned)s_config.pipeline && now < s_end) {
+        uint64_t stamp = now;
+        if (s_config.rate > 0) {
+            if (conn->next_send > now) {
+                break;
+            }
+            // Latência medida a partir do horário agendado - atraso do cliente também conta
+            stamp = conn->next_send;
+            conn->next_send += (uint64_t)(NS_PER_SEC / s_config.rate);
+        }
+        conn->inflight[conn->inflight_head++ % BENCH_MAX_PIPELINE] = stamp;
+        conn->out_queued += s_message_len;
+    }
+}
+
+static void conn_flush(bench_worker_t *worker, bench_conn_t *conn, int epfd) {
+
+    // Aquecimento fora dos totais - mesma janela das mensagens recebidas
+    bool measuring = now_ns() >= s_measure_start;
+
+    while (conn->out_queued > 0) {
+        size_t chunk = s_message_len - conn->out_offset;
+        if (chunk > conn->out_queued) {
+            chunk = conn->out_queued;
+        }
+        ssize_t sent = send(conn->fd, s_message + conn->out_offset, chunk, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                conn_update_events(conn, epfd, true);
+                return;
+            }
+            worker->counters.send_errors++;
+            conn_close(conn, epfd);
+            return;
+        }
+        if (measuring) {
+            worker->counters.bytes_sent += sent;
+        }
+        conn->out_queued -= sent;
+        conn->out_offset += sent;
+        if (conn->out_offset == s_message_len) {
+            conn->out_offset = 0;
+            if (measuring) {
+                worker->counters.messages_sent++;
+            }
+        }
+    }
+    conn_update_events(conn, epfd, false);
+}
+
+static void conn_receive(bench_worker_t *worker, bench_conn_t *conn, int epfd) {
+
+    static __thread uint8_t buffer[BENCH_RECV_CHUNK];
+
+    for (;;) {
+        ssize_t len = recv(conn->fd, buffer, sizeof(buffer), 0);
+        if (len == 0 || (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            worker->counters.resets++;
+            conn_close(conn, epfd);
+            return;
+        }
+        if (len < 0) {
+            return;
+        }
+        uint64_t now = now_ns();
+        if (now >= s_measure_start) {
+            worker->counters.bytes_received += len;
+        }
+
+        for (ssize_t i = 0; i < len;) {
+            if (conn->inflight_head == conn->inflight_tail) {
+                // Bytes sem mensagem pendente - o servidor respondeu mais do que enviamos
+                worker->counters.corrupt++;
+                conn_close(conn, epfd);
+                return;
+            }
+            size_t chunk = s_message_len - conn->in_offset;
+            if (chunk > (size_t)(len - i)) {
+                chunk = len - i;
+            }
+            if (memcmp(buffer + i, s_message + conn->in_offset, chunk) != 0) {
+                worker->counters.corrupt++;
+                conn_close(conn, epfd);
+                return;
+            }
+            i += chunk;
+            conn->in_offset += chunk;
+            if (conn->in_offset == s_message_len) {
+                conn->in_offset = 0;
+                uint64_t sent_at = conn->inflight[conn->inflight_tail++ % BENCH_MAX_PIPELINE];
+                if (sent_at >= s_measure_start) {
+                    worker->counters.messages_received++;
+                    hist_record(&worker->latency, (now - sent_at) / NS_PER_US);
+                }
+            }
+        }
+    }
+}
+
+static void conn_connected(bench_worker_t *worker, bench_conn_t *conn, int epfd) {
+
+    int err = 0;
+    socklen_t len = sizeof(err);
+    getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+    if (err != 0) {
+        worker->counters.connect_failed++;
+        conn_close(conn, epfd);
+        return;
+    }
+
+    uint64_t now = now_ns();
+    worker->counters.connect_ok++;
+    hist_record(&worker->setup, (now - conn->connect_start) / NS_PER_US);
+    conn->state = CONN_ACTIVE;
+    conn->next_send = now > s_start ? now : s_start;
+}
+
+// Task - Um epoll por thread, conexões distribuídas em round-robin
+static void *bench_worker_run(void *arg) {
+
+    bench_worker_t *worker = arg;
+    struct epoll_event events[BENCH_MAX_EVENTS];
+
+    int epfd = epoll_create1(0);
+    pthread_barrier_wait(&s_barrier);
+
+    for (int i = 0; i < worker->nconns; i++) {
+        conn_start(worker, &worker->conns[i], epfd);
+    }
+
+    for (;;) {
+        uint64_t now = now_ns();
+        if (now >= s_end) {
+            break;
+        }
+
+        int active = 0;
+        for (int i = 0; i < worker->nconns; i++) {
+            bench_conn_t *conn = &worker->conns[i];
+            if (conn->state == CONN_CONNECTING && now - conn->connect_start > BENCH_CONNECT_TIMEOUT_NS) {
+                worker->counters.connect_timeout++;
+                conn_close(conn, epfd);
+            }
+            if (conn->state == CONN_ACTIVE) {
+                conn_schedule(conn, now);
+                if (conn->out_queued > 0 && !conn->want_write) {
+                    conn_flush(worker, conn, epfd);
+                }
+            }
+            active += conn->state != CONN_CLOSED;
+        }
+        if (active == 0) {
+            break;
+        }
+
+        // Modo com taxa acorda a cada 1 ms para os envios agendados
+        int timeout = s_config.rate > 0 ? 1 : 100;
+        int ready = epoll_wait(epfd, events, BENCH_MAX_EVENTS, timeout);
+
+        for (int i = 0; i < ready; i++) {
+            bench_conn_t *conn = events[i].data.ptr;
+            if (conn->state == CONN_CONNECTING) {
+                if (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) {
+                    conn_connected(worker, conn, epfd);
+                }
+                continue;
+            }
+            if (conn->state == CONN_ACTIVE && (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))) {
+                conn_receive(worker, conn, epfd);
+                if (conn->state == CONN_ACTIVE) {
+                    conn_schedule(conn, now_ns());
+                }
+            }
+            if (conn->state == CONN_ACTIVE && conn->out_queued > 0) {
+                conn_flush(worker, conn, epfd);
+            }
+        }
+    }
+
+    for (int i = 0; i < worker->nconns; i++) {
+        bench_conn_t *conn = &worker->conns[i];
+        for (unsigned j = conn->inflight_tail; j != conn->inflight_head; j++) {
+            if (conn->inflight[j % BENCH_MAX_PIPELINE] >= s_measure_start) {
+                worker->counters.in_flight++;
+            }
+        }
+        if (conn->state == CONN_CONNECTING) {
+            worker->counters.connect_timeout++;
+        }
+        conn_close(conn, epfd);
+    }
+    close(epfd);
+    return NULL;
+}
+
+// Function - Mensagem: payload com padrão conhecido, opcionalmente dentro de um frame
+static void bench_build_message(void) {
+
+    uint8_t header[5];
+    size_t header_len = 0;
+
+    if (s_config.framing) {
+        size_t len = s_config.size;
+        do {
+            header[header_len++] = (uint8_t)((len & 0x7F) | (len > 0x7F ? 0x80 : 0));
+            len >>= 7;
+        } while (len > 0);
+        header[header_len++] = (uint8_t)s_config.frame_type;
+    }
+
+    s_message_len = header_len + s_config.size;
+    s_message = malloc(s_message_len);
+    memcpy(s_message, header, header_len);
+    for (size_t i = 0; i < s_config.size; i++) {
+        s_message[header_len + i] = (uint8_t)('a' + i % 26);
+    }
+}
+
+static void json_histogram(FILE *out, const char *name, const histogram_t *hist, const char *suffix) {
+
+    fprintf(out, "  \"%s\": {\"count\": %" PRIu64 ", \"min\": %" PRIu64 ", \"mean\": %.1f, "
+                 "\"p50\": %" PRIu64 ", \"p90\": %" PRIu64 ", \"p99\": %" PRIu64 ", \"p999\": %" PRIu64 ", \"max\": %" PRIu64 "}%s\n",
+            name, hist->total, hist->min, hist->total ? (double)hist->sum / hist->total : 0.0,
+            hist_percentile(hist, 50), hist_percentile(hist, 90), hist_percentile(hist, 99),
+            hist_percentile(hist, 99.9), hist->max, suffix);
+}
+
+static void bench_report(FILE *out, const histogram_t *latency, const histogram_t *setup, const bench_counters_t *c) {
+
+    // Todas as taxas e totais na mesma janela: depois do aquecimento até o fim
+    double seconds = s_config.duration - s_config.warmup;
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"config\": {\"host\": \"%s\", \"port\": %d, \"connections\": %d, \"threads\": %d, "
+                 "\"size\": %zu, \"wire_size\": %zu, \"rate_per_connection\": %.1f, \"pipeline\": %d, "
+                 "\"framing\": %s, \"duration_s\": %.1f, \"warmup_s\": %.1f, \"label\": \"%s\"},\n",
+            s_config.host, s_config.port, s_config.connections, s_config.threads, s_config.size, s_message_len,
+            s_config.rate, s_config.pipeline, s_config.framing ? "true" : "false", s_config.duration, s_config.warmup,
+            s_config.label ? s_config.label : "");
+    fprintf(out, "  \"throughput\": {\"messages_per_s\": %.1f, \"rx_bytes_per_s\": %.1f, \"tx_bytes_per_s\": %.1f, \"mbit_per_s\": %.3f},\n",
+            c->messages_received / seconds, c->bytes_received / seconds, c->bytes_sent / seconds,
+            c->messages_received * s_message_len * 8 / seconds / 1e6);
+    fprintf(out, "  \"totals\": {\"messages_sent\": %" PRIu64 ", \"messages_received\": %" PRIu64 ", "
+                 "\"bytes_sent\": %" PRIu64 ", \"bytes_received\": %" PRIu64 ", \"in_flight_at_end\": %" PRIu64 "},\n",
+            c->messages_sent, c->messages_received, c->bytes_sent, c->bytes_received, c->in_flight);
+    json_histogram(out, "latency_us", latency, ",");
+    json_histogram(out, "connect_us", setup, ",");
+    fprintf(out, "  \"errors\": {\"connect_attempts\": %" PRIu64 ", \"connect_ok\": %" PRIu64 ", \"connect_failed\": %" PRIu64 ", "
+                 "\"connect_timeout\": %" PRIu64 ", \"reset\": %" PRIu64 ", \"send\": %" PRIu64 ", \"corrupt\": %" PRIu64 "}\n",
+            c->connect_attempts, c->connect_ok, c->connect_failed, c->connect_timeout, c->resets, c->send_errors,
+            c->corrupt);
+    fprintf(out, "}\n");
+}
+
+static void usage(const char *prog) {
+
+    fprintf(stderr,
+            "uso: %s [opções]\n"
+            "  -H, --host HOST         endereço do servidor (padrão 127.0.0.1)\n"
+            "  -p, --port PORTA        porta (padrão %d, CONFIG_ESP_SOCKET_PORT)\n"
+            "  -c, --connections N     conexões simultâneas (padrão 16)\n"
+            "  -t, --threads N         threads do cliente (padrão 1)\n"
+            "  -s, --size BYTES        tamanho da mensagem (padrão 64)\n"
+            "  -r, --rate MSG/S        mensagens por segundo por conexão, 0 = laço fechado (padrão 0)\n"
+            "  -P, --pipeline N        mensagens sem resposta por conexão (padrão 1, máx %d)\n"
+            "  -d, --duration S        duração total em segundos (padrão 10)\n"
+            "  -w, --warmup S          segundos iniciais fora das estatísticas (padrão 1)\n"
+            "  -f, --framing           envia frames (CONFIG_SOCKET_FRAMING_LENGTH_PREFIX)\n"
+            "  -T, --frame-type N      tipo do frame (padrão 1)\n"
+            "  -o, --output ARQUIVO    grava o JSON em um arquivo em vez do stdout\n"
+            "  -l, --label TEXTO       identificação da execução, repetida no JSON\n",
+            prog, BENCH_DEFAULT_PORT, BENCH_MAX_PIPELINE);
+}
+
+static void parse_args(int argc, char **argv) {
+
+    static const struct option options[] = {
+        { "host", required_argument, NULL, 'H' },
+        { "port", required_argument, NULL, 'p' },
+        { "connections", required_argument, NULL, 'c' },
+        { "threads", required_argument, NULL, 't' },
+        { "size", required_argument, NULL, 's' },
+        { "rate", required_argument, NULL, 'r' },
+        { "pipeline", required_argument, NULL, 'P' },
+        { "duration", required_argument, NULL, 'd' },
+        { "warmup", required_argument, NULL, 'w' },
+        { "framing", no_argument, NULL, 'f' },
+        { "frame-type", required_argument, NULL, 'T' },
+        { "output", required_argument, NULL, 'o' },
+        { "label", required_argument, NULL, 'l' },
+        { "help", no_argument, NULL, 'h' },
+        { 0 },
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "H:p:c:t:s:r:P:d:w:fT:o:l:h", options, NULL)) != -1) {
+        switch (opt) {
+            case 'H': s_config.host = optarg; break;
+            case 'p': s_config.port = atoi(optarg); break;
+            case 'c': s_config.connections = atoi(optarg); break;
+            case 't': s_config.threads = atoi(optarg); break;
+            case 's': s_config.size = strtoul(optarg, NULL, 0); break;
+            case 'r': s_config.rate = atof(optarg); break;
+            case 'P': s_config.pipeline = atoi(optarg); break;
+            case 'd': s_config.duration = atof(optarg); break;
+            case 'w': s_config.warmup = atof(optarg); break;
+            case 'f': s_config.framing = true; break;
+            case 'T': s_config.frame_type = atoi(optarg); break;
+            case 'o': s_config.output = optarg; break;
+            case 'l': s_config.label = optarg; break;
+            default: usage(argv[0]); exit(opt == 'h' ? 0 : 2);
+        }
+    }
+
+    if (s_config.connections < 1 || s_config.threads < 1 || s_config.size < 1 ||
+        s_config.pipeline < 1 || s_config.pipeline > BENCH_MAX_PIPELINE ||
+        s_config.duration <= s_config.warmup || s_config.warmup < 0 || s_config.rate < 0 ||
+        (s_config.framing && s_config.size > 0x0FFFFFFF)) {
+        usage(argv[0]);
+        exit(2);
+    }
+    if (s_config.threads > s_config.connections) {
+        s_config.threads = s_config.connections;
+    }
+}
+
+int main(int argc, char **argv) {
+
+    parse_args(argc, argv);
+
+    char port[8];
+    snprintf(port, sizeof(port), "%d", s_config.port);
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res;
+    int err = getaddrinfo(s_config.host, port, &hints, &res);
+    if (err != 0) {
+        fprintf(stderr, "%s: %s\n", s_config.host, gai_strerror(err));
+        return 1;
+    }
+    memcpy(&s_addr, res->ai_addr, res->ai_addrlen);
+    s_addr_len = res->ai_addrlen;
+    freeaddrinfo(res);
+
+    bench_build_message();
+
+    bench_worker_t *workers = calloc(s_config.threads, sizeof(bench_worker_t));
+    bench_conn_t *conns = calloc(s_config.connections, sizeof(bench_conn_t));
+    pthread_barrier_init(&s_barrier, NULL, s_config.threads + 1);
+
+    for (int i = 0, first = 0; i < s_config.threads; i++) {
+        int count = s_config.connections / s_config.threads + (i < s_config.connections % s_config.threads);
+        workers[i].id = i;
+        workers[i].conns = &conns[first];
+        workers[i].nconns = count;
+        for (int j = 0; j < count; j++) {
+            conns[first + j].fd = -1;
+        }
+        first += count;
+        pthread_create(&workers[i].thread, NULL, bench_worker_run, &workers[i]);
+    }
+
+    s_start = now_ns();
+    s_measure_start = s_start + (uint64_t)(s_config.warmup * NS_PER_SEC);
+    s_end = s_start + (uint64_t)(s_config.duration * NS_PER_SEC);
+    pthread_barrier_wait(&s_barrier);
+
+    histogram_t *latency = calloc(1, sizeof(histogram_t));
+    histogram_t *setup = calloc(1, sizeof(histogram_t));
+    bench_counters_t totals = { 0 };
+
+    for (int i = 0; i < s_config.threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        hist_merge(latency, &workers[i].latency);
+        hist_merge(setup, &workers[i].setup);
+
+        const uint64_t *src = (const uint64_t *)&workers[i].counters;
+        uint64_t *dst = (uint64_t *)&totals;
+        for (size_t j = 0; j < sizeof(totals) / sizeof(uint64_t); j++) {
+            dst[j] += src[j];
+        }
+    }
+
+    FILE *out = stdout;
+    if (s_config.output != NULL && (out = fopen(s_config.output, "w")) == NULL) {
+        perror(s_config.output);
+        return 1;
+    }
+    bench_report(out, latency, setup, &totals);
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    return totals.connect_ok == 0 ? 1 : 0;
+}
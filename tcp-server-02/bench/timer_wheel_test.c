@@ -0,0 +1,150 @@
+// Teste do timer wheel no host: prazos agendados antes e depois da volta do relógio em ms (2^32)
+// precisam vencer no tick certo - nunca antes do prazo, no máximo um tick depois.
+//   ./timer_wheel_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "timer_wheel.h"
+
+#define TEST_TICK_MS        100
+#define TEST_NODES          256
+#define TEST_OPERATIONS     200000
+
+static timer_wheel_node_t s_nodes[TEST_NODES];
+static int64_t s_deadline[TEST_NODES];     // Prazo no relógio de 64 bits do teste, -1 = desarmado
+static int64_t s_now;                       // O wheel só vê os 32 bits de baixo
+static int64_t s_previous;                  // Instante do advance anterior - um salto atrasa o disparo legitimamente
+static int s_failures;
+
+static uint32_t now_ms(void) {
+
+    return (uint32_t)s_now;
+}
+
+static void fail(const char *what, int index) {
+
+    printf("FALHA: %s (nó %d, agora %lld, prazo %lld)\n", what, index, (long long)s_now, (long long)s_deadline[index]);
+    s_failures++;
+}
+
+static void schedule(timer_wheel_t *wheel, int index, uint32_t timeout_ms) {
+
+    timer_wheel_schedule(wheel, &s_nodes[index], now_ms(), timeout_ms);
+    s_deadline[index] = s_now + timeout_ms;
+}
+
+// Confere o instante do disparo e, às vezes, reagenda o nó dentro do callback
+static void expired(timer_wheel_node_t *node, void *ctx) {
+
+    int index = node - s_nodes;
+
+    if (s_deadline[index] < 0) {
+        fail("disparo de nó desarmado", index);
+    } else if (s_now < s_deadline[index]) {
+        fail("disparo antes do prazo", index);
+    } else if (s_previous >= s_deadline[index] + 2 * TEST_TICK_MS) {
+        fail("disparo atrasado", index);
+    }
+    s_deadline[index] = -1;
+
+    if (rand() % 3 == 0) {
+        schedule(ctx, index, rand() % 5000);
+    }
+}
+
+static void advance(timer_wheel_t *wheel, int64_t step_ms) {
+
+    s_previous = s_now;
+    s_now += step_ms;
+    timer_wheel_advance(wheel, now_ms(), expired, wheel);
+    for (int i = 0; i < TEST_NODES; i++) {
+        if (s_deadline[i] >= 0 && s_now >= s_deadline[i] + 2 * TEST_TICK_MS) {
+            fail("prazo perdido", i);
+            s_deadline[i] = -1;
+        }
+    }
+}
+
+static void reset(timer_wheel_t *wheel, int64_t start_ms) {
+
+    s_now = start_ms;
+    s_previous = start_ms;
+    timer_wheel_init(wheel, TEST_TICK_MS, now_ms());
+    for (int i = 0; i < TEST_NODES; i++) {
+        timer_wheel_node_init(&s_nodes[i], NULL, 0);
+        s_deadline[i] = -1;
+    }
+}
+
+// Timeout de inatividade de 30 s agendado 5 s antes da volta e outro logo depois dela
+static void test_idle_across_wrap(void) {
+
+    timer_wheel_t wheel;
+
+    reset(&wheel, (int64_t)UINT32_MAX + 1 - 5000);
+    schedule(&wheel, 0, 30000);
+    while (s_now < (int64_t)UINT32_MAX + 1 + 1000) {
+        advance(&wheel, 10);
+    }
+    schedule(&wheel, 1, 30000);
+    while (s_deadline[0] >= 0 || s_deadline[1] >= 0) {
+        if (s_now > (int64_t)UINT32_MAX + 60000) {
+            fail("timeout não disparou", s_deadline[0] >= 0 ? 0 : 1);
+            return;
+        }
+        advance(&wheel, 10);
+    }
+}
+
+// Agendar, cancelar e avançar ao acaso atravessando a volta, com saltos maiores que uma volta do wheel
+static void test_random_across_wrap(void) {
+
+    timer_wheel_t wheel;
+
+    reset(&wheel, (int64_t)UINT32_MAX + 1 - 600000);
+    for (int op = 0; op < TEST_OPERATIONS && s_failures == 0; op++) {
+        int index = rand() % TEST_NODES;
+        int action = rand() % 10;
+
+        if (action < 4) {
+            schedule(&wheel, index, rand() % (rand() % 5 == 0 ? 30000 : 500));
+        } else if (action < 5) {
+            timer_wheel_cancel(&wheel, &s_nodes[index]);
+            s_deadline[index] = -1;
+        } else {
+            advance(&wheel, rand() % 50 == 0 ? rand() % 10000 : rand() % 30);
+        }
+
+        uint32_t armed = 0;
+        for (int i = 0; i < TEST_NODES; i++) {
+            armed += timer_wheel_node_armed(&s_nodes[i]);
+            if ((s_deadline[i] >= 0) != timer_wheel_node_armed(&s_nodes[i])) {
+                fail("estado do nó diverge", i);
+            }
+        }
+        if (armed != wheel.armed) {
+            printf("FALHA: %u nós armados, wheel conta %u\n", (unsigned)armed, (unsigned)wheel.armed);
+            s_failures++;
+        }
+    }
+    if (s_now <= (int64_t)UINT32_MAX) {
+        printf("FALHA: o teste não atravessou a volta do relógio\n");
+        s_failures++;
+    }
+}
+
+int main(void) {
+
+    srand(1);
+    test_idle_across_wrap();
+    test_random_across_wrap();
+
+    if (s_failures != 0) {
+        printf("%d falha(s)\n", s_failures);
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,299 @@
+// Cliente UDP do tcp-server-02: mensagens pequenas em ping-pong (uma por vez) contra o
+// listener UDP, com perda emulada no cliente nos dois sentidos. Sem -u fala a camada de
+// confiabilidade (main/udp_arq.c, a mesma fonte do servidor); com -u manda datagramas
+// crus e conta as mensagens perdidas. Resultado em JSON, como o tcp_bench.
+#define _GNU_SOURCE
+#include <errno.h>
+#include <getopt.h>
+#include <netdb.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#include "udp_arq.h"
+
+#define RING_SIZE           8192
+#define MAX_MESSAGE         1024
+
+typedef struct {
+    const char *host;
+    int port;
+    uint32_t size;
+    uint32_t count;
+    double loss;            // Probabilidade de descarte em cada sentido
+    bool raw;
+    uint32_t timeout_ms;    // Modo cru - espera pelo eco antes de dar a mensagem como perdida
+    const char *output;
+    const char *label;
+} bench_config_t;
+
+typedef struct {
+    int sock;
+    double loss;
+    uint64_t dropped;       // Datagramas descartados pela perda emulada (os dois sentidos)
+    uint64_t sent;
+    uint64_t received;
+} bench_link_t;
+
+static uint64_t now_us(void) {
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t now_ms(void) {
+
+    return (uint32_t)(now_us() / 1000);
+}
+
+static bool link_drop(bench_link_t *link) {
+
+    if (link->loss > 0 && drand48() < link->loss) {
+        link->dropped++;
+        return true;
+    }
+    return false;
+}
+
+static void link_send(bench_link_t *link, const uint8_t *data, uint32_t len) {
+
+    if (link_drop(link)) {
+        return;
+    }
+    if (send(link->sock, data, len, 0) == (ssize_t)len) {
+        link->sent++;
+    }
+}
+
+// Output da camada de confiabilidade
+static void link_output(const uint8_t *data, uint32_t len, void *ctx) {
+
+    link_send(ctx, data, len);
+}
+
+// Espera um datagrama por até timeout_ms. Retorna o tamanho, 0 no timeout ou se a perda
+// emulada o descartou, -1 em erro
+static int link_recv(bench_link_t *link, uint8_t *buf, uint32_t size, uint32_t timeout_ms) {
+
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET(link->sock, &read_fds);
+    struct timeval timeout = { .tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000 };
+
+    int ready = select(link->sock + 1, &read_fds, NULL, NULL, &timeout);
+    if (ready <= 0) {
+        return ready < 0 && errno != EINTR ? -1 : 0;
+    }
+    int len = recv(link->sock, buf, size, 0);
+    if (len < 0) {
+        return errno == ECONNREFUSED ? -1 : 0;
+    }
+    link->received++;
+    return link_drop(link) ? 0 : len;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(const uint64_t *sorted, uint32_t n, double p) {
+
+    return n == 0 ? 0 : sorted[(uint32_t)(p * (n - 1))];
+}
+
+// Mensagem i: número de sequência nos 4 primeiros bytes, o resto deriva dele
+static void fill_message(uint8_t *msg, uint32_t size, uint32_t seq) {
+
+    for (uint32_t i = 0; i < size; i++) {
+        msg[i] = i < 4 ? (uint8_t)(seq >> (8 * i)) : (uint8_t)('a' + (seq + i) % 26);
+    }
+}
+
+// Modo cru - um datagrama por mensagem, eco atrasado ou perdido conta como perda
+static uint32_t run_raw(const bench_config_t *config, bench_link_t *link, uint64_t *rtt, uint32_t *errors) {
+
+    uint8_t msg[MAX_MESSAGE];
+    uint8_t reply[UDP_ARQ_MTU];
+    uint32_t done = 0;
+
+    for (uint32_t seq = 0; seq < config->count; seq++) {
+        fill_message(msg, config->size, seq);
+        uint64_t start = now_us();
+        link_send(link, msg, config->size);
+        for (;;) {
+            uint64_t elapsed_ms = (now_us() - start) / 1000;
+            if (elapsed_ms >= config->timeout_ms) {
+                break;
+            }
+            int len = link_recv(link, reply, sizeof(reply), config->timeout_ms - elapsed_ms);
+            if (len < 0) {
+                return done;
+            }
+            // Eco atrasado de uma mensagem anterior - ignorado
+            if ((uint32_t)len != config->size || memcmp(reply, msg, 4) != 0) {
+                continue;
+            }
+            if (memcmp(reply, msg, config->size) != 0) {
+                (*errors)++;
+            }
+            rtt[done++] = now_us() - start;
+            break;
+        }
+    }
+    return done;
+}
+
+// Modo confiável - a mensagem vai para o TX ring e o RTT só fecha com o eco inteiro no RX ring
+static uint32_t run_arq(const bench_config_t *config, bench_link_t *link, uint64_t *rtt, uint32_t *errors) {
+
+    static uint8_t rx_storage[RING_SIZE];
+    static uint8_t tx_storage[RING_SIZE];
+    static udp_arq_t arq;
+    ring_buffer_t rx;
+    ring_buffer_t tx;
+    uint8_t msg[MAX_MESSAGE];
+    uint8_t reply[MAX_MESSAGE];
+    uint8_t datagram[UDP_ARQ_MTU];
+    uint8_t scratch[UDP_ARQ_MTU];
+    uint32_t done = 0;
+
+    ring_buffer_init(&rx, rx_storage, sizeof(rx_storage));
+    ring_buffer_init(&tx, tx_storage, sizeof(tx_storage));
+    udp_arq_init(&arq, (uint32_t)getpid() ^ now_ms());
+
+    for (uint32_t seq = 0; seq < config->count; seq++) {
+        fill_message(msg, config->size, seq);
+        uint64_t start = now_us();
+        ring_buffer_write(&tx, msg, config->size);
+        udp_arq_flush(&arq, &rx, &tx, now_ms(), scratch, link_output, link);
+
+        while (ring_buffer_used(&rx) < config->size) {
+            int len = link_recv(link, datagram, sizeof(datagram), UDP_ARQ_INTERVAL_MS);
+            if (len < 0) {
+                return done;
+            }
+            if (len > 0 && !udp_arq_input(&arq, &rx, &tx, datagram, len, now_ms())) {
+                (*errors)++;
+            }
+            udp_arq_flush(&arq, &rx, &tx, now_ms(), scratch, link_output, link);
+            if (udp_arq_is_dead(&arq)) {
+                fprintf(stderr, "servidor sem resposta\n");
+                return done;
+            }
+        }
+
+        rtt[done++] = now_us() - start;
+        ring_buffer_peek(&rx, 0, reply, config->size);
+        ring_buffer_consume(&rx, config->size);
+        if (memcmp(reply, msg, config->size) != 0) {
+            (*errors)++;
+        }
+    }
+    return done;
+}
+
+static void usage(const char *prog) {
+
+    fprintf(stderr,
+            "uso: %s [-H host] [-p porta] [-s bytes] [-n mensagens] [-L perda%%] [-u] [-T ms] [-o arquivo] [-l texto]\n"
+            "  -u  datagramas crus, sem a camada de confiabilidade (servidor sem CONFIG_SOCKET_UDP_RELIABLE)\n"
+            "  -T  modo cru: espera pelo eco antes de contar a mensagem como perdida (padrão 200)\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+
+    bench_config_t config = {
+        .host = "127.0.0.1",
+        .port = 3333,
+        .size = 32,
+        .count = 1000,
+        .timeout_ms = 200,
+        .label = "",
+    };
+    int opt;
+
+    while ((opt = getopt(argc, argv, "H:p:s:n:L:uT:o:l:h")) != -1) {
+        switch (opt) {
+        case 'H': config.host = optarg; break;
+        case 'p': config.port = atoi(optarg); break;
+        case 's': config.size = atoi(optarg); break;
+        case 'n': config.count = atoi(optarg); break;
+        case 'L': config.loss = atof(optarg) / 100.0; break;
+        case 'u': config.raw = true; break;
+        case 'T': config.timeout_ms = atoi(optarg); break;
+        case 'o': config.output = optarg; break;
+        case 'l': config.label = optarg; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (config.size < 4 || config.size > MAX_MESSAGE || config.count == 0) {
+        fprintf(stderr, "tamanho entre 4 e %d bytes, ao menos uma mensagem\n", MAX_MESSAGE);
+        return 1;
+    }
+
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_DGRAM };
+    struct addrinfo *addr;
+    char port[8];
+    snprintf(port, sizeof(port), "%d", config.port);
+    if (getaddrinfo(config.host, port, &hints, &addr) != 0) {
+        fprintf(stderr, "host inválido: %s\n", config.host);
+        return 1;
+    }
+    bench_link_t link = { .sock = socket(AF_INET, SOCK_DGRAM, 0), .loss = config.loss };
+    if (link.sock < 0 || connect(link.sock, addr->ai_addr, addr->ai_addrlen) != 0) {
+        perror("socket");
+        return 1;
+    }
+    freeaddrinfo(addr);
+    srand48(now_us());
+
+    uint64_t *rtt = calloc(config.count, sizeof(*rtt));
+    uint32_t errors = 0;
+    uint64_t start = now_us();
+    uint32_t done = config.raw ? run_raw(&config, &link, rtt, &errors) : run_arq(&config, &link, rtt, &errors);
+    double elapsed = (now_us() - start) / 1e6;
+    qsort(rtt, done, sizeof(*rtt), cmp_u64);
+
+    FILE *out = config.output != NULL ? fopen(config.output, "w") : stdout;
+    if (out == NULL) {
+        perror(config.output);
+        return 1;
+    }
+    fprintf(out,
+            "{\n"
+            "  \"config\": {\"label\": \"%s\", \"host\": \"%s\", \"port\": %d, \"mode\": \"%s\", \"size\": %u, "
+            "\"messages\": %u, \"loss_percent\": %.2f},\n"
+            "  \"completed\": %u,\n"
+            "  \"lost\": %u,\n"
+            "  \"errors\": %u,\n"
+            "  \"elapsed_s\": %.3f,\n"
+            "  \"datagrams\": {\"sent\": %llu, \"received\": %llu, \"dropped\": %llu},\n"
+            "  \"rtt_us\": {\"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu}\n"
+            "}\n",
+            config.label, config.host, config.port, config.raw ? "raw" : "arq", config.size,
+            config.count, config.loss * 100, done, config.count - done, errors, elapsed,
+            (unsigned long long)link.sent, (unsigned long long)link.received, (unsigned long long)link.dropped,
+            (unsigned long long)percentile(rtt, done, 0.50), (unsigned long long)percentile(rtt, done, 0.90),
+            (unsigned long long)percentile(rtt, done, 0.99), (unsigned long long)percentile(rtt, done, 0.999),
+            (unsigned long long)(done > 0 ? rtt[done - 1] : 0));
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(rtt);
+    close(link.sock);
+    // Modo cru perde mensagens por definição; no confiável toda mensagem deve completar
+    return errors > 0 || (!config.raw && done < config.count) ? 2 : 0;
+}
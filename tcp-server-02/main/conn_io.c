@@ -0,0 +1,358 @@
+#include <string.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "async_log.h"
+
+#include "net_sockets.h"
+
+#include "conn_io.h"
+
+// Menuconfig - Backpressure
+#define TX_HIGH_WATERMARK               (CONN_TX_RING_SIZE * CONFIG_SOCKET_TX_HIGH_WATERMARK / 100)
+#define TX_LOW_WATERMARK                (CONN_TX_RING_SIZE * CONFIG_SOCKET_TX_LOW_WATERMARK / 100)
+
+// Menuconfig - Escrita agrupada (política throughput). O alvo fica abaixo do high watermark,
+// senão a leitura pararia antes de o TX ring juntar o suficiente
+#define WRITE_COALESCE_BYTES            MIN(CONFIG_SOCKET_WRITE_COALESCE_BYTES, TX_HIGH_WATERMARK)
+#define WRITE_FLUSH_DEADLINE_MS         CONFIG_SOCKET_WRITE_FLUSH_DEADLINE_MS
+
+// Segmentos por sendmsg: a mensagem do outbox pela metade, os dois do TX ring e as seguintes
+#define CONN_IO_MAX_IOV                 8
+
+// Menuconfig - Socket
+#define EXAMPLE_KEEPALIVE_IDLE          CONFIG_KEEPALIVE_IDLE
+#define EXAMPLE_KEEPALIVE_INTERVAL      CONFIG_KEEPALIVE_INTERVAL
+#define EXAMPLE_KEEPALIVE_COUNT         CONFIG_KEEPALIVE_COUNT
+
+// Tags de depuração:
+static const char *TAG_SOCKET = "DEBUG - TCP-SOCKET";
+
+#if !CONFIG_SOCKET_SERVER_MODE_EVENT_LOOP
+// Function - Set a socket timeout option (0 ms mantém o socket sem timeout)
+static void conn_io_set_timeout(int sock, int option, uint32_t timeout_ms) {
+
+    if (timeout_ms == 0) {
+        return;
+    }
+    struct timeval timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+    setsockopt(sock, SOL_SOCKET, option, &timeout, sizeof(timeout));
+}
+#endif
+
+void conn_io_configure_socket(int sock) {
+
+    // Set tcp keepalive option
+    int keepAlive = 1;
+    int keepIdle = EXAMPLE_KEEPALIVE_IDLE;
+    int keepInterval = EXAMPLE_KEEPALIVE_INTERVAL;
+    int keepCount = EXAMPLE_KEEPALIVE_COUNT;
+    setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(int));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &keepIdle, sizeof(int));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &keepInterval, sizeof(int));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &keepCount, sizeof(int));
+
+    // Sem Nagle nas duas políticas: quem agrupa os frames é o flush, com prazo conhecido.
+    // Com Nagle, a resposta curta após um envio esperaria o ACK atrasado do cliente
+    int noDelay = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(int));
+
+#if !CONFIG_SOCKET_SERVER_MODE_EVENT_LOOP
+    // Socket bloqueante, uma task por conexão - o próprio lwIP faz o papel do timer
+    conn_io_set_timeout(sock, SO_RCVTIMEO, CONFIG_SOCKET_IDLE_TIMEOUT_MS);
+    conn_io_set_timeout(sock, SO_SNDTIMEO, CONFIG_SOCKET_WRITE_TIMEOUT_MS);
+#endif
+}
+
+conn_io_status_t conn_io_recv(Struct_Socket_clients *client) {
+
+    uint8_t *window;
+    uint32_t window_len = ring_buffer_write_window(&client->rx, &window);
+
+    if (window_len == 0) {
+        return CONN_IO_WOULD_BLOCK;
+    }
+
+    // receive data on the connected socket - as duas janelas livres do ring em um único recvmsg,
+    // para uma rajada de comandos que cruza o fim do buffer chegar inteira na mesma passada
+    struct iovec iov[2] = {
+        { .iov_base = window, .iov_len = window_len },
+        { .iov_base = client->rx.buffer, .iov_len = ring_buffer_free(&client->rx) - window_len },
+    };
+    struct msghdr msg = { .msg_iov = iov, .msg_iovlen = iov[1].iov_len > 0 ? 2 : 1 };
+    int len = recvmsg(client->sock_client, &msg, 0);
+
+    if (len < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return CONN_IO_WOULD_BLOCK;
+        }
+        ASYNC_LOGE(TAG_SOCKET, "[CLIENT-%d] Recv falhou: errno %d", client->sock_client, errno);
+        return CONN_IO_ERROR;
+    }
+
+    if (len == 0) {
+        ASYNC_LOGI(TAG_SOCKET, "[CLIENT-%d] Conexão fechada", client->sock_client);
+        return CONN_IO_CLOSED;
+    }
+
+    ASYNC_LOGI(TAG_SOCKET, "[CLIENT-%d] Recebidos [%d bytes]", client->sock_client, len);
+    ring_buffer_produce(&client->rx, len);
+    return CONN_IO_OK;
+}
+
+// Echo - o que não couber fica no RX ring até o TX esvaziar
+static int32_t conn_io_echo_data(Struct_Socket_clients *client, const ring_buffer_view_t *data, void *ctx) {
+
+    ring_buffer_view_t part;
+    uint32_t len = MIN(ring_buffer_view_len(data), conn_io_write_space(client));
+
+    ring_buffer_view_slice(data, 0, len, &part);
+    conn_io_write_view(client, &part);
+    return len;
+}
+
+const conn_handler_t conn_io_echo_handler = {
+    .on_data = conn_io_echo_data,
+};
+
+static inline uint32_t conn_io_now_ms(void) {
+    return pdTICKS_TO_MS(xTaskGetTickCount());
+}
+
+bool conn_io_open(Struct_Socket_clients *client, const conn_listener_t *listener) {
+
+    client->listener = listener;
+    conn_io_set_write_policy(client, listener->write_policy);
+    if (listener->handler->on_accept != NULL && !listener->handler->on_accept(client, listener->ctx)) {
+        // Recusada - sem on_close para uma conexão que o handler não aceitou
+        ASYNC_LOGW(TAG_SOCKET, "[CLIENT-%d] Conexão recusada pelo handler", client->sock_client);
+        client->listener = NULL;
+        return false;
+    }
+    return true;
+}
+
+void conn_io_set_write_policy(Struct_Socket_clients *client, conn_write_policy_t policy) {
+
+    client->write_policy = policy;
+    // Dados retidos passam a sair no próximo flush
+    if (policy == CONN_WRITE_LATENCY) {
+        client->tx_state = CONN_TX_IDLE;
+    }
+}
+
+void conn_io_close(Struct_Socket_clients *client) {
+
+    const conn_listener_t *listener = client->listener;
+
+    if (listener != NULL && listener->handler->on_close != NULL) {
+        listener->handler->on_close(client, listener->ctx);
+    }
+    client->listener = NULL;
+}
+
+conn_io_status_t conn_io_process(Struct_Socket_clients *client) {
+
+    const conn_listener_t *listener = client->listener;
+    uint32_t used = ring_buffer_used(&client->rx);
+
+    if (used == 0) {
+        return CONN_IO_OK;
+    }
+
+    // Visão zero-copy do RX ring - 2 segmentos se os dados cruzarem o fim do buffer
+    ring_buffer_view_t data;
+    ring_buffer_view(&client->rx, 0, used, &data);
+
+    int32_t consumed = listener->handler->on_data(client, &data, listener->ctx);
+    if (consumed < 0) {
+        return CONN_IO_ERROR;
+    }
+    ring_buffer_consume(&client->rx, consumed);
+    return CONN_IO_OK;
+}
+
+bool conn_io_write(Struct_Socket_clients *client, const void *data, uint32_t len) {
+
+    if (ring_buffer_free(&client->tx) < len) {
+        return false;
+    }
+    ring_buffer_write(&client->tx, data, len);
+    return true;
+}
+
+bool conn_io_write_view(Struct_Socket_clients *client, const ring_buffer_view_t *view) {
+
+    if (ring_buffer_free(&client->tx) < ring_buffer_view_len(view)) {
+        return false;
+    }
+    ring_buffer_write(&client->tx, view->ptr[0], view->len[0]);
+    ring_buffer_write(&client->tx, view->ptr[1], view->len[1]);
+    return true;
+}
+
+// Function - Bytes waiting to be sent: TX ring e, no pub/sub, o que falta das mensagens do outbox
+static uint32_t conn_io_tx_pending(const Struct_Socket_clients *client) {
+
+    uint32_t pending = ring_buffer_used(&client->tx);
+
+#if CONFIG_SOCKET_PUBSUB
+    const msg_outbox_t *outbox = &client->outbox;
+    for (uint32_t i = outbox->tail; i != outbox->head; i++) {
+        pending += outbox->slots[i % MSG_OUTBOX_LEN]->len;
+    }
+    pending -= outbox->offset;
+#endif
+    return pending;
+}
+
+uint32_t conn_io_flush_delay_ms(const Struct_Socket_clients *client) {
+
+    uint32_t waited = conn_io_now_ms() - client->tx_held_since;
+    return waited < WRITE_FLUSH_DEADLINE_MS ? WRITE_FLUSH_DEADLINE_MS - waited : 0;
+}
+
+// Function - Throughput policy: decide whether the pending bytes wait for more frames
+// Retém até juntar o alvo, encher a fila ou vencer o prazo; um envio iniciado vai até o fim
+static bool conn_io_hold(Struct_Socket_clients *client) {
+
+    uint32_t pending = conn_io_tx_pending(client);
+
+    if (client->write_policy != CONN_WRITE_THROUGHPUT || pending == 0) {
+        client->tx_state = CONN_TX_IDLE;
+        return false;
+    }
+    if (client->tx_state == CONN_TX_DRAINING) {
+        return false;
+    }
+    if (client->tx_state == CONN_TX_IDLE) {
+        client->tx_state = CONN_TX_HELD;
+        client->tx_held_since = conn_io_now_ms();
+    }
+    bool full = pending >= WRITE_COALESCE_BYTES;
+#if CONFIG_SOCKET_PUBSUB
+    // Outbox cheio - reter faria o próximo publish descartar a mensagem como se o assinante fosse lento
+    full = full || msg_outbox_is_full(&client->outbox);
+#endif
+    if (full || conn_io_flush_delay_ms(client) == 0) {
+        client->tx_state = CONN_TX_DRAINING;
+        return false;
+    }
+    return true;
+}
+
+static inline void conn_io_iov_add(struct iovec *iov, int *count, const void *data, uint32_t len) {
+
+    if (len > 0 && *count < CONN_IO_MAX_IOV) {
+        iov[*count].iov_base = (void *)data;
+        iov[*count].iov_len = len;
+        (*count)++;
+    }
+}
+
+// Function - Gather everything queued into one iovec list, na ordem de envio
+// Uma mensagem do outbox pela metade termina antes do TX ring; o TX ring vai antes das
+// mensagens ainda não iniciadas - bytes de frames diferentes nunca se intercalam
+static int conn_io_gather(Struct_Socket_clients *client, struct iovec *iov) {
+
+    int count = 0;
+    ring_buffer_view_t view;
+
+#if CONFIG_SOCKET_PUBSUB
+    const msg_outbox_t *outbox = &client->outbox;
+    uint32_t next = outbox->tail;
+    if (!msg_outbox_is_empty(outbox) && outbox->offset > 0) {
+        const msg_buf_t *msg = msg_outbox_peek(outbox);
+        conn_io_iov_add(iov, &count, msg->data + outbox->offset, msg->len - outbox->offset);
+        next++;
+    }
+#endif
+
+    ring_buffer_view(&client->tx, 0, ring_buffer_used(&client->tx), &view);
+    conn_io_iov_add(iov, &count, view.ptr[0], view.len[0]);
+    conn_io_iov_add(iov, &count, view.ptr[1], view.len[1]);
+
+#if CONFIG_SOCKET_PUBSUB
+    for (; next != outbox->head && count < CONN_IO_MAX_IOV; next++) {
+        const msg_buf_t *msg = outbox->slots[next % MSG_OUTBOX_LEN];
+        conn_io_iov_add(iov, &count, msg->data, msg->len);
+    }
+#endif
+    return count;
+}
+
+// Function - Release sent bytes in the same order conn_io_gather queued them
+static void conn_io_consume_sent(Struct_Socket_clients *client, uint32_t sent) {
+
+#if CONFIG_SOCKET_PUBSUB
+    msg_outbox_t *outbox = &client->outbox;
+    if (!msg_outbox_is_empty(outbox) && outbox->offset > 0) {
+        uint32_t len = MIN(sent, msg_outbox_peek(outbox)->len - outbox->offset);
+        msg_outbox_advance(outbox, len);
+        sent -= len;
+    }
+#endif
+
+    uint32_t len = MIN(sent, ring_buffer_used(&client->tx));
+    ring_buffer_consume(&client->tx, len);
+    sent -= len;
+
+#if CONFIG_SOCKET_PUBSUB
+    while (sent > 0) {
+        len = MIN(sent, msg_outbox_peek(outbox)->len - outbox->offset);
+        msg_outbox_advance(outbox, len);
+        sent -= len;
+    }
+#endif
+}
+
+conn_io_status_t conn_io_flush(Struct_Socket_clients *client) {
+
+    const conn_listener_t *listener = client->listener;
+
+    if (conn_io_hold(client)) {
+        return CONN_IO_OK;
+    }
+
+    while (conn_io_tx_pending(client) > 0) {
+        // Tudo o que está na fila em um único sendmsg (writev) - com um send() por segmento ou
+        // por mensagem, cada pedaço sairia em um segmento TCP próprio
+        struct iovec iov[CONN_IO_MAX_IOV];
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = conn_io_gather(client, iov) };
+        int sent = sendmsg(client->sock_client, &msg, 0);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return CONN_IO_WOULD_BLOCK;
+            }
+            ASYNC_LOGE(TAG_SOCKET, "[CLIENT-%d] Send falhou: errno %d", client->sock_client, errno);
+            return CONN_IO_ERROR;
+        }
+        // Escrita parcial: o restante continua na fila para o próximo sendmsg
+        bool tx_pending = !ring_buffer_is_empty(&client->tx);
+        conn_io_consume_sent(client, sent);
+
+        // TX ring vazio - o handler pode produzir mais sem esperar dados do cliente
+        if (tx_pending && ring_buffer_is_empty(&client->tx) && listener != NULL && listener->handler->on_writable != NULL) {
+            listener->handler->on_writable(client, listener->ctx);
+        }
+    }
+
+    client->tx_state = CONN_TX_IDLE;
+    return CONN_IO_OK;
+}
+
+bool conn_io_want_read(Struct_Socket_clients *client) {
+
+    uint32_t tx_used = ring_buffer_used(&client->tx);
+
+    if (client->rx_paused) {
+        client->rx_paused = tx_used > TX_LOW_WATERMARK;
+    } else {
+        client->rx_paused = tx_used >= TX_HIGH_WATERMARK;
+    }
+    return !client->rx_paused && ring_buffer_free(&client->rx) > 0;
+}
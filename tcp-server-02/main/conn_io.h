@@ -0,0 +1,124 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "conn_table.h"
+
+// Resultado de uma operação de I/O em uma conexão
+typedef enum {
+    CONN_IO_OK,
+    CONN_IO_WOULD_BLOCK,
+    CONN_IO_CLOSED,
+    CONN_IO_ERROR,
+} conn_io_status_t;
+
+// Handler de protocolo - o núcleo de I/O (recv/send, rings, backpressure, timeouts) é o mesmo
+// em todos os modos com sockets BSD; o protocolo só implementa estes callbacks. Todos rodam na
+// task dona da conexão e todos, exceto on_data, são opcionais (NULL)
+typedef struct {
+    // Conexão aceita, rings vazios. Retorna false para recusar (a conexão é fechada)
+    bool (*on_accept)(Struct_Socket_clients *client, void *ctx);
+    // Bytes recebidos - data é uma visão somente leitura de todo o RX ring, válida só durante a
+    // chamada. Retorna quantos bytes consumir (o resto é entregue de novo com o que chegar depois)
+    // ou -1 para encerrar a conexão
+    int32_t (*on_data)(Struct_Socket_clients *client, const ring_buffer_view_t *data, void *ctx);
+    // O TX ring esvaziou após um envio - produtores que não dependem do RX escrevem mais aqui
+    void (*on_writable)(Struct_Socket_clients *client, void *ctx);
+    // Conexão encerrada por qualquer motivo, antes de a posição voltar à tabela
+    void (*on_close)(Struct_Socket_clients *client, void *ctx);
+} conn_handler_t;
+
+// Menuconfig - Política de escrita padrão dos listeners
+#if CONFIG_SOCKET_WRITE_POLICY_THROUGHPUT
+#define CONN_WRITE_POLICY_DEFAULT       CONN_WRITE_THROUGHPUT
+#else
+#define CONN_WRITE_POLICY_DEFAULT       CONN_WRITE_LATENCY
+#endif
+
+// Listener - porta de escuta, o protocolo das conexões aceitas nela e como elas escrevem
+typedef struct conn_listener {
+    uint16_t port;
+    const conn_handler_t *handler;
+    void *ctx;
+    conn_write_policy_t write_policy;
+} conn_listener_t;
+
+// Handler padrão - echo do que chegar, limitado ao espaço livre no TX ring
+extern const conn_handler_t conn_io_echo_handler;
+
+// Opções do socket do cliente, aplicadas uma única vez após o accept(): TCP keepalive,
+// TCP_NODELAY e, nos modos bloqueantes, os timeouts de inatividade e de escrita como SO_RCVTIMEO/SO_SNDTIMEO
+void conn_io_configure_socket(int sock);
+
+// Associa a conexão ao handler e à política de escrita do listener e chama on_accept.
+// Retorna false se ele recusar
+bool conn_io_open(Struct_Socket_clients *client, const conn_listener_t *listener);
+
+// Troca a política de escrita da conexão (ex.: no on_accept, ou por comando do protocolo).
+// Latência: cada flush envia na hora. Throughput: o flush retém os frames no TX ring até
+// juntar um MSS ou vencer o prazo de flush, e então envia tudo em um sendmsg
+void conn_io_set_write_policy(Struct_Socket_clients *client, conn_write_policy_t policy);
+
+// Avisa o handler (on_close). O socket e a posição na tabela continuam com o chamador
+void conn_io_close(Struct_Socket_clients *client);
+
+// Lê do socket direto para o RX ring (uma chamada de recv)
+conn_io_status_t conn_io_recv(Struct_Socket_clients *client);
+
+// Entrega o RX ring ao on_data do handler e consome o que ele aceitou.
+// Retorna CONN_IO_ERROR se o handler pedir para encerrar
+conn_io_status_t conn_io_process(Struct_Socket_clients *client);
+
+// Write API dos handlers - acrescenta ao TX ring tudo ou nada. Retorna false se não couber
+// (o handler deixa os bytes no RX e tenta de novo depois que o flush liberar espaço)
+bool conn_io_write(Struct_Socket_clients *client, const void *data, uint32_t len);
+
+// Como conn_io_write, a partir de uma visão (ex.: um trecho do próprio RX ring)
+bool conn_io_write_view(Struct_Socket_clients *client, const ring_buffer_view_t *view);
+
+// Espaço livre no TX ring
+static inline uint32_t conn_io_write_space(const Struct_Socket_clients *client) {
+    return ring_buffer_free(&client->tx);
+}
+
+// Envia o TX ring, continuando escritas parciais até esvaziar ou o socket bloquear.
+// No pub/sub envia também o outbox no mesmo sendmsg, sem intercalar bytes de frames diferentes.
+// Na política throughput pode reter os dados (CONN_IO_OK com conn_io_tx_held)
+conn_io_status_t conn_io_flush(Struct_Socket_clients *client);
+
+// Política throughput - dados retidos esperando mais frames; o dono da conexão chama
+// conn_io_flush de novo em até conn_io_flush_delay_ms
+static inline bool conn_io_tx_held(const Struct_Socket_clients *client) {
+    return client->tx_state == CONN_TX_HELD;
+}
+
+// ms até o prazo de flush dos dados retidos (0 = vencido)
+uint32_t conn_io_flush_delay_ms(const Struct_Socket_clients *client);
+
+// Backpressure - false enquanto o TX ring estiver acima do high watermark
+// (volta a ler somente após cair abaixo do low watermark) ou o RX ring estiver cheio
+bool conn_io_want_read(Struct_Socket_clients *client);
+
+// Há algo para enviar agora - TX ring ou, no pub/sub, mensagens no outbox.
+// Dados retidos não contam: esperam o prazo de flush, não o socket
+static inline bool conn_io_want_write(const Struct_Socket_clients *client) {
+    if (conn_io_tx_held(client)) {
+        return false;
+    }
+#if CONFIG_SOCKET_PUBSUB
+    if (!msg_outbox_is_empty(&client->outbox)) {
+        return true;
+    }
+#endif
+    return !ring_buffer_is_empty(&client->tx);
+}
+
+// Contador de bytes enviados (livre, só cresce) - compara antes e depois para detectar progresso
+static inline uint32_t conn_io_tx_count(const Struct_Socket_clients *client) {
+#if CONFIG_SOCKET_PUBSUB
+    return client->tx.tail + client->outbox.sent;
+#else
+    return client->tx.tail;
+#endif
+}
@@ -0,0 +1,165 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
+#include "conn_table.h"
+
+_Static_assert(CONN_TABLE_CAPACITY > 0, "SOCKET_RESERVED_SOCKETS/SOCKET_EVENT_LOOP_SHARDS leave no socket for clients");
+_Static_assert(CONN_TABLE_CAPACITY <= UINT16_MAX, "CONN_TABLE_CAPACITY must fit the handle index");
+_Static_assert((CONN_RX_RING_SIZE & (CONN_RX_RING_SIZE - 1)) == 0, "SOCKET_RX_RING_SIZE must be a power of two");
+_Static_assert((CONN_TX_RING_SIZE & (CONN_TX_RING_SIZE - 1)) == 0, "SOCKET_TX_RING_SIZE must be a power of two");
+
+#if CONN_TABLE_SINGLE_OWNER
+#define CONN_TABLE_LOCK(table)
+#define CONN_TABLE_UNLOCK(table)
+#else
+#define CONN_TABLE_LOCK(table)          taskENTER_CRITICAL(&(table)->lock)
+#define CONN_TABLE_UNLOCK(table)        taskEXIT_CRITICAL(&(table)->lock)
+#endif
+
+void conn_table_init(conn_table_t *table) {
+
+    memset(table, 0, sizeof(*table));
+#if !CONN_TABLE_SINGLE_OWNER
+    portMUX_INITIALIZE(&table->lock);
+#endif
+
+    for (int i = 0; i < CONN_TABLE_CAPACITY; i++) {
+        table->entries[i].index = i;
+        table->entries[i].sock_client = -1;
+        for (int t = 0; t < CONN_TIMER_COUNT; t++) {
+            timer_wheel_node_init(&table->entries[i].timers[t], &table->entries[i], t);
+        }
+        timer_wheel_node_init(&table->entries[i].flush_timer, &table->entries[i], 0);
+#if !CONFIG_SOCKET_SERVER_MODE_NETCONN
+        ring_buffer_init(&table->entries[i].rx, table->rx_storage[i], CONN_RX_RING_SIZE);
+        ring_buffer_init(&table->entries[i].tx, table->tx_storage[i], CONN_TX_RING_SIZE);
+#endif
+#if CONFIG_SOCKET_PUBSUB
+        msg_outbox_init(&table->entries[i].outbox);
+#endif
+        // Pilha em ordem inversa: a primeira alocação devolve o índice 0
+        table->free_stack[i] = CONN_TABLE_CAPACITY - 1 - i;
+    }
+    table->free_top = CONN_TABLE_CAPACITY;
+}
+
+#if CONFIG_SOCKET_MAX_CONNS_PER_IP > 0
+static uint32_t conn_ip_hash(in_addr_t ip) {
+
+    return ((uint32_t)ip * 2654435761u) % CONN_IP_SLOTS;
+}
+
+// Posição do IP no hash, ou a posição vazia onde ele entraria
+static uint32_t conn_ip_find(const conn_table_t *table, in_addr_t ip) {
+
+    uint32_t slot = conn_ip_hash(ip);
+    while (table->ip_slots[slot].count != 0 && table->ip_slots[slot].ip != ip) {
+        slot = (slot + 1) % CONN_IP_SLOTS;
+    }
+    return slot;
+}
+
+// Remove a posição sem tombstone - puxa para trás as entradas da mesma sequência de sondagem
+static void conn_ip_remove(conn_table_t *table, uint32_t hole) {
+
+    uint32_t slot = hole;
+
+    for (;;) {
+        slot = (slot + 1) % CONN_IP_SLOTS;
+        if (table->ip_slots[slot].count == 0) {
+            break;
+        }
+        // A entrada fica se a posição de origem dela está entre o buraco (exclusive) e ela
+        uint32_t home = conn_ip_hash(table->ip_slots[slot].ip);
+        bool stays = hole < slot ? (home > hole && home <= slot) : (home > hole || home <= slot);
+        if (!stays) {
+            table->ip_slots[hole] = table->ip_slots[slot];
+            hole = slot;
+        }
+    }
+    table->ip_slots[hole].count = 0;
+}
+#endif
+
+Struct_Socket_clients *conn_table_alloc(conn_table_t *table, const struct sockaddr_in *addr, conn_admit_t *result) {
+
+    Struct_Socket_clients *client = NULL;
+    conn_admit_t admit = CONN_ADMIT_OK;
+
+    CONN_TABLE_LOCK(table);
+#if CONFIG_SOCKET_MAX_CONNS_PER_IP > 0
+    uint32_t ip_slot = conn_ip_find(table, addr->sin_addr.s_addr);
+#endif
+    if (table->free_top == 0) {
+        admit = CONN_ADMIT_TABLE_FULL;
+#if CONFIG_SOCKET_MAX_CONNS_PER_IP > 0
+    } else if (table->ip_slots[ip_slot].count >= CONFIG_SOCKET_MAX_CONNS_PER_IP) {
+        admit = CONN_ADMIT_IP_LIMIT;
+#endif
+    } else {
+        client = &table->entries[table->free_stack[--table->free_top]];
+        client->client_addr = *addr;
+        client->in_use = true;
+#if CONFIG_SOCKET_MAX_CONNS_PER_IP > 0
+        // Contado junto com a reserva - a próxima admissão já vê esta conexão
+        table->ip_slots[ip_slot].ip = addr->sin_addr.s_addr;
+        table->ip_slots[ip_slot].count++;
+#endif
+    }
+    CONN_TABLE_UNLOCK(table);
+
+    if (result != NULL) {
+        *result = admit;
+    }
+
+    if (client != NULL) {
+        client->client_addr_len = sizeof(client->client_addr);
+        client->sock_client = -1;
+        client->rx_paused = false;
+        client->write_policy = CONN_WRITE_LATENCY;
+        client->tx_state = CONN_TX_IDLE;
+        ring_buffer_reset(&client->rx);
+        ring_buffer_reset(&client->tx);
+#if CONFIG_SOCKET_FRAMING_LINE
+        client->line_scanned = 0;
+#endif
+    }
+    return client;
+}
+
+void conn_table_release(conn_table_t *table, Struct_Socket_clients *client) {
+
+    CONN_TABLE_LOCK(table);
+#if CONFIG_SOCKET_MAX_CONNS_PER_IP > 0
+    uint32_t ip_slot = conn_ip_find(table, client->client_addr.sin_addr.s_addr);
+    if (table->ip_slots[ip_slot].count > 0 && --table->ip_slots[ip_slot].count == 0) {
+        conn_ip_remove(table, ip_slot);
+    }
+#endif
+    client->sock_client = -1;
+    client->in_use = false;
+    client->generation++;
+    table->free_stack[table->free_top++] = client->index;
+    CONN_TABLE_UNLOCK(table);
+}
+
+conn_handle_t conn_table_handle(const Struct_Socket_clients *client) {
+
+    return ((conn_handle_t)client->generation << 16) | client->index;
+}
+
+Struct_Socket_clients *conn_table_get(conn_table_t *table, conn_handle_t handle) {
+
+    uint16_t index = handle & 0xFFFF;
+    uint16_t generation = handle >> 16;
+
+    if (index >= CONN_TABLE_CAPACITY || table->entries[index].generation != generation) {
+        return NULL;
+    }
+    return &table->entries[index];
+}
+
+int conn_table_count(conn_table_t *table) {
+
+    return CONN_TABLE_CAPACITY - table->free_top;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "net_sockets.h"
+
+#include "ring_buffer.h"
+#include "timer_wheel.h"
+#if CONFIG_SOCKET_PUBSUB
+#include "msg_pool.h"
+#endif
+
+#if CONFIG_IDF_TARGET_LINUX
+// Build linux - sockets do kernel, o event loop recusa descritores acima de FD_SETSIZE
+#define CONN_MAX_CONNECTIONS            CONFIG_SOCKET_MAX_CLIENTS
+#else
+// O socket de escuta ocupa um dos CONFIG_LWIP_MAX_SOCKETS; os reservados ficam para o resto da aplicação
+#define CONN_MAX_CONNECTIONS            MIN(CONFIG_SOCKET_MAX_CLIENTS, CONFIG_LWIP_MAX_SOCKETS - 1 - CONFIG_SOCKET_RESERVED_SOCKETS)
+#endif
+
+// Event loop com shards - cada shard tem a sua tabela e as conexões são divididas entre eles
+#if CONFIG_SOCKET_EVENT_LOOP_SHARDED
+#define CONN_TABLE_SHARDS               CONFIG_SOCKET_EVENT_LOOP_SHARDS
+#else
+#define CONN_TABLE_SHARDS               1
+#endif
+
+#define CONN_TABLE_CAPACITY             (CONN_MAX_CONNECTIONS / CONN_TABLE_SHARDS)
+
+// Menuconfig - Ring buffers por conexão (potências de 2)
+#define CONN_RX_RING_SIZE               CONFIG_SOCKET_RX_RING_SIZE
+#define CONN_TX_RING_SIZE               CONFIG_SOCKET_TX_RING_SIZE
+
+// Handle de conexão: geração (16 bits altos) + índice na tabela (16 bits baixos)
+typedef uint32_t conn_handle_t;
+
+#define CONN_HANDLE_INVALID             ((conn_handle_t)0xFFFFFFFF)
+
+// Prazos de cada conexão (timer wheel do event loop)
+typedef enum {
+    CONN_TIMER_IDLE,        // Nenhum dado recebido
+    CONN_TIMER_READ,        // Dados parados no RX ring (frame incompleto)
+    CONN_TIMER_WRITE,       // TX ring sem progresso
+    CONN_TIMER_COUNT,
+} conn_timer_t;
+
+// Política de escrita de uma conexão (conn_io.h)
+typedef enum {
+    CONN_WRITE_LATENCY,     // Cada flush envia na hora
+    CONN_WRITE_THROUGHPUT,  // Agrupa os frames até um MSS ou o prazo de flush
+} conn_write_policy_t;
+
+// Escrita agrupada - estado do TX na política throughput
+typedef enum {
+    CONN_TX_IDLE,           // Nada retido
+    CONN_TX_HELD,           // Dados retidos esperando completar o alvo ou o prazo
+    CONN_TX_DRAINING,       // Envio iniciado - continua até esvaziar, sem reter de novo
+} conn_tx_state_t;
+
+// Resultado da admissão de uma nova conexão
+typedef enum {
+    CONN_ADMIT_OK,
+    CONN_ADMIT_TABLE_FULL,
+    CONN_ADMIT_IP_LIMIT,
+} conn_admit_t;
+
+#if CONFIG_SOCKET_SERVER_MODE_NETCONN
+struct netconn;
+#endif
+
+// Listener que aceitou a conexão - define o protocolo (conn_io.h)
+struct conn_listener;
+
+// Struct socket clients
+typedef struct {
+    struct sockaddr_in client_addr;
+    socklen_t client_addr_len;
+    int sock_client;
+    ring_buffer_t rx;
+    ring_buffer_t tx;
+    bool rx_paused;         // Backpressure - leitura suspensa até o TX ring esvaziar
+    bool in_use;
+    const struct conn_listener *listener;   // Handler de protocolo da conexão
+    timer_wheel_node_t timers[CONN_TIMER_COUNT];
+    conn_write_policy_t write_policy;   // Do listener, ajustável por conexão
+    conn_tx_state_t tx_state;
+    uint32_t tx_held_since;             // ms em que os dados retidos começaram a esperar
+    timer_wheel_node_t flush_timer;     // Prazo de flush (timer wheel fino do event loop)
+#if CONFIG_SOCKET_SERVER_MODE_NETCONN
+    struct netconn *netconn;    // Modo netconn - sock_client fica em -1
+#endif
+#if CONFIG_SOCKET_PUBSUB
+    msg_outbox_t outbox;    // Mensagens publicadas para esta conexão (referências)
+#endif
+#if CONFIG_SOCKET_FRAMING_LINE
+    uint32_t line_scanned;  // Bytes do início do RX ring já varridos sem achar '\n'
+#endif
+    uint16_t index;         // Posição fixa na tabela
+    uint16_t generation;    // Incrementada a cada liberação - invalida handles antigos
+}Struct_Socket_clients;
+
+#if CONFIG_SOCKET_MAX_CONNS_PER_IP > 0
+// Conexões por IP - hash com sondagem linear, o dobro da capacidade (sempre sobra posição vazia)
+#define CONN_IP_SLOTS                   (2 * CONN_TABLE_CAPACITY)
+
+typedef struct {
+    in_addr_t ip;
+    uint16_t count;         // 0 = posição vazia
+} conn_ip_slot_t;
+#endif
+
+// Event loop - cada tabela (a de cada shard e a do listener UDP) só é tocada pela task dona e
+// dispensa o lock. Nos outros modos o accept e as tasks de cliente/pool compartilham a tabela
+#if CONFIG_SOCKET_SERVER_MODE_EVENT_LOOP
+#define CONN_TABLE_SINGLE_OWNER         1
+#else
+#define CONN_TABLE_SINGLE_OWNER         0
+#endif
+
+// Tabela de conexões pré-alocada: alocação e liberação O(1) por pilha de índices livres
+typedef struct {
+    Struct_Socket_clients entries[CONN_TABLE_CAPACITY];
+#if !CONFIG_SOCKET_SERVER_MODE_NETCONN
+    // Modo netconn - os dados ficam nos pbufs do lwIP, sem rings
+    uint8_t rx_storage[CONN_TABLE_CAPACITY][CONN_RX_RING_SIZE];
+    uint8_t tx_storage[CONN_TABLE_CAPACITY][CONN_TX_RING_SIZE];
+#endif
+    uint16_t free_stack[CONN_TABLE_CAPACITY];
+    uint16_t free_top;
+#if CONFIG_SOCKET_MAX_CONNS_PER_IP > 0
+    conn_ip_slot_t ip_slots[CONN_IP_SLOTS];  // Contador por IP - admissão O(1)
+#endif
+#if !CONN_TABLE_SINGLE_OWNER
+    portMUX_TYPE lock;
+#endif
+}conn_table_t;
+
+// Inicializa a tabela com todas as posições livres
+void conn_table_init(conn_table_t *table);
+
+// Reserva uma posição para o cliente em addr. Retorna NULL (com o motivo em result) se a
+// tabela estiver cheia ou o IP já tiver CONFIG_SOCKET_MAX_CONNS_PER_IP conexões
+Struct_Socket_clients *conn_table_alloc(conn_table_t *table, const struct sockaddr_in *addr, conn_admit_t *result);
+
+// Devolve a posição à tabela e invalida os handles emitidos para ela
+void conn_table_release(conn_table_t *table, Struct_Socket_clients *client);
+
+// Handle estável para a conexão, seguro para atravessar filas e tasks
+conn_handle_t conn_table_handle(const Struct_Socket_clients *client);
+
+// Resolve um handle. Retorna NULL se a conexão já foi liberada
+Struct_Socket_clients *conn_table_get(conn_table_t *table, conn_handle_t handle);
+
+// Número de conexões em uso. Lido sem lock por outra task é só uma estimativa
+int conn_table_count(conn_table_t *table);
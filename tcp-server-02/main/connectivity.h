@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Camada de conectividade - sobe a rede ao lado do servidor TCP.
+//   ESP32: Wi-Fi STA (connectivity_wifi_sta.c)
+//   Build linux: rede do host, sockets do kernel (connectivity_host.c)
+// Dividida em estágios para o orquestrador de inicialização (init_graph): NVS e pilha TCP/IP
+// são síncronos, a conexão só dispara o Wi-Fi e avisa pelo callback, sem bloquear
+
+// Partição NVS padrão (cache da conexão rápida, calibração do PHY)
+esp_err_t connectivity_init_nvs(void);
+
+// Pilha TCP/IP e event loop padrão - depois deles os listeners já podem fazer bind
+esp_err_t connectivity_init_stack(void);
+
+// Inicia a conexão e retorna. on_done roda uma vez: ESP_OK no primeiro IP, ESP_FAIL no fim
+// da fase rápida de tentativas - no ESP32 elas continuam em segundo plano, com backoff (wifi_manager)
+esp_err_t connectivity_connect(void (*on_done)(esp_err_t err));
+
+// Interface com IP agora, sem bloquear
+bool connectivity_is_online(void);
@@ -0,0 +1,29 @@
+#include "esp_log.h"
+
+#include "connectivity.h"
+
+// Tags de depuração:
+static const char *TAG_NET_HOST = "DEBUG - NET-HOST";
+
+// Build linux - a rede já está de pé no host, o servidor usa os sockets do kernel
+esp_err_t connectivity_init_nvs(void) {
+
+    return ESP_OK;
+}
+
+esp_err_t connectivity_init_stack(void) {
+
+    return ESP_OK;
+}
+
+esp_err_t connectivity_connect(void (*on_done)(esp_err_t err)) {
+
+    ESP_LOGI(TAG_NET_HOST, "Build linux - usando as interfaces de rede do host");
+    on_done(ESP_OK);
+    return ESP_OK;
+}
+
+bool connectivity_is_online(void) {
+
+    return true;
+}
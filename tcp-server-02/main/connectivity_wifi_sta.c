@@ -0,0 +1,156 @@
+#include "freertos/FreeRTOS.h"
+#include "esp_system.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "esp_netif.h"
+
+#include "async_log.h"
+#include "wifi_fast_connect.h"
+#include "wifi_manager.h"
+#include "boot_trace.h"
+
+#include "connectivity.h"
+
+// Menuconfig - WiFi
+#define EXAMPLE_ESP_WIFI_SSID           CONFIG_ESP_WIFI_SSID
+#define EXAMPLE_ESP_WIFI_PASS           CONFIG_ESP_WIFI_PASSWORD
+#define EXAMPLE_ESP_MAXIMUM_RETRY       CONFIG_ESP_MAXIMUM_RETRY
+
+// Tags de depuração:
+static const char *TAG_WIFI_STA = "DEBUG - WIFI-STA";
+
+// Function - Event handlers
+// Reconexão fica com o wifi_manager - aqui só o cache da conexão rápida e os logs
+static void event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
+
+    // Event - Wifi connected (associado, ainda sem IP) - BSSID e canal para o próximo boot
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        wifi_fast_connect_on_connected((wifi_event_sta_connected_t*) event_data);
+        boot_trace_mark(BOOT_TRACE_ASSOCIATED);
+    } else 
+
+    // Event - Got-ip
+    if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
+        ASYNC_LOGI(TAG_WIFI_STA, "IP recebido - " IPSTR, IP2STR(&event->ip_info.ip));
+        wifi_fast_connect_on_got_ip();
+        boot_trace_mark(BOOT_TRACE_GOT_IP);
+    }    
+}
+
+static void (*s_on_connect_done)(esp_err_t err);
+
+// Primeiro IP ou fim da fase rápida (wifi_manager) - fecha o estágio de conexão
+static void connectivity_on_ready(bool online) {
+
+    if (online) {
+        ASYNC_LOGI(TAG_WIFI_STA, "Conectado no ap  - ssid:%s, password:%s", EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
+    } else {
+        ASYNC_LOGI(TAG_WIFI_STA, "Falha ao conecta no ap -  ssid:%s, password:%s", EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
+    }
+    s_on_connect_done(online ? ESP_OK : ESP_FAIL);
+}
+
+esp_err_t connectivity_init_nvs(void) {
+
+    // Initialize the default NVS partition
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        err = nvs_flash_erase();
+        if (err == ESP_OK) {
+            err = nvs_flash_init();
+        }
+    }
+    if (err == ESP_OK) {
+        boot_trace_mark(BOOT_TRACE_NVS);
+    }
+    return err;
+}
+
+esp_err_t connectivity_init_stack(void) {
+
+    // Initialize the underlying TCP/IP stack
+    esp_err_t err = esp_netif_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+    boot_trace_mark(BOOT_TRACE_NETIF);
+
+    // Create default event loop
+    return esp_event_loop_create_default();
+}
+
+// Function - Started Wifi-STA
+// Não espera o IP - o resultado chega pelo on_done
+esp_err_t connectivity_connect(void (*on_done)(esp_err_t err)) {
+
+    s_on_connect_done = on_done;
+
+    // Log - Debug
+    ASYNC_LOGI(TAG_WIFI_STA, "Iniciando WiFi em modo estação");
+
+    // Creates default WIFI STA. In case of any init error this API aborts.
+    esp_netif_create_default_wifi_sta();
+
+    // Initialize WiFi
+    wifi_init_config_t cfg_init_wifi = WIFI_INIT_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_wifi_init(&cfg_init_wifi));
+    boot_trace_mark(BOOT_TRACE_WIFI_INIT);
+
+    // Register an instance of event handler to the default loop.
+    esp_event_handler_instance_t instance_any_id;
+    esp_event_handler_instance_t instance_got_ip;
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
+                                                        ESP_EVENT_ANY_ID,
+                                                        &event_handler,
+                                                        NULL,
+                                                        &instance_any_id));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT,
+                                                        IP_EVENT_STA_GOT_IP,
+                                                        &event_handler,
+                                                        NULL,
+                                                        &instance_got_ip));
+
+    // Reconexão com backoff - fase rápida com EXAMPLE_ESP_MAXIMUM_RETRY tentativas, depois sem limite.
+    // AP em cache que falhou volta ao scan completo na hora, sem avançar o backoff.
+    // O servidor sobe mesmo sem rede - o on_ready só fecha o estágio, o manager segue tentando
+    const wifi_manager_config_t manager_cfg = {
+        .fast_retries = EXAMPLE_ESP_MAXIMUM_RETRY,
+        .on_disconnected = wifi_fast_connect_on_disconnected,
+        .on_ready = connectivity_on_ready,
+    };
+    ESP_ERROR_CHECK(wifi_manager_start(&manager_cfg));
+
+    // Configuration data for device sta
+    wifi_config_t wifi_cfg = {
+        .sta = {
+            .ssid = EXAMPLE_ESP_WIFI_SSID,
+            .password = EXAMPLE_ESP_WIFI_PASS,
+        },
+    };
+
+    // Conexão rápida - BSSID e canal do último AP (NVS), um canal só na primeira tentativa
+    wifi_fast_connect_apply(&wifi_cfg);
+
+    // Set the WiFi operating mode - WIFI_MODE_STA
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+
+    // Set the configuration of the STA
+    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_cfg));
+
+    // Start WiFi
+    ESP_ERROR_CHECK(esp_wifi_start());
+    boot_trace_mark(BOOT_TRACE_WIFI_START);
+
+    // Log - Debug
+    ASYNC_LOGI(TAG_WIFI_STA, "Inicializado!");
+    return ESP_OK;
+}
+
+bool connectivity_is_online(void) {
+
+    return wifi_manager_is_online();
+}
@@ -0,0 +1,114 @@
+#include "esp_log.h"
+#include "async_log.h"
+
+#include "framing.h"
+
+_Static_assert(FRAME_MAX_PAYLOAD < (1u << 28), "SOCKET_FRAME_MAX_PAYLOAD must fit a 4-byte varint");
+_Static_assert(FRAME_MAX_PAYLOAD + FRAME_MAX_HEADER_LEN <= CONN_RX_RING_SIZE, "a full frame must fit the RX ring");
+_Static_assert(FRAME_MAX_PAYLOAD + FRAME_MAX_HEADER_LEN <= CONN_TX_RING_SIZE, "a full frame must fit the TX ring");
+
+// Tags de depuração:
+static const char *TAG_SOCKET = "DEBUG - TCP-SOCKET";
+
+// Decodifica o varint do tamanho. Retorna o número de bytes do varint, 0 se incompleto, -1 se inválido
+static int framing_decode_length(const ring_buffer_view_t *data, uint32_t offset, uint32_t available, uint32_t *length) {
+
+    uint32_t value = 0;
+
+    for (uint32_t i = 0; i < 4; i++) {
+        if (i >= available) {
+            return 0;
+        }
+        uint8_t byte = ring_buffer_view_at(data, offset + i);
+        value |= (uint32_t)(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            *length = value;
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+int32_t framing_parse(Struct_Socket_clients *client, const ring_buffer_view_t *data, frame_handler_t handler, void *ctx) {
+
+    uint32_t total = ring_buffer_view_len(data);
+    uint32_t consumed = 0;
+
+    for (;;) {
+        uint32_t available = total - consumed;
+        uint32_t length;
+
+        int varint_len = framing_decode_length(data, consumed, available, &length);
+        if (varint_len < 0 || (varint_len > 0 && length > FRAME_MAX_PAYLOAD)) {
+            ASYNC_LOGE(TAG_SOCKET, "[CLIENT-%d] Frame inválido", client->sock_client);
+            return -1;
+        }
+        if (varint_len == 0 || available < varint_len + 1 + length) {
+            return consumed;
+        }
+
+        // Payload entregue como visão do ring - 2 segmentos se cruzar o fim do buffer
+        uint8_t type = ring_buffer_view_at(data, consumed + varint_len);
+        ring_buffer_view_t payload;
+        ring_buffer_view_slice(data, consumed + varint_len + 1, length, &payload);
+
+        frame_result_t result = handler(client, type, &payload, ctx);
+        if (result == FRAME_RETRY) {
+            return consumed;
+        }
+        if (result == FRAME_ERROR) {
+            ASYNC_LOGE(TAG_SOCKET, "[CLIENT-%d] Resposta maior que um frame", client->sock_client);
+            return -1;
+        }
+        consumed += varint_len + 1 + length;
+    }
+}
+
+uint32_t framing_encode_header(uint8_t *header, uint8_t type, uint32_t length) {
+
+    uint32_t header_len = 0;
+
+    do {
+        uint8_t byte = length & 0x7F;
+        length >>= 7;
+        header[header_len++] = byte | (length ? 0x80 : 0);
+    } while (length);
+    header[header_len++] = type;
+    return header_len;
+}
+
+frame_result_t framing_write(ring_buffer_t *tx, uint8_t type, const ring_buffer_view_t *payload) {
+
+    uint8_t header[FRAME_MAX_HEADER_LEN];
+    uint32_t length = ring_buffer_view_len(payload);
+
+    // Acima do máximo o frame não cabe no ring nem vazio - esperar travaria a conexão
+    if (length > FRAME_MAX_PAYLOAD) {
+        return FRAME_ERROR;
+    }
+
+    uint32_t header_len = framing_encode_header(header, type, length);
+    if (ring_buffer_free(tx) < header_len + length) {
+        return FRAME_RETRY;
+    }
+
+    ring_buffer_write(tx, header, header_len);
+    ring_buffer_write(tx, payload->ptr[0], payload->len[0]);
+    ring_buffer_write(tx, payload->ptr[1], payload->len[1]);
+    return FRAME_DONE;
+}
+
+// Echo de frames - reenvia o frame com o mesmo tipo, copiando direto do RX para o TX ring
+static frame_result_t framing_echo_frame(Struct_Socket_clients *client, uint8_t type, const ring_buffer_view_t *payload, void *ctx) {
+
+    return framing_write(&client->tx, type, payload);
+}
+
+static int32_t framing_echo_data(Struct_Socket_clients *client, const ring_buffer_view_t *data, void *ctx) {
+
+    return framing_parse(client, data, framing_echo_frame, NULL);
+}
+
+const conn_handler_t framing_echo_handler = {
+    .on_data = framing_echo_data,
+};
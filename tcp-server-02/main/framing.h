@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "conn_io.h"
+
+// Frame: [tamanho do payload - varint LEB128, até 4 bytes][tipo - 1 byte][payload]
+#define FRAME_MAX_HEADER_LEN            5
+#define FRAME_MAX_PAYLOAD               CONFIG_SOCKET_FRAME_MAX_PAYLOAD
+
+// Resultado do handler de frame e do framing_write
+typedef enum {
+    FRAME_DONE,                         // Frame tratado
+    FRAME_RETRY,                        // Sem espaço agora - o frame fica no ring e o parse para
+    FRAME_ERROR,                        // Nunca vai caber - a conexão é encerrada
+} frame_result_t;
+
+// Callback da aplicação - payload aponta direto para o RX ring (sem cópia) e só é
+// válido durante a chamada
+typedef frame_result_t (*frame_handler_t)(Struct_Socket_clients *client, uint8_t type, const ring_buffer_view_t *payload, void *ctx);
+
+// Entrega cada frame completo de data (visão do on_data) ao handler. Retorna os bytes dos
+// frames aceitos - pronto para ser o retorno do on_data - ou -1 para frame inválido
+int32_t framing_parse(Struct_Socket_clients *client, const ring_buffer_view_t *data, frame_handler_t handler, void *ctx);
+
+// Handler de conexão com framing - echo de cada frame com o mesmo tipo
+extern const conn_handler_t framing_echo_handler;
+
+// Monta o cabeçalho (varint do tamanho + tipo) em header. Retorna o número de bytes
+uint32_t framing_encode_header(uint8_t *header, uint8_t type, uint32_t length);
+
+// Escreve um frame completo no TX ring (cabeçalho + payload) ou nada, se não couber agora.
+// Payload acima de FRAME_MAX_PAYLOAD retorna FRAME_ERROR em vez de esperar espaço para sempre
+frame_result_t framing_write(ring_buffer_t *tx, uint8_t type, const ring_buffer_view_t *payload);
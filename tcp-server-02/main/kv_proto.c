@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <inttypes.h>
+
+#include "line_framing.h"
+#include "kv_store.h"
+#include "kv_proto.h"
+
+// Pior caso de cada resposta - o comando só executa com esse espaço livre no TX ring
+#define KV_REPLY_MAX_SHORT              32                          // +OK, :n, -ERR ...
+#define KV_REPLY_MAX_HEADER             16                          // $n\r\n ou *n\r\n
+#define KV_REPLY_MAX_BULK               (KV_REPLY_MAX_HEADER + KV_MAX_VALUE + 2)
+#define KV_REPLY_MAX_STATS              (KV_REPLY_MAX_HEADER + 96)
+
+_Static_assert(KV_REPLY_MAX_BULK <= CONN_TX_RING_SIZE, "a GET reply must fit the TX ring");
+_Static_assert(sizeof("SET ") + KV_MAX_KEY + 1 + KV_MAX_VALUE + 2 <= CONN_RX_RING_SIZE, "a SET line must fit the RX ring");
+
+typedef enum {
+    KV_CMD_UNKNOWN,
+    KV_CMD_SET,
+    KV_CMD_GET,
+    KV_CMD_DEL,
+    KV_CMD_MGET,
+    KV_CMD_STATS,
+} kv_cmd_t;
+
+// Respostas escritas no TX ring pela write API. overflow: não coube - o chamador desfaz até head
+typedef struct {
+    Struct_Socket_clients *client;
+    uint32_t head;
+    bool overflow;
+} kv_reply_t;
+
+static void kv_reply_write(kv_reply_t *reply, const void *data, uint32_t len) {
+
+    if (!reply->overflow && !conn_io_write(reply->client, data, len)) {
+        reply->overflow = true;
+    }
+}
+
+static void kv_reply_str(kv_reply_t *reply, const char *str) {
+
+    kv_reply_write(reply, str, strlen(str));
+}
+
+// Cabeçalho "<prefix><n>\r\n" - bulk ($), array (*) ou inteiro (:)
+static void kv_reply_header(kv_reply_t *reply, char prefix, int32_t n) {
+
+    char header[KV_REPLY_MAX_HEADER];
+    int len = snprintf(header, sizeof(header), "%c%" PRId32 "\r\n", prefix, n);
+    kv_reply_write(reply, header, len);
+}
+
+static void kv_reply_bulk(kv_reply_t *reply, const void *data, uint32_t len) {
+
+    kv_reply_header(reply, '$', len);
+    kv_reply_write(reply, data, len);
+    kv_reply_write(reply, "\r\n", 2);
+}
+
+// Visit do kv_store_get - copia o valor para o TX ring ainda sob o lock do cache
+static void kv_reply_value(const uint8_t *value, uint32_t len, void *ctx) {
+
+    kv_reply_bulk(ctx, value, len);
+}
+
+// Function - Next space-separated token in [*pos, end). Returns its length (0 = fim da linha)
+static uint32_t kv_proto_token(const ring_buffer_view_t *line, uint32_t *pos, uint32_t end, uint32_t *start) {
+
+    while (*pos < end && ring_buffer_view_at(line, *pos) == ' ') {
+        (*pos)++;
+    }
+    *start = *pos;
+    while (*pos < end && ring_buffer_view_at(line, *pos) != ' ') {
+        (*pos)++;
+    }
+    return *pos - *start;
+}
+
+static kv_cmd_t kv_proto_command_id(const ring_buffer_view_t *line, uint32_t start, uint32_t len) {
+
+    static const struct {
+        const char *name;
+        kv_cmd_t cmd;
+    } s_commands[] = {
+        { "SET", KV_CMD_SET },
+        { "GET", KV_CMD_GET },
+        { "DEL", KV_CMD_DEL },
+        { "MGET", KV_CMD_MGET },
+        { "STATS", KV_CMD_STATS },
+    };
+    char name[sizeof("STATS")] = { 0 };
+
+    if (len >= sizeof(name)) {
+        return KV_CMD_UNKNOWN;
+    }
+    ring_buffer_view_copy(line, start, name, len);
+    for (size_t i = 0; i < sizeof(s_commands) / sizeof(s_commands[0]); i++) {
+        if (strcasecmp(name, s_commands[i].name) == 0) {
+            return s_commands[i].cmd;
+        }
+    }
+    return KV_CMD_UNKNOWN;
+}
+
+// Function - Execute one command line (line handler)
+// Retorna false, sem executar nada, se o pior caso da resposta não couber no TX ring
+static bool kv_proto_command(Struct_Socket_clients *client, const ring_buffer_view_t *line, void *ctx) {
+
+    uint32_t line_len = ring_buffer_view_len(line);
+    kv_reply_t reply = { .client = client, .head = client->tx.head, .overflow = false };
+    char key[KV_MAX_KEY];
+    uint32_t pos = 0;
+    uint32_t start;
+    uint32_t len;
+
+    len = kv_proto_token(line, &pos, line_len, &start);
+    if (len == 0) {
+        return true;    // Linha vazia
+    }
+    kv_cmd_t cmd = kv_proto_command_id(line, start, len);
+    uint32_t args_pos = pos;
+
+    uint32_t nargs = 0;
+    while (kv_proto_token(line, &pos, line_len, &start) > 0) {
+        nargs++;
+    }
+
+    uint32_t need = KV_REPLY_MAX_SHORT;
+    if (cmd == KV_CMD_GET || cmd == KV_CMD_MGET) {
+        need = KV_REPLY_MAX_HEADER + nargs * KV_REPLY_MAX_BULK;
+    } else if (cmd == KV_CMD_STATS) {
+        need = KV_REPLY_MAX_STATS;
+    }
+    // Com o TX ring vazio executa mesmo assim: um MGET longo demais nunca caberia
+    if (conn_io_write_space(client) < need && !ring_buffer_is_empty(&client->tx)) {
+        return false;
+    }
+
+    pos = args_pos;
+    switch (cmd) {
+    case KV_CMD_SET: {
+        uint32_t key_len = kv_proto_token(line, &pos, line_len, &start);
+        if (key_len > KV_MAX_KEY) {
+            kv_reply_str(&reply, "-ERR key too long\r\n");
+            break;
+        }
+        ring_buffer_view_copy(line, start, key, key_len);
+        // O valor é o resto da linha, com espaços - entregue como visão do RX ring, sem cópia
+        kv_proto_token(line, &pos, line_len, &start);
+        uint32_t value_len = line_len - start;
+        if (key_len == 0 || value_len == 0) {
+            kv_reply_str(&reply, "-ERR wrong number of arguments\r\n");
+        } else if (value_len > KV_MAX_VALUE) {
+            kv_reply_str(&reply, "-ERR value too long\r\n");
+        } else {
+            ring_buffer_view_t value;
+            ring_buffer_view_slice(line, start, value_len, &value);
+            kv_store_set(key, key_len, &value);
+            kv_reply_str(&reply, "+OK\r\n");
+        }
+        break;
+    }
+
+    case KV_CMD_GET:
+    case KV_CMD_MGET:
+        if (nargs == 0 || (cmd == KV_CMD_GET && nargs != 1)) {
+            kv_reply_str(&reply, "-ERR wrong number of arguments\r\n");
+            break;
+        }
+        if (cmd == KV_CMD_MGET) {
+            kv_reply_header(&reply, '*', nargs);
+        }
+        while ((len = kv_proto_token(line, &pos, line_len, &start)) > 0) {
+            // Chave maior que o limite nunca foi gravada
+            bool found = false;
+            if (len <= KV_MAX_KEY) {
+                ring_buffer_view_copy(line, start, key, len);
+                found = kv_store_get(key, len, kv_reply_value, &reply);
+            }
+            if (!found) {
+                kv_reply_str(&reply, "$-1\r\n");
+            }
+        }
+        break;
+
+    case KV_CMD_DEL: {
+        if (nargs == 0) {
+            kv_reply_str(&reply, "-ERR wrong number of arguments\r\n");
+            break;
+        }
+        int32_t removed = 0;
+        while ((len = kv_proto_token(line, &pos, line_len, &start)) > 0) {
+            if (len <= KV_MAX_KEY) {
+                ring_buffer_view_copy(line, start, key, len);
+                removed += kv_store_del(key, len);
+            }
+        }
+        kv_reply_header(&reply, ':', removed);
+        break;
+    }
+
+    case KV_CMD_STATS: {
+        kv_store_stats_t stats;
+        char text[96];
+        kv_store_get_stats(&stats);
+        int text_len = snprintf(text, sizeof(text), "items=%" PRIu32 " hits=%" PRIu32 " misses=%" PRIu32 " evictions=%" PRIu32,
+                                stats.items, stats.hits, stats.misses, stats.evictions);
+        kv_reply_bulk(&reply, text, text_len);
+        break;
+    }
+
+    default:
+        kv_reply_str(&reply, "-ERR unknown command\r\n");
+        break;
+    }
+
+    if (reply.overflow) {
+        // Só acontece com o TX ring vazio - desfaz a resposta parcial e devolve um erro curto
+        client->tx.head = reply.head;
+        reply.overflow = false;
+        kv_reply_str(&reply, "-ERR reply too large\r\n");
+    }
+    return true;
+}
+
+// Pipelining - atende todas as linhas completas; as respostas saem juntas no próximo flush
+static int32_t kv_proto_data(Struct_Socket_clients *client, const ring_buffer_view_t *data, void *ctx) {
+
+    return line_framing_parse(client, data, kv_proto_command, NULL);
+}
+
+const conn_handler_t kv_proto_handler = {
+    .on_data = kv_proto_data,
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "conn_io.h"
+
+// Protocolo do cache chave/valor - uma linha de texto por comando, terminada em \n (\r opcional),
+// nomes de comando sem distinção de maiúsculas:
+//   SET <chave> <valor>          -> +OK                   (o valor é o resto da linha)
+//   GET <chave>                  -> $<n> <valor> | $-1     (bulk: "$n\r\n" + valor + "\r\n")
+//   DEL <chave> [<chave> ...]    -> :<removidas>
+//   MGET <chave> [<chave> ...]   -> *<n> seguido de um bulk por chave
+//   STATS                        -> bulk "items=.. hits=.. misses=.. evictions=.."
+// Erros respondem "-ERR <motivo>". Respostas no formato do RESP, todas terminadas em \r\n.
+//
+// Pipelining: todas as linhas completas do RX ring são atendidas na mesma passada e as
+// respostas se acumulam no TX ring - o flush seguinte envia tudo em um send().
+
+// Handler de conexão do cache. Para (sem consumir o comando) quando a resposta não cabe no
+// TX ring; encerra a conexão se o RX ring encher sem um fim de linha
+extern const conn_handler_t kv_proto_handler;
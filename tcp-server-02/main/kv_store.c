@@ -0,0 +1,281 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "kv_store.h"
+
+// Índice com o dobro de posições da arena - sondagens curtas mesmo com a arena cheia
+#define KV_INDEX_SIZE                   (2 * KV_CAPACITY)
+#define KV_NONE                         UINT16_MAX
+
+_Static_assert(KV_INDEX_SIZE < KV_NONE, "SOCKET_KV_CAPACITY must fit the 16-bit item index");
+_Static_assert(KV_MAX_KEY <= UINT8_MAX, "SOCKET_KV_MAX_KEY must fit kv_item_t.key_len");
+_Static_assert(KV_MAX_VALUE <= UINT16_MAX, "SOCKET_KV_MAX_VALUE must fit kv_item_t.value_len");
+
+typedef struct {
+    uint32_t hash;
+    uint16_t value_len;
+    uint8_t key_len;
+#if CONFIG_SOCKET_KV_EVICTION_LRU
+    uint16_t prev;          // Lista do mais recente (head) ao menos recente (tail)
+    uint16_t next;          // Também encadeia a lista de livres
+#else
+    bool referenced;        // CLOCK - acessado desde a última passagem do ponteiro
+    uint16_t next;          // Lista de livres
+#endif
+    char key[KV_MAX_KEY];
+    uint8_t value[KV_MAX_VALUE];
+} kv_item_t;
+
+// Arena única, dimensionada no build
+static kv_item_t s_items[KV_CAPACITY];
+// Posição do índice -> item + 1 (0 = vazia)
+static uint16_t s_index[KV_INDEX_SIZE];
+static uint16_t s_free;
+static kv_store_stats_t s_stats;
+#if CONFIG_SOCKET_KV_EVICTION_LRU
+static uint16_t s_lru_head;
+static uint16_t s_lru_tail;
+#else
+static uint16_t s_clock_hand;
+#endif
+
+// Mutex e não portMUX: o set copia até KV_MAX_VALUE bytes e o visit do get escreve no TX ring -
+// longo demais para rodar com as interrupções mascaradas
+static StaticSemaphore_t s_lock_buffer;
+static SemaphoreHandle_t s_lock;
+
+#define KV_LOCK()                       xSemaphoreTake(s_lock, portMAX_DELAY)
+#define KV_UNLOCK()                     xSemaphoreGive(s_lock)
+
+// FNV-1a
+static uint32_t kv_hash(const char *key, uint32_t len) {
+
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)key[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static inline uint32_t kv_slot_next(uint32_t slot) {
+    return slot + 1 == KV_INDEX_SIZE ? 0 : slot + 1;
+}
+
+#if CONFIG_SOCKET_KV_EVICTION_LRU
+static void kv_lru_unlink(uint16_t item) {
+
+    uint16_t prev = s_items[item].prev;
+    uint16_t next = s_items[item].next;
+
+    if (prev != KV_NONE) {
+        s_items[prev].next = next;
+    } else {
+        s_lru_head = next;
+    }
+    if (next != KV_NONE) {
+        s_items[next].prev = prev;
+    } else {
+        s_lru_tail = prev;
+    }
+}
+
+static void kv_lru_push_front(uint16_t item) {
+
+    s_items[item].prev = KV_NONE;
+    s_items[item].next = s_lru_head;
+    if (s_lru_head != KV_NONE) {
+        s_items[s_lru_head].prev = item;
+    } else {
+        s_lru_tail = item;
+    }
+    s_lru_head = item;
+}
+#endif
+
+// Function - Mark an item as recently used
+static inline void kv_touch(uint16_t item) {
+
+#if CONFIG_SOCKET_KV_EVICTION_LRU
+    if (s_lru_head != item) {
+        kv_lru_unlink(item);
+        kv_lru_push_front(item);
+    }
+#else
+    s_items[item].referenced = true;
+#endif
+}
+
+// Function - Index slot holding the key, or KV_NONE
+static uint32_t kv_find_slot(const char *key, uint32_t key_len, uint32_t hash) {
+
+    for (uint32_t slot = hash % KV_INDEX_SIZE; s_index[slot] != 0; slot = kv_slot_next(slot)) {
+        const kv_item_t *item = &s_items[s_index[slot] - 1];
+        if (item->hash == hash && item->key_len == key_len && memcmp(item->key, key, key_len) == 0) {
+            return slot;
+        }
+    }
+    return KV_NONE;
+}
+
+// Function - Remove an index slot shifting the following entries back (sondagem linear sem lápides)
+static void kv_index_remove(uint32_t hole) {
+
+    uint32_t slot = hole;
+
+    for (;;) {
+        slot = kv_slot_next(slot);
+        if (s_index[slot] == 0) {
+            break;
+        }
+        // Só move a entrada se a posição de origem dela não estiver entre o buraco e ela
+        uint32_t home = s_items[s_index[slot] - 1].hash % KV_INDEX_SIZE;
+        bool movable = hole <= slot ? (home <= hole || home > slot) : (home <= hole && home > slot);
+        if (movable) {
+            s_index[hole] = s_index[slot];
+            hole = slot;
+        }
+    }
+    s_index[hole] = 0;
+}
+
+// Function - Unlink an item from the index and the eviction order and free it
+static void kv_item_free(uint32_t slot) {
+
+    uint16_t item = s_index[slot] - 1;
+
+    kv_index_remove(slot);
+#if CONFIG_SOCKET_KV_EVICTION_LRU
+    kv_lru_unlink(item);
+#endif
+    s_items[item].next = s_free;
+    s_free = item;
+    s_stats.items--;
+}
+
+// Function - Choose the item to evict with the arena full
+static uint16_t kv_pick_victim(void) {
+
+#if CONFIG_SOCKET_KV_EVICTION_LRU
+    return s_lru_tail;
+#else
+    // CLOCK: segunda chance para os itens acessados desde a última volta
+    for (;;) {
+        uint16_t item = s_clock_hand;
+        s_clock_hand = s_clock_hand + 1 == KV_CAPACITY ? 0 : s_clock_hand + 1;
+        if (!s_items[item].referenced) {
+            return item;
+        }
+        s_items[item].referenced = false;
+    }
+#endif
+}
+
+void kv_store_init(void) {
+
+    if (s_lock == NULL) {
+        s_lock = xSemaphoreCreateMutexStatic(&s_lock_buffer);
+    }
+    KV_LOCK();
+    memset(s_index, 0, sizeof(s_index));
+    memset(&s_stats, 0, sizeof(s_stats));
+    for (int i = 0; i < KV_CAPACITY; i++) {
+        s_items[i].next = i + 1 < KV_CAPACITY ? i + 1 : KV_NONE;
+    }
+    s_free = 0;
+#if CONFIG_SOCKET_KV_EVICTION_LRU
+    s_lru_head = s_lru_tail = KV_NONE;
+#else
+    s_clock_hand = 0;
+#endif
+    KV_UNLOCK();
+}
+
+bool kv_store_get(const char *key, uint32_t key_len, kv_store_visit_t visit, void *ctx) {
+
+    uint32_t hash = kv_hash(key, key_len);
+
+    KV_LOCK();
+    uint32_t slot = key_len <= KV_MAX_KEY ? kv_find_slot(key, key_len, hash) : KV_NONE;
+    if (slot != KV_NONE) {
+        uint16_t item = s_index[slot] - 1;
+        kv_touch(item);
+        visit(s_items[item].value, s_items[item].value_len, ctx);
+        s_stats.hits++;
+    } else {
+        s_stats.misses++;
+    }
+    KV_UNLOCK();
+
+    return slot != KV_NONE;
+}
+
+bool kv_store_set(const char *key, uint32_t key_len, const ring_buffer_view_t *value) {
+
+    uint32_t value_len = ring_buffer_view_len(value);
+    if (key_len == 0 || key_len > KV_MAX_KEY || value_len > KV_MAX_VALUE) {
+        return false;
+    }
+    uint32_t hash = kv_hash(key, key_len);
+
+    KV_LOCK();
+    uint32_t slot = kv_find_slot(key, key_len, hash);
+    uint16_t item;
+
+    if (slot != KV_NONE) {
+        // Substitui o valor no lugar
+        item = s_index[slot] - 1;
+        kv_touch(item);
+    } else {
+        if (s_free == KV_NONE) {
+            uint16_t victim = kv_pick_victim();
+            kv_item_free(kv_find_slot(s_items[victim].key, s_items[victim].key_len, s_items[victim].hash));
+            s_stats.evictions++;
+        }
+        item = s_free;
+        s_free = s_items[item].next;
+
+        s_items[item].hash = hash;
+        s_items[item].key_len = key_len;
+        memcpy(s_items[item].key, key, key_len);
+#if CONFIG_SOCKET_KV_EVICTION_LRU
+        kv_lru_push_front(item);
+#else
+        // Item novo entra sem o bit: só uma leitura lhe dá a segunda chance
+        s_items[item].referenced = false;
+#endif
+        // Há sempre posição livre: o índice tem o dobro da arena
+        for (slot = hash % KV_INDEX_SIZE; s_index[slot] != 0; slot = kv_slot_next(slot)) {
+        }
+        s_index[slot] = item + 1;
+        s_stats.items++;
+    }
+
+    memcpy(s_items[item].value, value->ptr[0], value->len[0]);
+    memcpy(s_items[item].value + value->len[0], value->ptr[1], value->len[1]);
+    s_items[item].value_len = value_len;
+    KV_UNLOCK();
+
+    return true;
+}
+
+bool kv_store_del(const char *key, uint32_t key_len) {
+
+    uint32_t hash = kv_hash(key, key_len);
+
+    KV_LOCK();
+    uint32_t slot = key_len <= KV_MAX_KEY ? kv_find_slot(key, key_len, hash) : KV_NONE;
+    if (slot != KV_NONE) {
+        kv_item_free(slot);
+    }
+    KV_UNLOCK();
+
+    return slot != KV_NONE;
+}
+
+void kv_store_get_stats(kv_store_stats_t *stats) {
+
+    KV_LOCK();
+    *stats = s_stats;
+    KV_UNLOCK();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ring_buffer.h"
+
+// Cache chave/valor com capacidade fixa: todos os itens em uma arena estática, índice por
+// endereçamento aberto (sondagem linear, remoção por deslocamento - sem lápides) e despejo
+// CLOCK ou LRU quando a arena enche. Um mutex protege tudo: seguro para todos os modos
+// do servidor (tasks por cliente, pool, event loop com shards).
+
+#define KV_CAPACITY                     CONFIG_SOCKET_KV_CAPACITY
+#define KV_MAX_KEY                      CONFIG_SOCKET_KV_MAX_KEY
+#define KV_MAX_VALUE                    CONFIG_SOCKET_KV_MAX_VALUE
+
+typedef struct {
+    uint32_t items;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+} kv_store_stats_t;
+
+// Chamado com o mutex do cache - só deve copiar o valor (value é válido durante a chamada)
+typedef void (*kv_store_visit_t)(const uint8_t *value, uint32_t len, void *ctx);
+
+// Zera o cache
+void kv_store_init(void);
+
+// Procura a chave e entrega o valor ao visit. Retorna false se a chave não existir
+bool kv_store_get(const char *key, uint32_t key_len, kv_store_visit_t visit, void *ctx);
+
+// Grava ou substitui. value é uma visão (até 2 segmentos, ex.: direto do RX ring).
+// Com a arena cheia despeja um item. Retorna false se chave ou valor excederem os limites
+bool kv_store_set(const char *key, uint32_t key_len, const ring_buffer_view_t *value);
+
+// Remove a chave. Retorna false se ela não existir
+bool kv_store_del(const char *key, uint32_t key_len);
+
+void kv_store_get_stats(kv_store_stats_t *stats);
@@ -0,0 +1,76 @@
+#include "esp_log.h"
+#include "async_log.h"
+
+#include "line_scan.h"
+#include "line_framing.h"
+
+// Tags de depuração:
+static const char *TAG_SOCKET = "DEBUG - TCP-SOCKET";
+
+// Function - Offset of the first '\n' at or after from, or the view length if none
+static uint32_t line_framing_find(const ring_buffer_view_t *data, uint32_t from) {
+
+    if (from < data->len[0]) {
+        uint32_t eol = from + line_scan(data->ptr[0] + from, data->len[0] - from);
+        if (eol < data->len[0]) {
+            return eol;
+        }
+        from = data->len[0];
+    }
+    uint32_t offset = from - data->len[0];
+    return data->len[0] + offset + line_scan(data->ptr[1] + offset, data->len[1] - offset);
+}
+
+int32_t line_framing_parse(Struct_Socket_clients *client, const ring_buffer_view_t *data, line_handler_t handler, void *ctx) {
+
+    uint32_t total = ring_buffer_view_len(data);
+    uint32_t consumed = 0;
+    // O início dos dados já foi varrido sem '\n' na chamada anterior - retoma de onde parou
+    uint32_t scan_from = client->line_scanned;
+
+    for (;;) {
+        uint32_t eol = line_framing_find(data, scan_from);
+        if (eol == total) {
+            break;
+        }
+
+        uint32_t line_len = eol - consumed;
+        if (line_len > 0 && ring_buffer_view_at(data, eol - 1) == '\r') {
+            line_len--;
+        }
+        ring_buffer_view_t line;
+        ring_buffer_view_slice(data, consumed, line_len, &line);
+
+        if (!handler(client, &line, ctx)) {
+            client->line_scanned = eol - consumed;
+            return consumed;
+        }
+        consumed = scan_from = eol + 1;
+    }
+
+    if (consumed == 0 && total == CONN_RX_RING_SIZE) {
+        ASYNC_LOGE(TAG_SOCKET, "[CLIENT-%d] Linha maior que o RX ring", client->sock_client);
+        return -1;
+    }
+    client->line_scanned = total - consumed;
+    return consumed;
+}
+
+// Echo de linhas - a linha direto do RX ring, seguida de '\n'
+static bool line_framing_echo_line(Struct_Socket_clients *client, const ring_buffer_view_t *line, void *ctx) {
+
+    if (conn_io_write_space(client) < ring_buffer_view_len(line) + 1) {
+        return false;
+    }
+    conn_io_write_view(client, line);
+    return conn_io_write(client, "\n", 1);
+}
+
+static int32_t line_framing_echo_data(Struct_Socket_clients *client, const ring_buffer_view_t *data, void *ctx) {
+
+    return line_framing_parse(client, data, line_framing_echo_line, NULL);
+}
+
+const conn_handler_t line_framing_echo_handler = {
+    .on_data = line_framing_echo_data,
+};
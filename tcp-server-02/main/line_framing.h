@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "conn_io.h"
+
+// Framing por linhas: cada mensagem termina em '\n' (um '\r' antes dele é descartado).
+// O fim de linha é procurado pelo line_scan (SWAR) e cada linha é entregue como visão do
+// RX ring, sem cópia. Uma linha precisa caber no RX ring.
+
+// Callback da aplicação - line não inclui o terminador, aponta direto para o RX ring e só é
+// válida durante a chamada. Retorna false para deixar a linha no ring e parar o parse.
+typedef bool (*line_handler_t)(Struct_Socket_clients *client, const ring_buffer_view_t *line, void *ctx);
+
+// Entrega cada linha completa de data (visão do on_data) ao handler. Retorna os bytes das
+// linhas aceitas - pronto para ser o retorno do on_data - ou -1 se o RX ring encher sem '\n'
+int32_t line_framing_parse(Struct_Socket_clients *client, const ring_buffer_view_t *data, line_handler_t handler, void *ctx);
+
+// Handler de conexão com framing por linhas - echo de cada linha, terminada em '\n'
+extern const conn_handler_t line_framing_echo_handler;
@@ -0,0 +1,86 @@
+#include <string.h>
+
+// O line_scan_bench compila esta fonte fora do ESP-IDF, sem sdkconfig
+#if __has_include("sdkconfig.h")
+#include "sdkconfig.h"
+#endif
+
+#include "line_scan.h"
+
+_Static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "line_scan assumes a little-endian word layout");
+
+// Palavra da máquina - uma load por passo. LINE_SCAN_WORD força outra largura (o
+// microbenchmark do host compila também a versão de 4 bytes, a mesma do ESP32)
+#ifndef LINE_SCAN_WORD
+#define LINE_SCAN_WORD                  uintptr_t
+#endif
+typedef LINE_SCAN_WORD line_word_t;
+
+#define LINE_WORD_SIZE                  sizeof(line_word_t)
+#define LINE_WORD_ONES                  ((line_word_t)-1 / 0xFF)    // 0x0101...01
+#define LINE_WORD_HIGHS                 (LINE_WORD_ONES * 0x80)     // 0x8080...80
+#define LINE_WORD_NEWLINES              (LINE_WORD_ONES * '\n')     // 0x0A0A...0A
+
+// Bit alto ligado em cada byte zero de x. O empréstimo da subtração só gera falso positivo
+// acima de um zero verdadeiro, então o bit ligado mais baixo é sempre exato
+static inline line_word_t line_word_zero_bytes(line_word_t x) {
+    return (x - LINE_WORD_ONES) & ~x & LINE_WORD_HIGHS;
+}
+
+// Varreduras mais curtas que isto ficam no laço byte a byte: a entrada no memchr ou no SWAR
+// custa mais que a varredura (bench/README.md). A varredura vai até o fim dos dados recebidos,
+// então um comando curto é uma varredura curta
+#define LINE_SCAN_SHORT                 8
+
+uint32_t line_scan_swar(const uint8_t *data, uint32_t len) {
+
+    uint32_t i = 0;
+
+    // Bytes até o alinhamento - o Xtensa não faz load desalinhado
+    while (i < len && ((uintptr_t)(data + i) & (LINE_WORD_SIZE - 1)) != 0) {
+        if (data[i] == '\n') {
+            return i;
+        }
+        i++;
+    }
+
+    for (; i + LINE_WORD_SIZE <= len; i += LINE_WORD_SIZE) {
+        line_word_t word;
+        // memcpy de um ponteiro alinhado vira uma única load, sem violar strict aliasing
+        memcpy(&word, __builtin_assume_aligned(data + i, LINE_WORD_SIZE), LINE_WORD_SIZE);
+        line_word_t found = line_word_zero_bytes(word ^ LINE_WORD_NEWLINES);
+        if (found != 0) {
+            // Little-endian: o byte mais baixo da palavra é o primeiro na memória
+            return i + __builtin_ctzl((unsigned long)found) / 8;
+        }
+    }
+
+    for (; i < len; i++) {
+        if (data[i] == '\n') {
+            return i;
+        }
+    }
+    return len;
+}
+
+#ifndef LINE_SCAN_SWAR_ONLY
+uint32_t line_scan(const uint8_t *data, uint32_t len) {
+
+    if (len < LINE_SCAN_SHORT) {
+        for (uint32_t i = 0; i < len; i++) {
+            if (data[i] == '\n') {
+                return i;
+            }
+        }
+        return len;
+    }
+
+#if CONFIG_SOCKET_LINE_SCAN_SWAR
+    return line_scan_swar(data, len);
+#else
+    // memchr da libc - na glibc é vetorizado e ganha do SWAR a partir de linhas de 32 bytes
+    const uint8_t *eol = memchr(data, '\n', len);
+    return eol != NULL ? (uint32_t)(eol - data) : len;
+#endif
+}
+#endif
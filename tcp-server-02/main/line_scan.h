@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+
+// Procura o primeiro '\n' em data[0, len). Retorna o índice, ou len se não houver.
+// Varredura curta (< 8 bytes) byte a byte, as outras com o memchr da libc - ou com o SWAR,
+// se SOCKET_LINE_SCAN_SWAR. Código C puro - o microbenchmark do host usa a mesma fonte
+uint32_t line_scan(const uint8_t *data, uint32_t len);
+
+// SWAR: testa uma palavra da máquina por passo (4 bytes no ESP32, 8 no host) em vez de um byte
+uint32_t line_scan_swar(const uint8_t *data, uint32_t len);
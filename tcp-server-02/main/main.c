@@ -1,97 +1,165 @@
 #include <string.h>
+#include <stdatomic.h>
 #include <sys/param.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "esp_system.h"
-#include "esp_wifi.h"
-#include "esp_event.h"
 #include "esp_log.h"
-#include "nvs_flash.h"
-#include "esp_netif.h"
 
-#include "lwip/err.h"
-#include "lwip/sockets.h"
-#include "lwip/sys.h"
-#include <lwip/netdb.h>
-
-// Menuconfig - WiFi
-#define EXAMPLE_ESP_WIFI_SSID           CONFIG_ESP_WIFI_SSID
-#define EXAMPLE_ESP_WIFI_PASS           CONFIG_ESP_WIFI_PASSWORD
-#define EXAMPLE_ESP_MAXIMUM_RETRY       CONFIG_ESP_MAXIMUM_RETRY
+#include "async_log.h"
+#include "task_profile.h"
+#include "boot_trace.h"
+#include "init_graph.h"
+
+#include "tcp_server.h"
+#include "conn_io.h"
+#include "connectivity.h"
+#if CONFIG_SOCKET_PUBSUB
+#include "pubsub.h"
+#elif CONFIG_SOCKET_FRAMING_LENGTH_PREFIX
+#include "framing.h"
+#elif CONFIG_SOCKET_KV_CACHE
+#include "kv_store.h"
+#include "kv_proto.h"
+#elif CONFIG_SOCKET_FRAMING_LINE
+#include "line_framing.h"
+#endif
+#if CONFIG_SOCKET_UDP_LISTENER
+#include "udp_server.h"
+#endif
 
 // Menuconfig - Socket
 #define EXAMPLE_ESP_SOCKET_PORT         CONFIG_ESP_SOCKET_PORT
-#define EXAMPLE_KEEPALIVE_IDLE          CONFIG_KEEPALIVE_IDLE 
-#define EXAMPLE_KEEPALIVE_INTERVAL      CONFIG_KEEPALIVE_INTERVAL
-#define EXAMPLE_KEEPALIVE_COUNT         CONFIG_KEEPALIVE_COUNT
+
+// Protocolo escolhido no menuconfig - o mesmo em todos os listeners
+#if CONFIG_SOCKET_PUBSUB
+#define SOCKET_HANDLER                  pubsub_handler
+#elif CONFIG_SOCKET_FRAMING_LENGTH_PREFIX
+#define SOCKET_HANDLER                  framing_echo_handler
+#elif CONFIG_SOCKET_KV_CACHE
+#define SOCKET_HANDLER                  kv_proto_handler
+#elif CONFIG_SOCKET_FRAMING_LINE
+#define SOCKET_HANDLER                  line_framing_echo_handler
+#else
+#define SOCKET_HANDLER                  conn_io_echo_handler
+#endif
 
 // Tags de depuração:
-static const char *TAG_WIFI_STA = "DEBUG - WIFI-STA";
 static const char *TAG_SOCKET = "DEBUG - TCP-SOCKET";
 
-// Grupos de Eventos:
-static EventGroupHandle_t s_wifi_event_group;
-
-#define WIFI_CONNECTED_BIT          BIT0
-#define WIFI_FAIL_BIT               BIT1
+// Tabela de conexões - dona do estado de cada cliente durante toda a conexão
+static conn_table_t s_conn_table;
+
+// Listener do servidor - o protocolo escolhido no menuconfig sobre o mesmo núcleo de I/O
+static const conn_listener_t s_listener = {
+    .port = EXAMPLE_ESP_SOCKET_PORT,
+    .handler = &SOCKET_HANDLER,
+    .write_policy = CONN_WRITE_POLICY_DEFAULT,
+};
+
+#if CONFIG_SOCKET_UDP_LISTENER
+// Listener UDP - mesmo handler, sessões por par (IP, porta) em vez de conexões.
+// A política de escrita não se aplica: cada flush vira datagramas na hora
+static const conn_listener_t s_udp_listener = {
+    .port = CONFIG_SOCKET_UDP_PORT,
+    .handler = &SOCKET_HANDLER,
+    .write_policy = CONN_WRITE_LATENCY,
+};
+#endif
+
+// Function - Wait until the socket has data to read or timeout_ms expires
+static bool socket_wait_readable(int sock, uint32_t timeout_ms) {
+
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET(sock, &read_fds);
+    struct timeval timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+    return select(sock + 1, &read_fds, NULL, NULL, &timeout) > 0;
+}
 
-// Struct socket clients
-typedef struct {
-    struct sockaddr_in client_addr;
-    socklen_t client_addr_len;
-    int sock_client;
-}Struct_Socket_clients;
+// Function - Serve a connected client until it disconnects
+void socket_client_serve(Struct_Socket_clients *client) {
 
-// Task - Manager clients connect
-void task_socket_client_handle(void* pvParameters) {
+    // Keepalive e timeouts configurados uma única vez no accept() (conn_io_configure_socket)
+    bool accepted = conn_io_open(client, &s_listener);
 
-    Struct_Socket_clients Struct_Socket_client_x = *(Struct_Socket_clients*)pvParameters;
+    while (accepted) {
 
-    char rx_buffer[128];
-    int keepAlive = 1;
-    int keepIdle = EXAMPLE_KEEPALIVE_IDLE;
-    int keepInterval = EXAMPLE_KEEPALIVE_INTERVAL;
-    int keepCount = EXAMPLE_KEEPALIVE_COUNT;
+        // RX ring cheio - backpressure: não há onde ler, a passada só processa o que já está no ring
+        // e esvazia o TX, e o recv volta quando o handler consumir
+        bool rx_full = ring_buffer_free(&client->rx) == 0;
+        uint32_t tx_count = conn_io_tx_count(client);
 
-    for (;;) {
-        
-        // Set tcp keepalive option
-        setsockopt(Struct_Socket_client_x.sock_client, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(int));
-        setsockopt(Struct_Socket_client_x.sock_client, IPPROTO_TCP, TCP_KEEPIDLE, &keepIdle, sizeof(int));
-        setsockopt(Struct_Socket_client_x.sock_client, IPPROTO_TCP, TCP_KEEPINTVL, &keepInterval, sizeof(int));
-        setsockopt(Struct_Socket_client_x.sock_client, IPPROTO_TCP, TCP_KEEPCNT, &keepCount, sizeof(int));
+        // receive data on the connected socket - SO_RCVTIMEO vencido encerra o cliente inativo
+        if (!rx_full) {
+            conn_io_status_t recv_status = conn_io_recv(client);
+            if (recv_status == CONN_IO_WOULD_BLOCK) {
+                ASYNC_LOGW(TAG_SOCKET, "[CLIENT-%d] Timeout de inatividade", client->sock_client);
+            }
+            if (recv_status != CONN_IO_OK) {
+                break;
+            }
+        }
 
-        // receive data on the connected socket
-        int len = recv(Struct_Socket_client_x.sock_client, rx_buffer, sizeof(rx_buffer) - 1, 0);
+        // Handler do protocolo - socket bloqueante: o flush só retorna com o TX ring vazio.
+        // Repete enquanto houver progresso; um frame incompleto espera o próximo recv
+        conn_io_status_t status;
+        uint32_t rx_pending;
+        do {
+            rx_pending = ring_buffer_used(&client->rx);
+            status = conn_io_process(client);
+            if (status == CONN_IO_OK) {
+                status = conn_io_flush(client);
+            }
+        } while (status == CONN_IO_OK && !ring_buffer_is_empty(&client->rx) && ring_buffer_used(&client->rx) < rx_pending);
+
+        // Política throughput - dados retidos esperam mais comandos até o prazo de flush;
+        // sem nada chegando no prazo, o flush envia o que ficou retido. Com o RX ring cheio nada
+        // novo tem onde entrar - só o prazo libera o TX
+        while (status == CONN_IO_OK && conn_io_tx_held(client)) {
+            uint32_t delay_ms = conn_io_flush_delay_ms(client);
+            if (ring_buffer_free(&client->rx) == 0) {
+                vTaskDelay(pdMS_TO_TICKS(delay_ms));
+            } else if (socket_wait_readable(client->sock_client, delay_ms)) {
+                break;
+            }
+            status = conn_io_flush(client);
+        }
 
-        if (len < 0) {
-            ESP_LOGE(TAG_SOCKET, "[CLIENT-%d] Recv falhou: errno %d",Struct_Socket_client_x.sock_client, errno);
+        if (status == CONN_IO_WOULD_BLOCK) {
+            ASYNC_LOGW(TAG_SOCKET, "[CLIENT-%d] Timeout de escrita", client->sock_client);
+        }
+        if (status != CONN_IO_OK) {
             break;
-        } else
+        }
 
-        if (len == 0) {
-            ESP_LOGI(TAG_SOCKET, "[CLIENT-%d] Conexão fechada", Struct_Socket_client_x.sock_client);
+        // Passada de backpressure sem progresso - RX ainda cheio e nada enviado: o handler não
+        // consome o ring nem com o TX vazio, esperar não muda nada
+        if (rx_full && ring_buffer_free(&client->rx) == 0 && conn_io_tx_count(client) == tx_count) {
+            ASYNC_LOGE(TAG_SOCKET, "[CLIENT-%d] RX ring cheio sem progresso do handler", client->sock_client);
             break;
-        } 
-        
-        else {
-            rx_buffer[len] = 0; // Null-terminate buffer
-            ESP_LOGI(TAG_SOCKET, "[CLIENT-%d] Recebidos [%d bytes] : %s",Struct_Socket_client_x.sock_client , len, rx_buffer);
-
-            // Echo back to sender
-            int err = send(Struct_Socket_client_x.sock_client, rx_buffer, len, 0);
-            if (err < 0) {
-                ESP_LOGE(TAG_SOCKET, "[CLIENT-%d] Send falhou: errno %d", Struct_Socket_client_x.sock_client, errno);
-                break;
-            }
         }
     }
+    conn_io_close(client);
 
-    if (Struct_Socket_client_x.sock_client != -1)
+    if (client->sock_client != -1)
     {
-        ESP_LOGE(TAG_WIFI_STA, "2- Shutting down socket and restarting...");
-        shutdown(Struct_Socket_client_x.sock_client, 0);
-        close(Struct_Socket_client_x.sock_client);
+        ASYNC_LOGE(TAG_SOCKET, "2- Shutting down socket and restarting...");
+        shutdown(client->sock_client, 0);
+        close(client->sock_client);
+    }
+}
+
+// Task - Manager clients connect
+void task_socket_client_handle(void* pvParameters) {
+
+    Struct_Socket_clients *Struct_Socket_client_x = conn_table_get(&s_conn_table, (conn_handle_t)(uintptr_t)pvParameters);
+
+    if (Struct_Socket_client_x != NULL) {
+        socket_client_serve(Struct_Socket_client_x);
+        conn_table_release(&s_conn_table, Struct_Socket_client_x);
     }
     vTaskDelete(NULL);
     
@@ -100,16 +168,15 @@ void task_socket_client_handle(void* pvParameters) {
 // Task = Socket TCP/IP Server
 void task_tcp_server(void* pvParametres) {
 
-    char addr_str[128];
-
-    int socket_fammily = (int)pvParametres;
+    int socket_fammily = (int)(intptr_t)pvParametres;
     int socket_type = SOCK_STREAM;
     int socket_protocol = IPPROTO_TCP;
 
     // Creating a socket
     int socket_01 = socket(socket_fammily, socket_type, socket_protocol);
     if (socket_01 == -1) {
-        ESP_LOGE(TAG_SOCKET, "Não foi possível criar o Socket: errno %d", errno);
+        ASYNC_LOGE(TAG_SOCKET, "Não foi possível criar o Socket: errno %d", errno);
+        tcp_server_listen_done(ESP_FAIL);
         vTaskDelete(NULL);
         return;
     }
@@ -120,22 +187,23 @@ void task_tcp_server(void* pvParametres) {
     setsockopt(socket_01, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
 
     // Log - Debug
-    ESP_LOGI(TAG_SOCKET, "Socket criado");
+    ASYNC_LOGI(TAG_SOCKET, "Socket criado");
 
     int err;
     
     struct sockaddr_in socket_adr = {
         .sin_addr.s_addr = htonl(INADDR_ANY),
         .sin_family = socket_fammily,
-        .sin_port = htons(EXAMPLE_ESP_SOCKET_PORT)
+        .sin_port = htons(s_listener.port)
     };
     
     // Binding a Server Socket
     err = bind(socket_01, (struct sockaddr *)&socket_adr, sizeof(socket_adr));
     if (err != 0) {
-        ESP_LOGE(TAG_SOCKET, "Socket incapaz de vincular: %d", errno);
-        ESP_LOGE(TAG_SOCKET, "IPPROTO: %d", socket_fammily);
+        ASYNC_LOGE(TAG_SOCKET, "Socket incapaz de vincular: %d", errno);
+        ASYNC_LOGE(TAG_SOCKET, "IPPROTO: %d", socket_fammily);
         close(socket_01);
+        tcp_server_listen_done(ESP_FAIL);
         vTaskDelete(NULL);
         return;
     }
@@ -143,165 +211,246 @@ void task_tcp_server(void* pvParametres) {
     // Listening for Connections
     err = listen(socket_01, 3); 
     if (err != 0){
-        ESP_LOGE(TAG_SOCKET, "Ocorreu um erro durante a escuta: errno %d", errno);
+        ASYNC_LOGE(TAG_SOCKET, "Ocorreu um erro durante a escuta: errno %d", errno);
         close(socket_01);
+        tcp_server_listen_done(ESP_FAIL);
         vTaskDelete(NULL);
         return;
     }
 
-    ESP_LOGI(TAG_SOCKET, "Escutando na porta %d", EXAMPLE_ESP_SOCKET_PORT);
+    ASYNC_LOGI(TAG_SOCKET, "Escutando na porta %d", s_listener.port);
+
+    // Linha do tempo do boot e estágio dos listeners - o listen já aceita conexões, com ou sem IP
+    boot_trace_mark(BOOT_TRACE_LISTEN);
+    tcp_server_listen_done(ESP_OK);
 
+#if !CONFIG_SOCKET_SERVER_MODE_EVENT_LOOP
+    conn_table_init(&s_conn_table);
+#endif
+
+#if CONFIG_SOCKET_SERVER_MODE_WORKER_POOL
+    tcp_worker_pool_init(&s_conn_table);
+#endif
+
+#if CONFIG_SOCKET_SERVER_MODE_EVENT_LOOP
+    // Event loop - uma única task multiplexa todos os clientes
+    tcp_event_loop_run(socket_01, &s_listener);
+#else
     for(;;) {
-        Struct_Socket_clients Struct_Socket_client_x;
-        Struct_Socket_client_x.client_addr_len = sizeof(Struct_Socket_client_x.client_addr);
-        
-        Struct_Socket_client_x.sock_client = accept(socket_01, (struct sockaddr *)&Struct_Socket_client_x.client_addr, &Struct_Socket_client_x.client_addr_len);
-        if (Struct_Socket_client_x.sock_client < 0) {
-            ESP_LOGE(TAG_SOCKET, "Não foi possível aceitar a conexão: errno %d", errno);
+        struct sockaddr_in client_addr;
+        socklen_t client_addr_len = sizeof(client_addr);
+
+        int sock_client = accept(socket_01, (struct sockaddr *)&client_addr, &client_addr_len);
+        if (sock_client < 0) {
+            ASYNC_LOGE(TAG_SOCKET, "Não foi possível aceitar a conexão: errno %d", errno);
             break;
         }
 
-        // Convert ip addres to string
-        if (Struct_Socket_client_x.client_addr.sin_family == PF_INET) {
-            inet_ntoa_r(((struct sockaddr_in *)&Struct_Socket_client_x.client_addr)->sin_addr, addr_str, sizeof(addr_str) - 1);
+        // Admissão - reserva uma posição na tabela de conexões (limite global e por IP)
+        conn_admit_t admit;
+        Struct_Socket_clients *Struct_Socket_client_x = conn_table_alloc(&s_conn_table, &client_addr, &admit);
+        if (Struct_Socket_client_x == NULL) {
+            ASYNC_LOGW(TAG_SOCKET, "[CLIENT-%d] %s, conexão recusada", sock_client,
+                       admit == CONN_ADMIT_IP_LIMIT ? "Limite de conexões por IP atingido" : "Tabela de conexões cheia");
+            close(sock_client);
+            continue;
+        }
+        Struct_Socket_client_x->client_addr_len = client_addr_len;
+        Struct_Socket_client_x->sock_client = sock_client;
+        conn_io_configure_socket(sock_client);
+
+        // Log - Debug (IP como inteiros - o log assíncrono não pode guardar ponteiro para a stack)
+        uint32_t ip = ntohl(Struct_Socket_client_x->client_addr.sin_addr.s_addr);
+        ASYNC_LOGI(TAG_SOCKET, "[CLIENT-%d] Endereço IP aceito pelo Socket: %d.%d.%d.%d", Struct_Socket_client_x->sock_client,
+                   (int)(ip >> 24), (int)((ip >> 16) & 0xFF), (int)((ip >> 8) & 0xFF), (int)(ip & 0xFF));
+
+        conn_handle_t handle = conn_table_handle(Struct_Socket_client_x);
+
+#if CONFIG_SOCKET_SERVER_MODE_WORKER_POOL
+        // Pool de workers - recusa a conexão se a fila estiver cheia
+        if (!tcp_worker_pool_dispatch(handle)) {
+            ASYNC_LOGW(TAG_SOCKET, "[CLIENT-%d] Todos os workers ocupados, conexão recusada", sock_client);
+            close(sock_client);
+            conn_table_release(&s_conn_table, Struct_Socket_client_x);
         }
-        // Log - Debug
-        ESP_LOGI(TAG_SOCKET, "[CLIENT-%d] Endereço IP aceito pelo Socket: %s",Struct_Socket_client_x.sock_client, addr_str);
-        
-        // Task multclientes
-        xTaskCreate(task_socket_client_handle, "socket_client_handle", 4096, &Struct_Socket_client_x, 5, NULL);
+#else
+        // Task multclientes - recebe o handle, nunca um ponteiro para a stack
+        if (task_profile_create(task_socket_client_handle, "socket_client_handle", TCP_SERVER_TASK_STACK, (void*)(uintptr_t)handle,
+                                TASK_PROFILE_ROLE_CLIENT, NULL) != pdPASS) {
+            ASYNC_LOGE(TAG_SOCKET, "[CLIENT-%d] Não foi possível criar a task do cliente", sock_client);
+            close(sock_client);
+            conn_table_release(&s_conn_table, Struct_Socket_client_x);
+        }
+#endif
     }
+#endif
 
     // Task error
     if (socket_01 != -1) {
-        ESP_LOGE(TAG_SOCKET, "1 - Desligando o soquete e reiniciando...");
+        ASYNC_LOGE(TAG_SOCKET, "1 - Desligando o soquete e reiniciando...");
         shutdown(socket_01, 0);
         close(socket_01);
     }
     vTaskDelete(NULL);
 }
 
-// Function - Event handlers
-void event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
-    
-    int s_retry_num = (int) arg;
-
-    // Event - STA Start
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        esp_wifi_connect();
-    } else 
-
-    // Event - Wifi disconnected
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        if (s_retry_num < EXAMPLE_ESP_MAXIMUM_RETRY) {
-            esp_wifi_connect();
-            s_retry_num++;
-            ESP_LOGI(TAG_WIFI_STA, " Repetindo conexão com o AP...");
-        } else {
-            xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
-        }
-    } else 
-
-    // Event - Got-ip
-    if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
-        ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
-        ESP_LOGI(TAG_WIFI_STA, "IP recebido - " IPSTR, IP2STR(&event->ip_info.ip));
-        s_retry_num = 0;
-        xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
-    }    
+// App main
+// Orquestrador de inicialização - cada estágio sobe assim que as dependências terminam.
+// Os listeners fazem bind sem esperar o IP (INADDR_ANY) e o Wi-Fi associa em paralelo
+enum {
+    STAGE_NVS,
+    STAGE_STACK,
+#if CONFIG_SOCKET_KV_CACHE
+    STAGE_KV,
+#endif
+    STAGE_LISTENERS,
+    STAGE_WIFI,
+    STAGE_COUNT,
+};
+
+#if CONFIG_SOCKET_KV_CACHE
+#define STAGE_KV_BIT                    INIT_STAGE_BIT(STAGE_KV)
+#else
+#define STAGE_KV_BIT                    0
+#endif
+
+// Listeners que fecham o estágio - o TCP e, se habilitado, o UDP
+#if CONFIG_SOCKET_UDP_LISTENER
+#define STAGE_LISTENERS_COUNT           2
+#else
+#define STAGE_LISTENERS_COUNT           1
+#endif
+
+static init_stage_id_t s_stage_listeners;
+static atomic_int s_listeners_pending;          // Listeners que ainda não avisaram o listen
+static init_stage_id_t s_stage_wifi;
+
+// O estágio fecha no último listen ou no primeiro erro - o aviso que chega depois é ignorado pelo grafo
+static void listeners_done(esp_err_t err) {
+
+    if (err != ESP_OK || atomic_fetch_sub(&s_listeners_pending, 1) == 1) {
+        init_graph_complete(s_stage_listeners, err);
+    }
 }
 
-// Function - Started Wifi-STA
-void init_wifi_sta(void) {
-
-    static int s_retry_num = 0;
-
-    // Creates default WIFI STA. In case of any init error this API aborts.
-    esp_netif_create_default_wifi_sta();
-
-    // Initialize WiFi
-    wifi_init_config_t cfg_init_wifi = WIFI_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_wifi_init(&cfg_init_wifi));
-
-    // Register an instance of event handler to the default loop.
-    esp_event_handler_instance_t instance_any_id;
-    esp_event_handler_instance_t instance_got_ip;
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
-                                                        ESP_EVENT_ANY_ID,
-                                                        &event_handler,
-                                                        &s_retry_num,
-                                                        &instance_any_id));
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT,
-                                                        IP_EVENT_STA_GOT_IP,
-                                                        &event_handler,
-                                                        &s_retry_num,
-                                                        &instance_got_ip));
-
-    // Configuration data for device sta
-    wifi_config_t wifi_cfg = {
-        .sta = {
-            .ssid = EXAMPLE_ESP_WIFI_SSID,
-            .password = EXAMPLE_ESP_WIFI_PASS,
-        },
-    };
+void tcp_server_listen_done(esp_err_t err) {
+
+    listeners_done(err);
+}
 
-    // Set the WiFi operating mode - WIFI_MODE_STA
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+#if CONFIG_SOCKET_UDP_LISTENER
+void udp_server_listen_done(esp_err_t err) {
 
-    // Set the configuration of the STA
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_cfg));
+    listeners_done(err);
+}
+#endif
 
-    // Start WiFi
-    ESP_ERROR_CHECK(esp_wifi_start());
+static esp_err_t stage_nvs(init_stage_id_t id, void *arg) {
 
-    // Log - Debug
-    ESP_LOGI(TAG_WIFI_STA, "Inicializado!");
-
-    // Wait s_wifi_event_group
-    EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group,
-                                            WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
-                                            pdFALSE,
-                                            pdFALSE,
-                                            portMAX_DELAY);
-
-    if(bits & WIFI_CONNECTED_BIT) {
-        ESP_LOGI(TAG_WIFI_STA, "Conectado no ap  - ssid:%s, password:%s", EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
-    } else
-
-    if (bits & WIFI_FAIL_BIT) {
-        ESP_LOGI(TAG_WIFI_STA, "Falha ao conecta no ap -  ssid:%s, password:%s", EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
-    } else {
-        ESP_LOGE(TAG_WIFI_STA, "Evento inesperado!");
+    return connectivity_init_nvs();
+}
+
+static esp_err_t stage_stack(init_stage_id_t id, void *arg) {
+
+    return connectivity_init_stack();
+}
+
+#if CONFIG_SOCKET_KV_CACHE
+static esp_err_t stage_kv(init_stage_id_t id, void *arg) {
+
+    // Cache chave/valor - arena estática, zerada antes do primeiro cliente
+    kv_store_init();
+    return ESP_OK;
+}
+#endif
+
+// Cria as tasks do servidor - o estágio fecha no listen TCP (tcp_server_listen_done) e no bind UDP
+// (udp_server_listen_done)
+static esp_err_t stage_listeners(init_stage_id_t id, void *arg) {
+
+    BaseType_t created;
+
+    s_stage_listeners = id;
+    atomic_store(&s_listeners_pending, STAGE_LISTENERS_COUNT);
+
+#if CONFIG_SOCKET_SERVER_MODE_NETCONN
+    // Netconn - pbufs do lwIP por referência, sem a camada de sockets BSD
+    created = task_profile_create(task_tcp_netconn_server, "tcp_server", TCP_SERVER_TASK_STACK, NULL, TASK_PROFILE_ROLE_SERVER, NULL);
+#elif CONFIG_SOCKET_EVENT_LOOP_SHARDED
+    // Shards - a task do servidor vira o event loop do shard 0, fixo no primeiro core do perfil
+    created = xTaskCreatePinnedToCore(task_tcp_server, "tcp_server", TCP_SERVER_TASK_STACK, (void*) PF_INET,
+                                      task_profile_get(TASK_PROFILE_ROLE_EVENT_LOOP)->priority, NULL,
+                                      task_profile_core(TASK_PROFILE_ROLE_EVENT_LOOP, 0));
+#elif CONFIG_SOCKET_SERVER_MODE_EVENT_LOOP
+    // Event loop - a task do servidor é o próprio loop
+    created = task_profile_create(task_tcp_server, "tcp_server", TCP_SERVER_TASK_STACK, (void*) PF_INET, TASK_PROFILE_ROLE_EVENT_LOOP, NULL);
+#else
+    created = task_profile_create(task_tcp_server, "tcp_server", TCP_SERVER_TASK_STACK, (void*) PF_INET, TASK_PROFILE_ROLE_SERVER, NULL);
+#endif
+    if (created != pdPASS) {
+        return ESP_ERR_NO_MEM;
     }
 
+#if CONFIG_SOCKET_UDP_LISTENER
+    // UDP - task própria com o seu loop, ao lado do servidor TCP
+    // O servidor TCP já roda, mas o estágio fecha com erro aqui - o listen que chega depois é ignorado
+    if (task_profile_create(task_udp_server, "udp_server", TCP_SERVER_TASK_STACK, (void*)&s_udp_listener, TASK_PROFILE_ROLE_EVENT_LOOP, NULL) != pdPASS) {
+        ASYNC_LOGE(TAG_SOCKET, "Não foi possível criar a task do servidor UDP");
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+    return INIT_STAGE_PENDING;
 }
 
-// App main
-void app_main(void) {
+// Primeiro IP ou fim da fase rápida de tentativas
+static void stage_wifi_done(esp_err_t err) {
 
-    // Initialize the default NVS partition
-    esp_err_t err = nvs_flash_init();
-    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NOT_FOUND)
-    {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        err = nvs_flash_init();
+    init_graph_complete(s_stage_wifi, err);
+}
+
+// Sobe a rede - Wi-Fi STA no ESP32, rede do host na build linux. Não espera o IP
+static esp_err_t stage_wifi(init_stage_id_t id, void *arg) {
+
+    s_stage_wifi = id;
+    esp_err_t err = connectivity_connect(stage_wifi_done);
+    return err == ESP_OK ? INIT_STAGE_PENDING : err;
+}
+
+static const init_stage_t s_boot_stages[STAGE_COUNT] = {
+    [STAGE_NVS] = { .name = "nvs", .run = stage_nvs },
+    [STAGE_STACK] = { .name = "tcpip", .run = stage_stack },
+#if CONFIG_SOCKET_KV_CACHE
+    [STAGE_KV] = { .name = "kv", .run = stage_kv },
+#endif
+    [STAGE_LISTENERS] = { .name = "listeners", .run = stage_listeners, .after = INIT_STAGE_BIT(STAGE_STACK) | STAGE_KV_BIT },
+    [STAGE_WIFI] = { .name = "wifi", .run = stage_wifi, .after = INIT_STAGE_BIT(STAGE_NVS) | INIT_STAGE_BIT(STAGE_STACK) },
+};
+
+// Fim do grafo (task do pool) - o servidor já escuta; sem rede o wifi_manager segue tentando
+static void boot_done(uint32_t failed, void *ctx) {
+
+    if (failed & INIT_STAGE_BIT(STAGE_WIFI)) {
+        ASYNC_LOGW(TAG_SOCKET, "Rede indisponível - o servidor segue e o Wi-Fi continua tentando");
+    }
+    if (failed & INIT_STAGE_BIT(STAGE_LISTENERS)) {
+        ASYNC_LOGE(TAG_SOCKET, "Servidor não subiu");
     }
-    ESP_ERROR_CHECK(err);
 
-    // Criando event-groups
-    s_wifi_event_group = xEventGroupCreate();
+    // Linha do tempo do boot - fecha com a rede e os listeners prontos
+    boot_trace_print();
+}
 
-    // Initialize the underlying TCP/IP stack
-    ESP_ERROR_CHECK(esp_netif_init());
+void app_main(void) {
 
-    // Create default event loop
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    // Linha do tempo do boot - marca o início do app_main e abre o registro na memória RTC
+    boot_trace_start();
 
-    // Log - Debug
-    ESP_LOGI(TAG_WIFI_STA, "Iniciando WiFi em modo estação");
+    // Log assíncrono - tira a escrita na UART do caminho dos dados
+    async_log_init();
 
-    // Initialize wifi-sta
-    init_wifi_sta();
+    // Core e prioridade de cada task vêm do perfil escolhido no menuconfig
+    task_profile_log();
 
-    xTaskCreate(task_tcp_server, "tcp_server", 4096, (void*) PF_INET, 5, NULL);
-}
\ No newline at end of file
+    // Estágios em paralelo - o app_main retorna sem esperar a rede
+    ESP_ERROR_CHECK(init_graph_start(s_boot_stages, STAGE_COUNT, boot_done, NULL));
+}
@@ -0,0 +1,73 @@
+#include <stddef.h>
+
+#include "msg_pool.h"
+
+_Static_assert(MSG_BUF_SIZE <= UINT16_MAX, "SOCKET_FRAME_MAX_PAYLOAD must fit msg_buf_t.len");
+_Static_assert(MSG_POOL_LEN <= UINT16_MAX, "SOCKET_PUBSUB_MSG_POOL too large");
+
+static msg_buf_t s_pool[MSG_POOL_LEN];
+static msg_buf_t *s_free[MSG_POOL_LEN];
+static int s_free_top;
+
+void msg_pool_init(void) {
+
+    for (int i = 0; i < MSG_POOL_LEN; i++) {
+        s_free[i] = &s_pool[i];
+    }
+    s_free_top = MSG_POOL_LEN;
+}
+
+msg_buf_t *msg_pool_alloc(void) {
+
+    if (s_free_top == 0) {
+        return NULL;
+    }
+
+    msg_buf_t *msg = s_free[--s_free_top];
+    msg->refs = 1;
+    msg->len = 0;
+    return msg;
+}
+
+void msg_pool_unref(msg_buf_t *msg) {
+
+    if (--msg->refs == 0) {
+        s_free[s_free_top++] = msg;
+    }
+}
+
+int msg_pool_free_count(void) {
+
+    return s_free_top;
+}
+
+bool msg_outbox_push(msg_outbox_t *outbox, msg_buf_t *msg) {
+
+    if (msg_outbox_is_full(outbox)) {
+        return false;
+    }
+    msg_pool_ref(msg);
+    outbox->slots[outbox->head++ % MSG_OUTBOX_LEN] = msg;
+    return true;
+}
+
+void msg_outbox_advance(msg_outbox_t *outbox, uint32_t len) {
+
+    msg_buf_t *msg = msg_outbox_peek(outbox);
+
+    outbox->offset += len;
+    outbox->sent += len;
+    if (outbox->offset == msg->len) {
+        outbox->offset = 0;
+        outbox->tail++;
+        msg_pool_unref(msg);
+    }
+}
+
+void msg_outbox_clear(msg_outbox_t *outbox) {
+
+    while (!msg_outbox_is_empty(outbox)) {
+        msg_pool_unref(outbox->slots[outbox->tail++ % MSG_OUTBOX_LEN]);
+    }
+    outbox->offset = 0;
+}
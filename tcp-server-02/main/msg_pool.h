@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Mensagens com contagem de referências: o frame é montado uma vez e cada destinatário
+// guarda só um ponteiro na sua fila de saída (outbox). O buffer volta ao pool quando o
+// último destinatário termina de enviar. Usado apenas pela task do event loop (sem locks)
+
+// Frame completo: cabeçalho (até 5 bytes) + payload máximo
+#define MSG_BUF_SIZE                    (5 + CONFIG_SOCKET_FRAME_MAX_PAYLOAD)
+#define MSG_POOL_LEN                    CONFIG_SOCKET_PUBSUB_MSG_POOL
+#define MSG_OUTBOX_LEN                  CONFIG_SOCKET_PUBSUB_OUTBOX_LEN
+
+typedef struct {
+    uint16_t refs;
+    uint16_t len;
+    uint8_t data[MSG_BUF_SIZE];
+} msg_buf_t;
+
+// Fila de saída de uma conexão - referências, nunca cópias. head e tail são contadores livres
+typedef struct {
+    msg_buf_t *slots[MSG_OUTBOX_LEN];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t offset;        // Bytes já enviados da mensagem em tail
+    uint32_t sent;          // Total de bytes enviados (progresso para o timer de escrita)
+} msg_outbox_t;
+
+// Coloca todos os buffers no pool
+void msg_pool_init(void);
+
+// Reserva um buffer com uma referência. Retorna NULL se o pool estiver vazio
+msg_buf_t *msg_pool_alloc(void);
+
+static inline void msg_pool_ref(msg_buf_t *msg) {
+    msg->refs++;
+}
+
+// Solta uma referência - a última devolve o buffer ao pool
+void msg_pool_unref(msg_buf_t *msg);
+
+// Buffers livres no pool
+int msg_pool_free_count(void);
+
+static inline void msg_outbox_init(msg_outbox_t *outbox) {
+    outbox->head = outbox->tail = 0;
+    outbox->offset = 0;
+}
+
+static inline bool msg_outbox_is_empty(const msg_outbox_t *outbox) {
+    return outbox->head == outbox->tail;
+}
+
+static inline bool msg_outbox_is_full(const msg_outbox_t *outbox) {
+    return outbox->head - outbox->tail == MSG_OUTBOX_LEN;
+}
+
+// Mensagem em envio (outbox não vazio)
+static inline msg_buf_t *msg_outbox_peek(const msg_outbox_t *outbox) {
+    return outbox->slots[outbox->tail % MSG_OUTBOX_LEN];
+}
+
+// Enfileira uma nova referência à mensagem. Retorna false com o outbox cheio
+bool msg_outbox_push(msg_outbox_t *outbox, msg_buf_t *msg);
+
+// Registra len bytes enviados da mensagem em tail; solta a referência quando ela termina
+void msg_outbox_advance(msg_outbox_t *outbox, uint32_t len);
+
+// Solta todas as referências (conexão encerrada)
+void msg_outbox_clear(msg_outbox_t *outbox);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Prontidão de sockets no estilo epoll - a task de atendimento só toca os sockets com trabalho.
+//   ESP32: callback de eventos do netconn do lwIP -> fila do FreeRTOS (net_ready_lwip.c)
+//   Build linux: epoll do kernel (net_ready_epoll.c)
+//
+// Disparo por borda: um evento chega quando o estado do socket muda (dados novos, espaço no
+// envio, erro). Quem atende deve ler/escrever até EAGAIN, senão não há novo aviso.
+// Cada socket aparece no máximo uma vez na fila, então o custo por evento não depende do
+// número de conexões. Cada instância pertence a uma task (ex.: um shard do event loop); um
+// socket só pode estar em uma instância.
+
+#define NET_READY_READ                  (1 << 0)
+#define NET_READY_WRITE                 (1 << 1)
+#define NET_READY_ERROR                 (1 << 2)
+
+#define NET_READY_WAIT_FOREVER          UINT32_MAX
+
+// Instâncias disponíveis - uma por shard do event loop
+#if CONFIG_SOCKET_EVENT_LOOP_SHARDED
+#define NET_READY_MAX_INSTANCES         CONFIG_SOCKET_EVENT_LOOP_SHARDS
+#else
+#define NET_READY_MAX_INSTANCES         1
+#endif
+
+typedef struct net_ready net_ready_t;
+
+typedef struct {
+    uint32_t id;        // Identificador informado em net_ready_watch
+    uint8_t events;     // NET_READY_READ | NET_READY_WRITE | NET_READY_ERROR
+} net_ready_event_t;
+
+// Cria uma instância (fila ou epoll, sem alocação dinâmica). notify_id é o id entregue
+// pelos eventos de net_ready_notify. Retorna NULL se não houver instância livre
+net_ready_t *net_ready_create(uint32_t notify_id);
+
+// Passa a observar o socket. Gera um evento inicial de leitura e escrita, já que dados
+// podem ter chegado antes do watch
+esp_err_t net_ready_watch(net_ready_t *ready, int sock, uint32_t id);
+
+// Para de observar o socket - chamar antes do close()
+void net_ready_unwatch(net_ready_t *ready, int sock);
+
+// Acorda a task dona da instância com um evento notify_id (pode ser chamado de outra task).
+// Várias notificações antes do wait viram um único evento
+void net_ready_notify(net_ready_t *ready);
+
+// Espera até timeout_ms por sockets prontos. Retorna quantos eventos foram escritos (0 = timeout)
+int net_ready_wait(net_ready_t *ready, net_ready_event_t *events, int max_events, uint32_t timeout_ms);
@@ -0,0 +1,113 @@
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "esp_log.h"
+#include "async_log.h"
+
+#include "net_ready.h"
+
+// Tags de depuração:
+static const char *TAG_NET_READY = "DEBUG - NET-READY";
+
+struct net_ready {
+    int epoll_fd;
+    int notify_fd;      // eventfd registrado com o notify_id
+    uint32_t notify_id;
+};
+
+static net_ready_t s_instances[NET_READY_MAX_INSTANCES];
+static int s_instance_count;
+
+net_ready_t *net_ready_create(uint32_t notify_id) {
+
+    if (s_instance_count >= NET_READY_MAX_INSTANCES) {
+        ASYNC_LOGE(TAG_NET_READY, "Sem instâncias livres do net_ready");
+        return NULL;
+    }
+    net_ready_t *ready = &s_instances[s_instance_count];
+
+    ready->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    ready->notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ready->notify_id = notify_id;
+    if (ready->epoll_fd < 0 || ready->notify_fd < 0) {
+        ASYNC_LOGE(TAG_NET_READY, "Não foi possível criar o epoll: errno %d", errno);
+        return NULL;
+    }
+
+    struct epoll_event event = {
+        .events = EPOLLIN | EPOLLET,
+        .data.u32 = notify_id,
+    };
+    if (epoll_ctl(ready->epoll_fd, EPOLL_CTL_ADD, ready->notify_fd, &event) != 0) {
+        ASYNC_LOGE(TAG_NET_READY, "epoll_ctl do eventfd falhou: errno %d", errno);
+        return NULL;
+    }
+
+    s_instance_count++;
+    return ready;
+}
+
+esp_err_t net_ready_watch(net_ready_t *ready, int sock, uint32_t id) {
+
+    // EPOLLET - mesma semântica de borda do backend lwIP. O kernel já reporta o estado
+    // atual no registro, o que cobre o evento inicial
+    struct epoll_event event = {
+        .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+        .data.u32 = id,
+    };
+    if (epoll_ctl(ready->epoll_fd, EPOLL_CTL_ADD, sock, &event) != 0) {
+        ASYNC_LOGE(TAG_NET_READY, "[CLIENT-%d] epoll_ctl falhou: errno %d", sock, errno);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void net_ready_unwatch(net_ready_t *ready, int sock) {
+
+    epoll_ctl(ready->epoll_fd, EPOLL_CTL_DEL, sock, NULL);
+}
+
+void net_ready_notify(net_ready_t *ready) {
+
+    uint64_t one = 1;
+    if (write(ready->notify_fd, &one, sizeof(one)) < 0) {
+        // EAGAIN: contador saturado, a notificação já está pendente
+    }
+}
+
+int net_ready_wait(net_ready_t *ready, net_ready_event_t *events, int max_events, uint32_t timeout_ms) {
+
+    struct epoll_event fired[max_events];
+    int timeout = timeout_ms == NET_READY_WAIT_FOREVER ? -1 : (int)timeout_ms;
+
+    int count = epoll_wait(ready->epoll_fd, fired, max_events, timeout);
+    if (count < 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        events[i].id = fired[i].data.u32;
+        events[i].events = 0;
+        if (events[i].id == ready->notify_id) {
+            // Zera o eventfd - a próxima notificação gera uma nova borda
+            uint64_t value;
+            if (read(ready->notify_fd, &value, sizeof(value)) < 0) {
+                // Já zerado
+            }
+            events[i].events = NET_READY_READ;
+            continue;
+        }
+        if (fired[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+            events[i].events |= NET_READY_READ;
+        }
+        if (fired[i].events & EPOLLOUT) {
+            events[i].events |= NET_READY_WRITE;
+        }
+        if (fired[i].events & (EPOLLHUP | EPOLLERR)) {
+            events[i].events |= NET_READY_ERROR;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,218 @@
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "async_log.h"
+
+#include "lwip/api.h"
+#include "lwip/sockets.h"
+#include "lwip/priv/sockets_priv.h"
+
+#include "net_ready.h"
+
+#define NET_READY_MAX_SOCKETS           CONFIG_LWIP_MAX_SOCKETS
+// Cada socket fica no máximo uma vez na fila da instância dona. Um item antigo pode sobrar
+// na fila de outra instância quando o fd é reaproveitado, daí a folga de 2x + notificação
+#define NET_READY_QUEUE_LEN             (2 * NET_READY_MAX_SOCKETS + 1)
+// Item da fila reservado para net_ready_notify
+#define NET_READY_NOTIFY_ITEM           UINT16_MAX
+
+// Tags de depuração:
+static const char *TAG_NET_READY = "DEBUG - NET-READY";
+
+struct net_ready {
+    QueueHandle_t queue;
+    StaticQueue_t queue_struct;
+    uint8_t queue_storage[NET_READY_QUEUE_LEN * sizeof(uint16_t)];
+    uint32_t notify_id;
+    bool notify_queued;
+};
+
+// Estado de cada socket observado, indexado por fd - LWIP_SOCKET_OFFSET
+typedef struct {
+    net_ready_t *owner;     // Instância que observa o socket (NULL = nenhuma)
+    net_ready_t *queued_in; // Fila em que o índice está - novos eventos só acumulam em pending
+    uint32_t id;
+    uint8_t pending;        // Eventos acumulados desde a última retirada da fila
+} net_ready_entry_t;
+
+static net_ready_t s_instances[NET_READY_MAX_INSTANCES];
+static int s_instance_count;
+
+static net_ready_entry_t s_entries[NET_READY_MAX_SOCKETS];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Callback original dos sockets (event_callback do sockets.c) - continua sendo chamado
+// para manter select(), SO_RCVTIMEO etc. funcionando
+static netconn_callback s_lwip_event_callback;
+
+// Marca o evento e enfileira o socket na instância dona se ele ainda não estiver lá
+static void net_ready_post(int index, uint8_t events) {
+
+    net_ready_t *post = NULL;
+    net_ready_entry_t *entry = &s_entries[index];
+
+    taskENTER_CRITICAL(&s_lock);
+    if (entry->owner != NULL) {
+        entry->pending |= events;
+        if (entry->queued_in != entry->owner) {
+            post = entry->owner;
+            entry->queued_in = post;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (post != NULL) {
+        uint16_t item = index;
+        if (xQueueSend(post->queue, &item, 0) != pdTRUE) {
+            // Fila cheia de itens antigos - o próximo evento tenta de novo
+            taskENTER_CRITICAL(&s_lock);
+            if (entry->queued_in == post) {
+                entry->queued_in = NULL;
+            }
+            taskEXIT_CRITICAL(&s_lock);
+        }
+    }
+}
+
+// Callback - netconn event (contexto da task tcpip do lwIP)
+static void net_ready_lwip_callback(struct netconn *conn, enum netconn_evt evt, u16_t len) {
+
+    s_lwip_event_callback(conn, evt, len);
+
+    // socket < 0: conexão ainda na fila do accept(), sem fd
+    int index = conn->socket - LWIP_SOCKET_OFFSET;
+    if (conn->socket < 0 || index < 0 || index >= NET_READY_MAX_SOCKETS) {
+        return;
+    }
+
+    switch (evt) {
+    case NETCONN_EVT_RCVPLUS:
+        net_ready_post(index, NET_READY_READ);
+        break;
+    case NETCONN_EVT_SENDPLUS:
+        net_ready_post(index, NET_READY_WRITE);
+        break;
+    case NETCONN_EVT_ERROR:
+        net_ready_post(index, NET_READY_READ | NET_READY_ERROR);
+        break;
+    default:
+        break;
+    }
+}
+
+net_ready_t *net_ready_create(uint32_t notify_id) {
+
+    taskENTER_CRITICAL(&s_lock);
+    net_ready_t *ready = s_instance_count < NET_READY_MAX_INSTANCES ? &s_instances[s_instance_count++] : NULL;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (ready == NULL) {
+        ASYNC_LOGE(TAG_NET_READY, "Sem instâncias livres do net_ready");
+        return NULL;
+    }
+
+    ready->notify_id = notify_id;
+    ready->queue = xQueueCreateStatic(NET_READY_QUEUE_LEN, sizeof(uint16_t), ready->queue_storage, &ready->queue_struct);
+    if (ready->queue == NULL) {
+        ASYNC_LOGE(TAG_NET_READY, "Não foi possível criar a fila de prontidão");
+        return NULL;
+    }
+    return ready;
+}
+
+esp_err_t net_ready_watch(net_ready_t *ready, int sock, uint32_t id) {
+
+    int index = sock - LWIP_SOCKET_OFFSET;
+    struct lwip_sock *lwip_sock = lwip_socket_dbg_get_socket(sock);
+    if (lwip_sock == NULL || lwip_sock->conn == NULL || index < 0 || index >= NET_READY_MAX_SOCKETS) {
+        ASYNC_LOGE(TAG_NET_READY, "[CLIENT-%d] Socket inválido para o net_ready", sock);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    s_entries[index].owner = ready;
+    s_entries[index].id = id;
+    s_entries[index].pending = 0;
+    taskEXIT_CRITICAL(&s_lock);
+
+    // Todos os sockets usam o mesmo event_callback - guarda o original uma vez
+    struct netconn *conn = lwip_sock->conn;
+    if (conn->callback != net_ready_lwip_callback) {
+        if (s_lwip_event_callback == NULL) {
+            s_lwip_event_callback = conn->callback;
+        }
+        conn->callback = net_ready_lwip_callback;
+    }
+
+    // Evento inicial - dados ou FIN recebidos antes do watch não gerariam nova borda
+    net_ready_post(index, NET_READY_READ | NET_READY_WRITE);
+    return ESP_OK;
+}
+
+void net_ready_unwatch(net_ready_t *ready, int sock) {
+
+    int index = sock - LWIP_SOCKET_OFFSET;
+    if (index < 0 || index >= NET_READY_MAX_SOCKETS) {
+        return;
+    }
+
+    // Um índice que já está na fila é descartado na retirada (sem dono)
+    taskENTER_CRITICAL(&s_lock);
+    if (s_entries[index].owner == ready) {
+        s_entries[index].owner = NULL;
+        s_entries[index].pending = 0;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void net_ready_notify(net_ready_t *ready) {
+
+    bool post;
+
+    taskENTER_CRITICAL(&s_lock);
+    post = !ready->notify_queued;
+    ready->notify_queued = true;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (post) {
+        uint16_t item = NET_READY_NOTIFY_ITEM;
+        xQueueSend(ready->queue, &item, 0);
+    }
+}
+
+int net_ready_wait(net_ready_t *ready, net_ready_event_t *events, int max_events, uint32_t timeout_ms) {
+
+    TickType_t wait = timeout_ms == NET_READY_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    int count = 0;
+    uint16_t index;
+
+    // Bloqueia só pelo primeiro item, o restante da fila é drenado sem espera
+    while (count < max_events && xQueueReceive(ready->queue, &index, count == 0 ? wait : 0) == pdTRUE) {
+        uint32_t id = 0;
+        uint8_t pending = 0;
+
+        taskENTER_CRITICAL(&s_lock);
+        if (index == NET_READY_NOTIFY_ITEM) {
+            ready->notify_queued = false;
+            id = ready->notify_id;
+            pending = NET_READY_READ;
+        } else if (s_entries[index].queued_in == ready) {
+            // Limpo antes do atendimento - eventos a partir daqui reenfileiram o socket
+            s_entries[index].queued_in = NULL;
+            if (s_entries[index].owner == ready) {
+                id = s_entries[index].id;
+                pending = s_entries[index].pending;
+                s_entries[index].pending = 0;
+            }
+        }
+        taskEXIT_CRITICAL(&s_lock);
+
+        if (pending != 0) {
+            events[count].id = id;
+            events[count].events = pending;
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// Sockets BSD - lwIP no ESP32, sockets do kernel na build linux (host)
+#if CONFIG_IDF_TARGET_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#else
+#include "lwip/sockets.h"
+#endif
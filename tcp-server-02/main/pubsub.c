@@ -0,0 +1,376 @@
+#include <string.h>
+#include "esp_log.h"
+#include "async_log.h"
+
+#include "pubsub.h"
+#include "conn_io.h"
+#include "framing.h"
+#include "msg_pool.h"
+
+// Menuconfig - Pub/sub
+#define PUBSUB_TRIE_NODES               CONFIG_SOCKET_PUBSUB_TRIE_NODES
+#define PUBSUB_MAX_SUBS                 CONFIG_SOCKET_PUBSUB_MAX_SUBS
+
+// Um bit por posição da tabela de conexões
+#define PUBSUB_BITMAP_WORDS             ((CONN_TABLE_CAPACITY + 31) / 32)
+#define PUBSUB_NODE_NONE                UINT16_MAX
+#define PUBSUB_ROOT                     0
+
+_Static_assert(MSG_BUF_SIZE >= FRAME_MAX_HEADER_LEN + FRAME_MAX_PAYLOAD, "msg_buf_t must hold a full frame");
+_Static_assert(PUBSUB_TRIE_NODES < PUBSUB_NODE_NONE, "SOCKET_PUBSUB_TRIE_NODES too large");
+
+// Tags de depuração:
+static const char *TAG_PUBSUB = "DEBUG - PUBSUB";
+
+typedef struct {
+    uint32_t bits[PUBSUB_BITMAP_WORDS];
+} pubsub_bitmap_t;
+
+// Nó da trie - um byte do tópico. Filhos em lista (primeiro filho + irmão), sem tabela de 256
+typedef struct {
+    uint16_t parent;
+    uint16_t child;
+    uint16_t sibling;       // Próximo irmão, ou próximo livre quando o nó está no pool
+    uint8_t label;
+    pubsub_bitmap_t exact;  // Assinantes do tópico que termina neste nó
+    pubsub_bitmap_t prefix; // Assinantes de todos os tópicos que passam por este nó ("#")
+} pubsub_node_t;
+
+// Assinatura de uma conexão - nó da trie e o tipo (exata ou prefixo)
+typedef struct {
+    uint16_t node;
+    bool prefix;
+} pubsub_sub_t;
+
+static conn_table_t *s_table;
+
+static pubsub_node_t s_nodes[PUBSUB_TRIE_NODES];
+static uint16_t s_free_node;
+
+static pubsub_sub_t s_subs[CONN_TABLE_CAPACITY][PUBSUB_MAX_SUBS];
+static uint8_t s_sub_count[CONN_TABLE_CAPACITY];
+
+// Assinantes que receberam mensagens e ainda não foram enviados pelo event loop
+static pubsub_bitmap_t s_dirty;
+
+static inline void bitmap_set(pubsub_bitmap_t *map, int index) {
+    map->bits[index / 32] |= 1u << (index % 32);
+}
+
+static inline void bitmap_clear(pubsub_bitmap_t *map, int index) {
+    map->bits[index / 32] &= ~(1u << (index % 32));
+}
+
+static inline bool bitmap_is_empty(const pubsub_bitmap_t *map) {
+    for (int w = 0; w < PUBSUB_BITMAP_WORDS; w++) {
+        if (map->bits[w] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline void bitmap_or(pubsub_bitmap_t *dst, const pubsub_bitmap_t *src) {
+    for (int w = 0; w < PUBSUB_BITMAP_WORDS; w++) {
+        dst->bits[w] |= src->bits[w];
+    }
+}
+
+// Function - Find the child of a node with the given byte
+static uint16_t pubsub_trie_child(uint16_t node, uint8_t label) {
+
+    for (uint16_t child = s_nodes[node].child; child != PUBSUB_NODE_NONE; child = s_nodes[child].sibling) {
+        if (s_nodes[child].label == label) {
+            return child;
+        }
+    }
+    return PUBSUB_NODE_NONE;
+}
+
+// Function - Free empty leaf nodes walking up from node (até um nó com filhos ou assinantes)
+static void pubsub_trie_prune(uint16_t node) {
+
+    while (node != PUBSUB_ROOT && s_nodes[node].child == PUBSUB_NODE_NONE &&
+           bitmap_is_empty(&s_nodes[node].exact) && bitmap_is_empty(&s_nodes[node].prefix)) {
+        uint16_t parent = s_nodes[node].parent;
+
+        // Retira da lista de filhos do pai
+        uint16_t *link = &s_nodes[parent].child;
+        while (*link != node) {
+            link = &s_nodes[*link].sibling;
+        }
+        *link = s_nodes[node].sibling;
+
+        s_nodes[node].sibling = s_free_node;
+        s_free_node = node;
+        node = parent;
+    }
+}
+
+// Function - Walk the topic, creating missing nodes. Retorna PUBSUB_NODE_NONE sem nós livres
+static uint16_t pubsub_trie_insert(const uint8_t *topic, uint32_t len) {
+
+    uint16_t node = PUBSUB_ROOT;
+
+    for (uint32_t i = 0; i < len; i++) {
+        uint16_t child = pubsub_trie_child(node, topic[i]);
+        if (child == PUBSUB_NODE_NONE) {
+            if (s_free_node == PUBSUB_NODE_NONE) {
+                // Desfaz os nós criados nesta chamada - todos vazios
+                pubsub_trie_prune(node);
+                return PUBSUB_NODE_NONE;
+            }
+            child = s_free_node;
+            s_free_node = s_nodes[child].sibling;
+
+            memset(&s_nodes[child], 0, sizeof(s_nodes[child]));
+            s_nodes[child].label = topic[i];
+            s_nodes[child].parent = node;
+            s_nodes[child].child = PUBSUB_NODE_NONE;
+            s_nodes[child].sibling = s_nodes[node].child;
+            s_nodes[node].child = child;
+        }
+        node = child;
+    }
+    return node;
+}
+
+// Function - Walk the topic without creating nodes
+static uint16_t pubsub_trie_find(const uint8_t *topic, uint32_t len) {
+
+    uint16_t node = PUBSUB_ROOT;
+
+    for (uint32_t i = 0; i < len && node != PUBSUB_NODE_NONE; i++) {
+        node = pubsub_trie_child(node, topic[i]);
+    }
+    return node;
+}
+
+// Function - Subscribers of a topic: prefixos ao longo do caminho + exatos no último nó
+static void pubsub_trie_match(const uint8_t *topic, uint32_t len, pubsub_bitmap_t *out) {
+
+    uint16_t node = PUBSUB_ROOT;
+
+    memset(out, 0, sizeof(*out));
+    bitmap_or(out, &s_nodes[node].prefix);
+    for (uint32_t i = 0; i < len; i++) {
+        node = pubsub_trie_child(node, topic[i]);
+        if (node == PUBSUB_NODE_NONE) {
+            return;
+        }
+        bitmap_or(out, &s_nodes[node].prefix);
+    }
+    bitmap_or(out, &s_nodes[node].exact);
+}
+
+// Function - Remove one subscription record and its bit in the trie
+static void pubsub_remove_sub(Struct_Socket_clients *client, int slot) {
+
+    pubsub_sub_t sub = s_subs[client->index][slot];
+    pubsub_node_t *node = &s_nodes[sub.node];
+
+    bitmap_clear(sub.prefix ? &node->prefix : &node->exact, client->index);
+    s_subs[client->index][slot] = s_subs[client->index][--s_sub_count[client->index]];
+    pubsub_trie_prune(sub.node);
+}
+
+// Function - Copy the pattern out of the RX ring and split the "#" suffix
+static bool pubsub_parse_pattern(const ring_buffer_view_t *payload, uint8_t *pattern, uint32_t *len, bool *prefix) {
+
+    uint32_t total = ring_buffer_view_len(payload);
+    if (total == 0 || total > PUBSUB_MAX_TOPIC_LEN) {
+        return false;
+    }
+    memcpy(pattern, payload->ptr[0], payload->len[0]);
+    memcpy(pattern + payload->len[0], payload->ptr[1], payload->len[1]);
+
+    *prefix = pattern[total - 1] == '#';
+    *len = *prefix ? total - 1 : total;
+    return true;
+}
+
+// Function - SUBSCRIBE / UNSUBSCRIBE
+static pubsub_ack_t pubsub_subscription(Struct_Socket_clients *client, uint8_t type, const ring_buffer_view_t *payload) {
+
+    uint8_t pattern[PUBSUB_MAX_TOPIC_LEN];
+    uint32_t len;
+    bool prefix;
+
+    if (!pubsub_parse_pattern(payload, pattern, &len, &prefix)) {
+        return PUBSUB_ACK_INVALID;
+    }
+
+    uint16_t node = type == PUBSUB_FRAME_SUBSCRIBE ? pubsub_trie_insert(pattern, len) : pubsub_trie_find(pattern, len);
+    if (node == PUBSUB_NODE_NONE) {
+        return type == PUBSUB_FRAME_SUBSCRIBE ? PUBSUB_ACK_FULL : PUBSUB_ACK_INVALID;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < s_sub_count[client->index]; i++) {
+        if (s_subs[client->index][i].node == node && s_subs[client->index][i].prefix == prefix) {
+            slot = i;
+            break;
+        }
+    }
+
+    if (type == PUBSUB_FRAME_UNSUBSCRIBE) {
+        if (slot < 0) {
+            return PUBSUB_ACK_INVALID;
+        }
+        pubsub_remove_sub(client, slot);
+        return PUBSUB_ACK_OK;
+    }
+
+    // Assinatura repetida - já está registrada
+    if (slot >= 0) {
+        return PUBSUB_ACK_OK;
+    }
+    if (s_sub_count[client->index] == PUBSUB_MAX_SUBS) {
+        pubsub_trie_prune(node);
+        return PUBSUB_ACK_FULL;
+    }
+
+    pubsub_node_t *trie_node = &s_nodes[node];
+    bitmap_set(prefix ? &trie_node->prefix : &trie_node->exact, client->index);
+    s_subs[client->index][s_sub_count[client->index]++] = (pubsub_sub_t){ .node = node, .prefix = prefix };
+    return PUBSUB_ACK_OK;
+}
+
+// Function - PUBLISH: one shared buffer, one reference per subscriber
+static void pubsub_publish(Struct_Socket_clients *client, const ring_buffer_view_t *payload) {
+
+    uint32_t total = ring_buffer_view_len(payload);
+    uint8_t topic[PUBSUB_MAX_TOPIC_LEN];
+
+    // Tópico copiado para fora do ring (pode cruzar o fim do buffer)
+    uint8_t topic_len = total == 0 ? 0 : payload->len[0] > 0 ? payload->ptr[0][0] : payload->ptr[1][0];
+    if (topic_len == 0 || topic_len > PUBSUB_MAX_TOPIC_LEN || 1u + topic_len > total) {
+        ASYNC_LOGW(TAG_PUBSUB, "[CLIENT-%d] Publicação inválida descartada", client->index);
+        return;
+    }
+    for (uint32_t i = 0; i < topic_len; i++) {
+        uint32_t offset = 1 + i;
+        topic[i] = offset < payload->len[0] ? payload->ptr[0][offset] : payload->ptr[1][offset - payload->len[0]];
+    }
+
+    pubsub_bitmap_t subscribers;
+    pubsub_trie_match(topic, topic_len, &subscribers);
+    if (bitmap_is_empty(&subscribers)) {
+        return;
+    }
+
+    msg_buf_t *msg = msg_pool_alloc();
+    if (msg == NULL) {
+        ASYNC_LOGW(TAG_PUBSUB, "[CLIENT-%d] Pool de mensagens vazio, publicação descartada", client->index);
+        return;
+    }
+
+    // Frame MESSAGE montado uma única vez: cabeçalho + payload da publicação
+    uint32_t header_len = framing_encode_header(msg->data, PUBSUB_FRAME_MESSAGE, total);
+    memcpy(msg->data + header_len, payload->ptr[0], payload->len[0]);
+    memcpy(msg->data + header_len + payload->len[0], payload->ptr[1], payload->len[1]);
+    msg->len = header_len + total;
+
+    int delivered = 0;
+    int dropped = 0;
+    for (int w = 0; w < PUBSUB_BITMAP_WORDS; w++) {
+        uint32_t bits = subscribers.bits[w];
+        while (bits != 0) {
+            int index = w * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+
+            // Assinante lento (outbox cheio) perde a mensagem - o publicador nunca espera
+            Struct_Socket_clients *subscriber = &s_table->entries[index];
+            if (!msg_outbox_push(&subscriber->outbox, msg)) {
+                dropped++;
+                continue;
+            }
+            delivered++;
+
+            // Envio imediato - o outbox só acumula enquanto o socket do assinante estiver cheio.
+            // Erros ficam para o event loop, que passa pelos assinantes marcados
+            conn_io_flush(subscriber);
+            bitmap_set(&s_dirty, index);
+        }
+    }
+
+    // Solta a referência da criação - o buffer vive enquanto algum outbox o referenciar
+    msg_pool_unref(msg);
+
+    if (dropped > 0) {
+        ASYNC_LOGW(TAG_PUBSUB, "[CLIENT-%d] Publicação entregue a %d assinantes, %d com outbox cheio", client->index, delivered, dropped);
+    }
+}
+
+// Function - Frame handler: pub/sub frames, eco para os demais tipos
+static frame_result_t pubsub_frame_handler(Struct_Socket_clients *client, uint8_t type, const ring_buffer_view_t *payload, void *ctx) {
+
+    switch (type) {
+    case PUBSUB_FRAME_SUBSCRIBE:
+    case PUBSUB_FRAME_UNSUBSCRIBE: {
+        // Reserva espaço para o ACK antes de mudar o estado - frame recusado é reprocessado
+        if (ring_buffer_free(&client->tx) < 3) {
+            return FRAME_RETRY;
+        }
+        uint8_t ack = pubsub_subscription(client, type, payload);
+        ring_buffer_view_t view = { .ptr = { &ack, &ack }, .len = { 1, 0 } };
+        return framing_write(&client->tx, PUBSUB_FRAME_ACK, &view);
+    }
+    case PUBSUB_FRAME_PUBLISH:
+        pubsub_publish(client, payload);
+        return FRAME_DONE;
+    default:
+        return framing_write(&client->tx, type, payload);
+    }
+}
+
+static int32_t pubsub_data(Struct_Socket_clients *client, const ring_buffer_view_t *data, void *ctx) {
+
+    return framing_parse(client, data, pubsub_frame_handler, NULL);
+}
+
+// Conexão encerrada - remove as assinaturas e solta as mensagens pendentes no outbox
+static void pubsub_close(Struct_Socket_clients *client, void *ctx) {
+
+    while (s_sub_count[client->index] > 0) {
+        pubsub_remove_sub(client, s_sub_count[client->index] - 1);
+    }
+    msg_outbox_clear(&client->outbox);
+    bitmap_clear(&s_dirty, client->index);
+}
+
+const conn_handler_t pubsub_handler = {
+    .on_data = pubsub_data,
+    .on_close = pubsub_close,
+};
+
+void pubsub_init(conn_table_t *table) {
+
+    s_table = table;
+    msg_pool_init();
+
+    // Nó 0 é a raiz; os demais formam a lista de livres
+    memset(s_nodes, 0, sizeof(s_nodes));
+    s_nodes[PUBSUB_ROOT].parent = PUBSUB_NODE_NONE;
+    s_nodes[PUBSUB_ROOT].child = PUBSUB_NODE_NONE;
+    s_nodes[PUBSUB_ROOT].sibling = PUBSUB_NODE_NONE;
+    s_free_node = PUBSUB_NODE_NONE;
+    for (int i = PUBSUB_TRIE_NODES - 1; i > PUBSUB_ROOT; i--) {
+        s_nodes[i].sibling = s_free_node;
+        s_free_node = i;
+    }
+
+    ASYNC_LOGI(TAG_PUBSUB, "Pub/sub iniciado - %d nós na trie, %d mensagens no pool", PUBSUB_TRIE_NODES, MSG_POOL_LEN);
+}
+
+Struct_Socket_clients *pubsub_pop_dirty(void) {
+
+    for (int w = 0; w < PUBSUB_BITMAP_WORDS; w++) {
+        if (s_dirty.bits[w] != 0) {
+            int index = w * 32 + __builtin_ctz(s_dirty.bits[w]);
+            s_dirty.bits[w] &= s_dirty.bits[w] - 1;
+            return &s_table->entries[index];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "conn_io.h"
+
+// Broker pub/sub sobre o framing binário. Tipos de frame:
+//   SUBSCRIBE / UNSUBSCRIBE  payload = padrão do tópico. "a/b" casa só o tópico "a/b";
+//                            "a/#" casa todo tópico que começa com "a/" ("#" = todos)
+//   PUBLISH                  payload = [tamanho do tópico - 1 byte][tópico][dados]
+//   MESSAGE                  servidor -> assinante, mesmo payload do PUBLISH
+//   ACK                      resposta a SUBSCRIBE/UNSUBSCRIBE, payload = pubsub_ack_t
+// Outros tipos continuam com eco. Cada publicação vira um único buffer com contagem de
+// referências; os assinantes recebem só um ponteiro no outbox.
+#define PUBSUB_FRAME_SUBSCRIBE          0x10
+#define PUBSUB_FRAME_UNSUBSCRIBE        0x11
+#define PUBSUB_FRAME_PUBLISH            0x12
+#define PUBSUB_FRAME_MESSAGE            0x13
+#define PUBSUB_FRAME_ACK                0x14
+
+#define PUBSUB_MAX_TOPIC_LEN            64
+
+typedef enum {
+    PUBSUB_ACK_OK,
+    PUBSUB_ACK_FULL,        // Limite de assinaturas da conexão ou nós da trie esgotados
+    PUBSUB_ACK_INVALID,     // Padrão vazio, longo demais ou assinatura inexistente
+} pubsub_ack_t;
+
+// Handler de conexão do broker - frames do pub/sub e, no close, remove as assinaturas
+extern const conn_handler_t pubsub_handler;
+
+// Associa o broker à tabela de conexões
+void pubsub_init(conn_table_t *table);
+
+// Próximo assinante com mensagens novas no outbox desde a última chamada (NULL = nenhum).
+// O event loop envia para eles depois de atender o publicador
+Struct_Socket_clients *pubsub_pop_dirty(void);
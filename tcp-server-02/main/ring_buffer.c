@@ -0,0 +1,115 @@
+#include <string.h>
+#include <sys/param.h>
+
+#include "ring_buffer.h"
+
+void ring_buffer_init(ring_buffer_t *ring, uint8_t *storage, uint32_t size) {
+
+    ring->buffer = storage;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+uint32_t ring_buffer_write_window(ring_buffer_t *ring, uint8_t **ptr) {
+
+    uint32_t offset = ring->head & ring->mask;
+
+    *ptr = &ring->buffer[offset];
+    return MIN(ring_buffer_free(ring), ring_buffer_size(ring) - offset);
+}
+
+uint32_t ring_buffer_read_window(const ring_buffer_t *ring, const uint8_t **ptr) {
+
+    uint32_t offset = ring->tail & ring->mask;
+
+    *ptr = &ring->buffer[offset];
+    return MIN(ring_buffer_used(ring), ring_buffer_size(ring) - offset);
+}
+
+uint32_t ring_buffer_write(ring_buffer_t *ring, const void *data, uint32_t len) {
+
+    const uint8_t *src = data;
+    uint32_t total = MIN(len, ring_buffer_free(ring));
+    uint32_t offset = ring->head & ring->mask;
+    uint32_t first = MIN(total, ring_buffer_size(ring) - offset);
+
+    memcpy(&ring->buffer[offset], src, first);
+    memcpy(ring->buffer, src + first, total - first);
+    ring->head += total;
+    return total;
+}
+
+bool ring_buffer_write_at(ring_buffer_t *ring, uint32_t offset, const void *data, uint32_t len) {
+
+    const uint8_t *src = data;
+
+    if (offset > ring_buffer_free(ring) || len > ring_buffer_free(ring) - offset) {
+        return false;
+    }
+
+    uint32_t start = (ring->head + offset) & ring->mask;
+    uint32_t first = MIN(len, ring_buffer_size(ring) - start);
+
+    memcpy(&ring->buffer[start], src, first);
+    memcpy(ring->buffer, src + first, len - first);
+    return true;
+}
+
+uint32_t ring_buffer_peek(const ring_buffer_t *ring, uint32_t offset, void *dst, uint32_t len) {
+
+    uint8_t *out = dst;
+    uint32_t used = ring_buffer_used(ring);
+
+    if (offset >= used) {
+        return 0;
+    }
+
+    uint32_t total = MIN(len, used - offset);
+    uint32_t start = (ring->tail + offset) & ring->mask;
+    uint32_t first = MIN(total, ring_buffer_size(ring) - start);
+
+    memcpy(out, &ring->buffer[start], first);
+    memcpy(out + first, ring->buffer, total - first);
+    return total;
+}
+
+void ring_buffer_view(const ring_buffer_t *ring, uint32_t offset, uint32_t len, ring_buffer_view_t *view) {
+
+    uint32_t start = (ring->tail + offset) & ring->mask;
+    uint32_t first = MIN(len, ring_buffer_size(ring) - start);
+
+    view->ptr[0] = &ring->buffer[start];
+    view->len[0] = first;
+    view->ptr[1] = ring->buffer;
+    view->len[1] = len - first;
+}
+
+void ring_buffer_view_slice(const ring_buffer_view_t *view, uint32_t offset, uint32_t len, ring_buffer_view_t *slice) {
+
+    // ptr[1] nunca fica NULL - segmento vazio continua apontando para o buffer
+    slice->ptr[1] = view->ptr[1];
+    if (offset >= view->len[0]) {
+        slice->ptr[0] = view->ptr[1] + (offset - view->len[0]);
+        slice->len[0] = len;
+        slice->len[1] = 0;
+    } else {
+        slice->ptr[0] = view->ptr[0] + offset;
+        slice->len[0] = MIN(len, view->len[0] - offset);
+        slice->len[1] = len - slice->len[0];
+    }
+}
+
+uint32_t ring_buffer_view_copy(const ring_buffer_view_t *view, uint32_t offset, void *dst, uint32_t len) {
+
+    ring_buffer_view_t part;
+    uint32_t view_len = ring_buffer_view_len(view);
+
+    if (offset >= view_len) {
+        return 0;
+    }
+    ring_buffer_view_slice(view, offset, MIN(len, view_len - offset), &part);
+    memcpy(dst, part.ptr[0], part.len[0]);
+    memcpy((uint8_t *)dst + part.len[0], part.ptr[1], part.len[1]);
+    return ring_buffer_view_len(&part);
+}
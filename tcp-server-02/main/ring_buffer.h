@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Ring buffer de bytes com tamanho potência de 2. head e tail são contadores livres
+// (nunca são reduzidos ao tamanho), então used = head - tail mesmo após o overflow de 32 bits.
+typedef struct {
+    uint8_t *buffer;
+    uint32_t mask;
+    uint32_t head;  // Próxima posição de escrita
+    uint32_t tail;  // Próxima posição de leitura
+} ring_buffer_t;
+
+// Visão somente leitura de bytes dentro do ring: até 2 segmentos quando cruza o fim do buffer
+typedef struct {
+    const uint8_t *ptr[2];
+    uint32_t len[2];
+} ring_buffer_view_t;
+
+// Inicializa o ring sobre um buffer externo. size deve ser potência de 2
+void ring_buffer_init(ring_buffer_t *ring, uint8_t *storage, uint32_t size);
+
+static inline void ring_buffer_reset(ring_buffer_t *ring) {
+    ring->head = ring->tail = 0;
+}
+
+static inline uint32_t ring_buffer_size(const ring_buffer_t *ring) {
+    return ring->mask + 1;
+}
+
+static inline uint32_t ring_buffer_used(const ring_buffer_t *ring) {
+    return ring->head - ring->tail;
+}
+
+static inline uint32_t ring_buffer_free(const ring_buffer_t *ring) {
+    return ring_buffer_size(ring) - ring_buffer_used(ring);
+}
+
+static inline bool ring_buffer_is_empty(const ring_buffer_t *ring) {
+    return ring->head == ring->tail;
+}
+
+// Janela contígua livre a partir de head - permite recv() direto no ring
+uint32_t ring_buffer_write_window(ring_buffer_t *ring, uint8_t **ptr);
+
+// Confirma len bytes escritos na janela retornada por ring_buffer_write_window
+static inline void ring_buffer_produce(ring_buffer_t *ring, uint32_t len) {
+    ring->head += len;
+}
+
+// Janela contígua ocupada a partir de tail - permite send() direto do ring
+uint32_t ring_buffer_read_window(const ring_buffer_t *ring, const uint8_t **ptr);
+
+// Descarta len bytes a partir de tail
+static inline void ring_buffer_consume(ring_buffer_t *ring, uint32_t len) {
+    ring->tail += len;
+}
+
+// Copia até len bytes para o ring. Retorna a quantidade copiada
+uint32_t ring_buffer_write(ring_buffer_t *ring, const void *data, uint32_t len);
+
+// Copia len bytes para head + offset sem produzir (ex.: dados que chegaram fora de ordem e
+// esperam os anteriores). Retorna false se não couberem no espaço livre
+bool ring_buffer_write_at(ring_buffer_t *ring, uint32_t offset, const void *data, uint32_t len);
+
+// Copia até len bytes a partir de tail + offset, sem consumir. Retorna a quantidade copiada
+uint32_t ring_buffer_peek(const ring_buffer_t *ring, uint32_t offset, void *dst, uint32_t len);
+
+// Byte em tail + offset (offset < used)
+static inline uint8_t ring_buffer_at(const ring_buffer_t *ring, uint32_t offset) {
+    return ring->buffer[(ring->tail + offset) & ring->mask];
+}
+
+// Visão zero-copy de len bytes a partir de tail + offset (offset + len <= used)
+void ring_buffer_view(const ring_buffer_t *ring, uint32_t offset, uint32_t len, ring_buffer_view_t *view);
+
+static inline uint32_t ring_buffer_view_len(const ring_buffer_view_t *view) {
+    return view->len[0] + view->len[1];
+}
+
+// Byte na posição offset da visão (offset < len)
+static inline uint8_t ring_buffer_view_at(const ring_buffer_view_t *view, uint32_t offset) {
+    return offset < view->len[0] ? view->ptr[0][offset] : view->ptr[1][offset - view->len[0]];
+}
+
+// Sub-visão de len bytes a partir de offset (offset + len <= ring_buffer_view_len(view))
+void ring_buffer_view_slice(const ring_buffer_view_t *view, uint32_t offset, uint32_t len, ring_buffer_view_t *slice);
+
+// Copia até len bytes da visão a partir de offset. Retorna a quantidade copiada
+uint32_t ring_buffer_view_copy(const ring_buffer_view_t *view, uint32_t offset, void *dst, uint32_t len);
@@ -0,0 +1,589 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "async_log.h"
+#include "task_profile.h"
+
+#include "net_sockets.h"
+
+#include "tcp_server.h"
+#include "conn_io.h"
+#if CONFIG_SOCKET_EVENT_LOOP_READY_QUEUE
+#include "net_ready.h"
+#endif
+#if CONFIG_SOCKET_PUBSUB
+#include "pubsub.h"
+#endif
+
+// Menuconfig - Timeouts (0 desativa)
+#define EVENT_LOOP_TIMER_TICK_MS        CONFIG_SOCKET_TIMER_TICK_MS
+#define EVENT_LOOP_IDLE_TIMEOUT_MS      CONFIG_SOCKET_IDLE_TIMEOUT_MS
+#define EVENT_LOOP_READ_TIMEOUT_MS      CONFIG_SOCKET_READ_TIMEOUT_MS
+#define EVENT_LOOP_WRITE_TIMEOUT_MS     CONFIG_SOCKET_WRITE_TIMEOUT_MS
+
+// Prazos de flush (política throughput) - um tick do FreeRTOS, bem abaixo do tick dos timeouts
+#define EVENT_LOOP_FLUSH_TICK_MS        MAX(1, pdTICKS_TO_MS(1))
+
+#if CONFIG_SOCKET_EVENT_LOOP_READY_QUEUE
+// Eventos retirados da fila de prontidão por iteração
+#define EVENT_LOOP_MAX_EVENTS           16
+// Ids especiais - os clientes usam o handle da tabela de conexões
+#define EVENT_LOOP_LISTEN_ID            CONN_HANDLE_INVALID
+#define EVENT_LOOP_INBOX_ID             (CONN_HANDLE_INVALID - 1)
+#endif
+
+// Menuconfig - Shards (um event loop por core)
+#define EVENT_LOOP_SHARDS               CONN_TABLE_SHARDS
+#if CONFIG_SOCKET_EVENT_LOOP_SHARDED
+// Conexões aceitas aguardando o shard de destino
+#define EVENT_LOOP_INBOX_LEN            8
+#endif
+
+// Tags de depuração:
+static const char *TAG_SOCKET = "DEBUG - TCP-SOCKET";
+
+#if CONFIG_SOCKET_EVENT_LOOP_SHARDED
+// Conexão aceita pelo shard 0 e entregue a outro shard
+typedef struct {
+    int sock_client;
+    struct sockaddr_in client_addr;
+    socklen_t client_addr_len;
+} event_loop_handoff_t;
+#endif
+
+// Shard do event loop - única task que toca a sua tabela, timers e fila de prontidão
+typedef struct {
+    conn_table_t table;             // sock_client == -1 indica posição livre
+    timer_wheel_t timers;           // Prazos das conexões - agendar e cancelar em O(1)
+    timer_wheel_t flush_timers;     // Prazos de flush dos dados retidos - só armado enquanto houver
+#if CONFIG_SOCKET_EVENT_LOOP_READY_QUEUE
+    net_ready_t *ready;
+#endif
+#if CONFIG_SOCKET_EVENT_LOOP_SHARDED
+    QueueHandle_t inbox;
+    StaticQueue_t inbox_struct;
+    uint8_t inbox_storage[EVENT_LOOP_INBOX_LEN * sizeof(event_loop_handoff_t)];
+#endif
+    int index;
+} event_loop_shard_t;
+
+static event_loop_shard_t s_shards[EVENT_LOOP_SHARDS];
+
+// Listener atendido pelo event loop - protocolo de todas as conexões, em todos os shards
+static const conn_listener_t *s_listener;
+
+static const uint32_t s_timer_timeout_ms[CONN_TIMER_COUNT] = {
+    [CONN_TIMER_IDLE] = EVENT_LOOP_IDLE_TIMEOUT_MS,
+    [CONN_TIMER_READ] = EVENT_LOOP_READ_TIMEOUT_MS,
+    [CONN_TIMER_WRITE] = EVENT_LOOP_WRITE_TIMEOUT_MS,
+};
+
+static const char *s_timer_name[CONN_TIMER_COUNT] = {
+    [CONN_TIMER_IDLE] = "inatividade",
+    [CONN_TIMER_READ] = "leitura",
+    [CONN_TIMER_WRITE] = "escrita",
+};
+
+static inline uint32_t event_loop_now_ms(void) {
+    return pdTICKS_TO_MS(xTaskGetTickCount());
+}
+
+// Function - Set socket non-blocking
+static int socket_set_nonblocking(int sock) {
+
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags < 0) {
+        return -1;
+    }
+    return fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+}
+
+// Function - Arm (or re-arm) one of the client deadlines
+static void event_loop_timer_start(event_loop_shard_t *shard, Struct_Socket_clients *client, conn_timer_t timer, uint32_t now_ms) {
+
+    if (s_timer_timeout_ms[timer] > 0) {
+        timer_wheel_schedule(&shard->timers, &client->timers[timer], now_ms, s_timer_timeout_ms[timer]);
+    }
+}
+
+// Function - Close client and release its slot
+static void event_loop_close_client(event_loop_shard_t *shard, Struct_Socket_clients *client) {
+
+    for (int t = 0; t < CONN_TIMER_COUNT; t++) {
+        timer_wheel_cancel(&shard->timers, &client->timers[t]);
+    }
+    timer_wheel_cancel(&shard->flush_timers, &client->flush_timer);
+#if CONFIG_SOCKET_EVENT_LOOP_READY_QUEUE
+    net_ready_unwatch(shard->ready, client->sock_client);
+#endif
+    conn_io_close(client);
+    shutdown(client->sock_client, 0);
+    close(client->sock_client);
+    conn_table_release(&shard->table, client);
+}
+
+// Function - Admit an accepted connection into the shard
+static void event_loop_admit(event_loop_shard_t *shard, int sock_client, const struct sockaddr_in *client_addr, socklen_t client_addr_len) {
+
+    // Admissão - reserva uma posição na tabela de conexões (limite global e por IP)
+    conn_admit_t admit = CONN_ADMIT_TABLE_FULL;
+#if CONFIG_SOCKET_EVENT_LOOP_READY_QUEUE
+    Struct_Socket_clients *client = conn_table_alloc(&shard->table, client_addr, &admit);
+#else
+    Struct_Socket_clients *client = sock_client < FD_SETSIZE ? conn_table_alloc(&shard->table, client_addr, &admit) : NULL;
+#endif
+    if (client == NULL) {
+        ASYNC_LOGW(TAG_SOCKET, "[CLIENT-%d] %s, conexão recusada", sock_client,
+                   admit == CONN_ADMIT_IP_LIMIT ? "Limite de conexões por IP atingido" : "Limite de clientes atingido");
+        close(sock_client);
+        return;
+    }
+    client->client_addr_len = client_addr_len;
+    client->sock_client = sock_client;
+
+    // Send parcial em vez de bloquear a task quando o TCP não tem espaço
+    socket_set_nonblocking(sock_client);
+
+    // Set tcp keepalive option - uma única vez por conexão
+    conn_io_configure_socket(sock_client);
+
+    event_loop_timer_start(shard, client, CONN_TIMER_IDLE, event_loop_now_ms());
+
+#if CONFIG_SOCKET_EVENT_LOOP_READY_QUEUE
+    if (net_ready_watch(shard->ready, sock_client, conn_table_handle(client)) != ESP_OK) {
+        event_loop_close_client(shard, client);
+        return;
+    }
+#endif
+
+    // Handler do protocolo - pode recusar a conexão
+    if (!conn_io_open(client, s_listener)) {
+        event_loop_close_client(shard, client);
+        return;
+    }
+
+    // IP como inteiros - o log assíncrono não pode guardar ponteiro para a stack
+    uint32_t ip = ntohl(client_addr->sin_addr.s_addr);
+    ASYNC_LOGI(TAG_SOCKET, "[CLIENT-%d] Endereço IP aceito pelo Socket: %d.%d.%d.%d (shard %d)", sock_client,
+               (int)(ip >> 24), (int)((ip >> 16) & 0xFF), (int)((ip >> 8) & 0xFF), (int)(ip & 0xFF), shard->index);
+}
+
+#if CONFIG_SOCKET_EVENT_LOOP_SHARDED
+// Function - Choose the shard that will own a new connection
+static event_loop_shard_t *event_loop_pick_shard(const struct sockaddr_in *client_addr) {
+
+#if CONFIG_SOCKET_SHARD_DISPATCH_HASH
+    // Hash do IP de origem - todas as conexões de um IP caem no mesmo shard e o limite
+    // por IP continua exato sem estado compartilhado
+    uint32_t hash = ntohl(client_addr->sin_addr.s_addr) * 2654435761u;
+    return &s_shards[(hash >> 16) % EVENT_LOOP_SHARDS];
+#else
+    // Menor carga - contagem lida sem lock, serve apenas como estimativa
+    event_loop_shard_t *target = &s_shards[0];
+    for (int i = 1; i < EVENT_LOOP_SHARDS; i++) {
+        if (conn_table_count(&s_shards[i].table) < conn_table_count(&target->table)) {
+            target = &s_shards[i];
+        }
+    }
+    return target;
+#endif
+}
+
+// Function - Admit every connection handed over by the acceptor shard
+static void event_loop_drain_inbox(event_loop_shard_t *shard) {
+
+    event_loop_handoff_t handoff;
+
+    while (xQueueReceive(shard->inbox, &handoff, 0) == pdTRUE) {
+        event_loop_admit(shard, handoff.sock_client, &handoff.client_addr, handoff.client_addr_len);
+    }
+}
+#endif
+
+// Function - Accept every pending connection on the listening socket
+static void event_loop_accept(event_loop_shard_t *shard, int sock_listen) {
+
+    for (;;) {
+        struct sockaddr_in client_addr;
+        socklen_t client_addr_len = sizeof(client_addr);
+
+        int sock_client = accept(sock_listen, (struct sockaddr *)&client_addr, &client_addr_len);
+        if (sock_client < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                ASYNC_LOGE(TAG_SOCKET, "Não foi possível aceitar a conexão: errno %d", errno);
+            }
+            return;
+        }
+
+#if CONFIG_SOCKET_EVENT_LOOP_SHARDED
+        // Conexão de outro shard - entregue pela inbox, a tabela do destino só é tocada por ele
+        event_loop_shard_t *target = event_loop_pick_shard(&client_addr);
+        if (target != shard) {
+            event_loop_handoff_t handoff = {
+                .sock_client = sock_client,
+                .client_addr = client_addr,
+                .client_addr_len = client_addr_len,
+            };
+            if (xQueueSend(target->inbox, &handoff, 0) != pdTRUE) {
+                ASYNC_LOGW(TAG_SOCKET, "[CLIENT-%d] Inbox do shard %d cheia, conexão recusada", sock_client, target->index);
+                close(sock_client);
+                continue;
+            }
+            net_ready_notify(target->ready);
+            continue;
+        }
+#endif
+        event_loop_admit(shard, sock_client, &client_addr, client_addr_len);
+    }
+}
+
+// Function - Update the client deadlines after I/O
+static void event_loop_update_timers(event_loop_shard_t *shard, Struct_Socket_clients *client, bool received, bool sent) {
+
+    uint32_t now_ms = event_loop_now_ms();
+
+    if (received) {
+        event_loop_timer_start(shard, client, CONN_TIMER_IDLE, now_ms);
+    }
+
+    // Leitura: conta desde que os dados começaram a ficar parados no RX ring - um cliente
+    // que envia um frame aos poucos não renova o prazo a cada byte
+    if (ring_buffer_is_empty(&client->rx)) {
+        timer_wheel_cancel(&shard->timers, &client->timers[CONN_TIMER_READ]);
+    } else if (!timer_wheel_node_armed(&client->timers[CONN_TIMER_READ])) {
+        event_loop_timer_start(shard, client, CONN_TIMER_READ, now_ms);
+    }
+
+    // Escrita: renovado a cada send com progresso
+    if (!conn_io_want_write(client)) {
+        timer_wheel_cancel(&shard->timers, &client->timers[CONN_TIMER_WRITE]);
+    } else if (sent || !timer_wheel_node_armed(&client->timers[CONN_TIMER_WRITE])) {
+        event_loop_timer_start(shard, client, CONN_TIMER_WRITE, now_ms);
+    }
+
+    // Flush adiado (política throughput): os dados retidos saem no prazo mesmo sem novos eventos
+    if (!conn_io_tx_held(client)) {
+        timer_wheel_cancel(&shard->flush_timers, &client->flush_timer);
+    } else if (!timer_wheel_node_armed(&client->flush_timer)) {
+        timer_wheel_schedule(&shard->flush_timers, &client->flush_timer, now_ms, conn_io_flush_delay_ms(client));
+    }
+}
+
+// Function - How long the loop may sleep (UINT32_MAX = sem prazo, NET_READY_WAIT_FOREVER)
+// Com dados retidos acorda a cada tick fino; senão, a cada tick do timer wheel
+static uint32_t event_loop_wait_ms(event_loop_shard_t *shard) {
+
+    if (!timer_wheel_is_empty(&shard->flush_timers)) {
+        return EVENT_LOOP_FLUSH_TICK_MS;
+    }
+    return timer_wheel_is_empty(&shard->timers) ? UINT32_MAX : EVENT_LOOP_TIMER_TICK_MS;
+}
+
+#if !CONFIG_SOCKET_EVENT_LOOP_READY_QUEUE
+// Function - Serve one client after select() (echo)
+static void event_loop_serve_client(event_loop_shard_t *shard, Struct_Socket_clients *client, bool readable, bool writable) {
+
+    uint32_t rx_head = client->rx.head;
+    uint32_t tx_count = conn_io_tx_count(client);
+
+    if (readable) {
+        conn_io_status_t status = conn_io_recv(client);
+        if (status == CONN_IO_CLOSED || status == CONN_IO_ERROR) {
+            event_loop_close_client(shard, client);
+            return;
+        }
+    }
+
+    // Processa e envia na mesma passada - o que não sair agora espera o socket ficar gravável
+    if (readable || writable) {
+        if (conn_io_process(client) != CONN_IO_OK ||
+            conn_io_flush(client) == CONN_IO_ERROR ||
+            conn_io_process(client) != CONN_IO_OK) {
+            event_loop_close_client(shard, client);
+            return;
+        }
+        event_loop_update_timers(shard, client, client->rx.head != rx_head, conn_io_tx_count(client) != tx_count);
+    }
+}
+#else
+// Function - Serve one client after a readiness event (echo)
+// Eventos por borda: lê e envia até o socket bloquear, senão o próximo aviso não vem
+static void event_loop_serve_ready(event_loop_shard_t *shard, Struct_Socket_clients *client) {
+
+    uint32_t rx_head = client->rx.head;
+    uint32_t tx_count = conn_io_tx_count(client);
+    bool progress;
+
+    do {
+        uint32_t pass_tx_count = conn_io_tx_count(client);
+        progress = false;
+
+        // Backpressure: com o TX ring cheio os dados esperam no socket até o TX esvaziar
+        if (conn_io_want_read(client)) {
+            conn_io_status_t status = conn_io_recv(client);
+            if (status == CONN_IO_CLOSED || status == CONN_IO_ERROR) {
+                event_loop_close_client(shard, client);
+                return;
+            }
+            progress = status == CONN_IO_OK;
+        }
+
+        if (conn_io_process(client) != CONN_IO_OK ||
+            conn_io_flush(client) == CONN_IO_ERROR ||
+            conn_io_process(client) != CONN_IO_OK) {
+            event_loop_close_client(shard, client);
+            return;
+        }
+        // Envio com progresso pode ter liberado a leitura (low watermark)
+        progress = progress || conn_io_tx_count(client) != pass_tx_count;
+    } while (progress);
+
+    event_loop_update_timers(shard, client, client->rx.head != rx_head, conn_io_tx_count(client) != tx_count);
+}
+#endif
+
+// Function - Timer wheel callback: deadline expired, close the client
+static void event_loop_timer_expired(timer_wheel_node_t *node, void *ctx) {
+
+    event_loop_shard_t *shard = ctx;
+    Struct_Socket_clients *client = node->owner;
+
+    ASYNC_LOGW(TAG_SOCKET, "[CLIENT-%d] Timeout de %s, encerrando conexão", client->sock_client, s_timer_name[node->kind]);
+    event_loop_close_client(shard, client);
+}
+
+// Function - Flush timer callback: deadline of the held data, serve the client as writable
+// Envia o que ficou retido e, com espaço livre no TX ring, processa o que esperava no RX
+static void event_loop_flush_expired(timer_wheel_node_t *node, void *ctx) {
+
+    event_loop_shard_t *shard = ctx;
+    Struct_Socket_clients *client = node->owner;
+
+#if CONFIG_SOCKET_EVENT_LOOP_READY_QUEUE
+    event_loop_serve_ready(shard, client);
+#else
+    event_loop_serve_client(shard, client, false, true);
+#endif
+}
+
+#if CONFIG_SOCKET_PUBSUB
+// Function - Visit the subscribers that got messages in this iteration
+// O publish já tentou enviar; aqui ficam os erros de envio e os prazos de quem só escuta
+static void event_loop_flush_subscribers(event_loop_shard_t *shard) {
+
+    Struct_Socket_clients *client;
+
+    while ((client = pubsub_pop_dirty()) != NULL) {
+        uint32_t tx_count = conn_io_tx_count(client);
+        if (conn_io_flush(client) == CONN_IO_ERROR) {
+            event_loop_close_client(shard, client);
+            continue;
+        }
+        // Mensagens entregues contam como atividade - um assinante pode só escutar
+        bool delivered = !conn_io_want_write(client) || conn_io_tx_count(client) != tx_count;
+        event_loop_update_timers(shard, client, delivered, delivered);
+    }
+}
+#endif
+
+#if CONFIG_SOCKET_EVENT_LOOP_READY_QUEUE
+// Function - Wait on the readiness queue: only sockets with work are touched, O(1) per event
+// sock_listen == -1: shard sem o socket de escuta, recebe conexões pela inbox
+static void event_loop_run_ready(event_loop_shard_t *shard, int sock_listen) {
+
+    if (sock_listen != -1 && net_ready_watch(shard->ready, sock_listen, EVENT_LOOP_LISTEN_ID) != ESP_OK) {
+        return;
+    }
+
+    net_ready_event_t events[EVENT_LOOP_MAX_EVENTS];
+
+    for (;;) {
+        // Com prazos agendados a espera acorda a cada tick para avançar o timer wheel
+        int count = net_ready_wait(shard->ready, events, EVENT_LOOP_MAX_EVENTS, event_loop_wait_ms(shard));
+
+        for (int i = 0; i < count; i++) {
+            if (events[i].id == EVENT_LOOP_LISTEN_ID) {
+                event_loop_accept(shard, sock_listen);
+                continue;
+            }
+#if CONFIG_SOCKET_EVENT_LOOP_SHARDED
+            if (events[i].id == EVENT_LOOP_INBOX_ID) {
+                event_loop_drain_inbox(shard);
+                continue;
+            }
+#endif
+            // Handle de uma conexão já encerrada (evento antigo na fila) - ignorado
+            Struct_Socket_clients *client = conn_table_get(&shard->table, events[i].id);
+            if (client != NULL && client->sock_client != -1) {
+                event_loop_serve_ready(shard, client);
+            }
+        }
+
+#if CONFIG_SOCKET_PUBSUB
+        event_loop_flush_subscribers(shard);
+#endif
+        timer_wheel_advance(&shard->flush_timers, event_loop_now_ms(), event_loop_flush_expired, shard);
+        timer_wheel_advance(&shard->timers, event_loop_now_ms(), event_loop_timer_expired, shard);
+    }
+}
+#else
+// Function - select() over the listening socket and every client
+static void event_loop_run_select(event_loop_shard_t *shard, int sock_listen) {
+
+    for (;;) {
+        fd_set read_fds;
+        fd_set write_fds;
+        FD_ZERO(&read_fds);
+        FD_ZERO(&write_fds);
+        FD_SET(sock_listen, &read_fds);
+        int max_fd = sock_listen;
+
+        for (int i = 0; i < CONN_TABLE_CAPACITY; i++) {
+            Struct_Socket_clients *client = &shard->table.entries[i];
+            if (client->sock_client == -1) {
+                continue;
+            }
+            // Backpressure: cliente com TX ring cheio não é lido até esvaziar
+            if (conn_io_want_read(client)) {
+                FD_SET(client->sock_client, &read_fds);
+            }
+            if (conn_io_want_write(client)) {
+                FD_SET(client->sock_client, &write_fds);
+            }
+            max_fd = MAX(max_fd, client->sock_client);
+        }
+
+        // Com prazos agendados o select acorda a cada tick para avançar o timer wheel
+        uint32_t timeout_ms = event_loop_wait_ms(shard);
+        struct timeval tick = {
+            .tv_sec = timeout_ms / 1000,
+            .tv_usec = (timeout_ms % 1000) * 1000,
+        };
+        int ready = select(max_fd + 1, &read_fds, &write_fds, NULL, timeout_ms == UINT32_MAX ? NULL : &tick);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ASYNC_LOGE(TAG_SOCKET, "Select falhou: errno %d", errno);
+            return;
+        }
+
+        for (int i = 0; i < CONN_TABLE_CAPACITY; i++) {
+            Struct_Socket_clients *client = &shard->table.entries[i];
+            if (client->sock_client == -1) {
+                continue;
+            }
+            bool readable = FD_ISSET(client->sock_client, &read_fds);
+            bool writable = FD_ISSET(client->sock_client, &write_fds);
+            if (readable || writable) {
+                event_loop_serve_client(shard, client, readable, writable);
+            }
+        }
+
+        if (FD_ISSET(sock_listen, &read_fds)) {
+            event_loop_accept(shard, sock_listen);
+        }
+
+#if CONFIG_SOCKET_PUBSUB
+        event_loop_flush_subscribers(shard);
+#endif
+        timer_wheel_advance(&shard->flush_timers, event_loop_now_ms(), event_loop_flush_expired, shard);
+        timer_wheel_advance(&shard->timers, event_loop_now_ms(), event_loop_timer_expired, shard);
+    }
+}
+#endif
+
+// Function - Run one shard until a fatal error, then close its clients
+static void event_loop_shard_run(event_loop_shard_t *shard, int sock_listen) {
+
+    ASYNC_LOGI(TAG_SOCKET, "Event loop %d iniciado - até %d clientes", shard->index, CONN_TABLE_CAPACITY);
+
+#if CONFIG_SOCKET_EVENT_LOOP_READY_QUEUE
+    event_loop_run_ready(shard, sock_listen);
+#else
+    event_loop_run_select(shard, sock_listen);
+#endif
+
+    // Task error - fecha todos os clientes do shard
+    for (int i = 0; i < CONN_TABLE_CAPACITY; i++) {
+        if (shard->table.entries[i].sock_client != -1) {
+            event_loop_close_client(shard, &shard->table.entries[i]);
+        }
+    }
+}
+
+#if CONFIG_SOCKET_EVENT_LOOP_SHARDED
+// Task - Event loop shard without the listening socket
+static void task_event_loop_shard(void* pvParameters) {
+
+    event_loop_shard_run((event_loop_shard_t *)pvParameters, -1);
+    vTaskDelete(NULL);
+}
+#endif
+
+// Function - Initialize one shard
+static esp_err_t event_loop_shard_init(event_loop_shard_t *shard, int index) {
+
+    shard->index = index;
+    conn_table_init(&shard->table);
+    timer_wheel_init(&shard->timers, EVENT_LOOP_TIMER_TICK_MS, event_loop_now_ms());
+    timer_wheel_init(&shard->flush_timers, EVENT_LOOP_FLUSH_TICK_MS, event_loop_now_ms());
+
+#if CONFIG_SOCKET_EVENT_LOOP_READY_QUEUE
+    shard->ready = net_ready_create(EVENT_LOOP_INBOX_ID);
+    if (shard->ready == NULL) {
+        return ESP_FAIL;
+    }
+#endif
+#if CONFIG_SOCKET_EVENT_LOOP_SHARDED
+    shard->inbox = xQueueCreateStatic(EVENT_LOOP_INBOX_LEN, sizeof(event_loop_handoff_t), shard->inbox_storage, &shard->inbox_struct);
+    if (shard->inbox == NULL) {
+        return ESP_FAIL;
+    }
+#endif
+    return ESP_OK;
+}
+
+// Event loop - o socket de escuta e os clientes do shard 0 na task chamadora; com shards,
+// um event loop a mais por core, cada um dono exclusivo das suas conexões
+void tcp_event_loop_run(int sock_listen, const conn_listener_t *listener) {
+
+    s_listener = listener;
+    for (int i = 0; i < EVENT_LOOP_SHARDS; i++) {
+        if (event_loop_shard_init(&s_shards[i], i) != ESP_OK) {
+            ASYNC_LOGE(TAG_SOCKET, "Não foi possível iniciar o event loop %d", i);
+            return;
+        }
+    }
+
+#if CONFIG_SOCKET_PUBSUB
+    // Pub/sub - um único event loop, dono de todos os assinantes
+    pubsub_init(&s_shards[0].table);
+#endif
+
+    if (socket_set_nonblocking(sock_listen) != 0) {
+        ASYNC_LOGE(TAG_SOCKET, "Não foi possível configurar o socket como não bloqueante: errno %d", errno);
+        return;
+    }
+
+#if CONFIG_SOCKET_EVENT_LOOP_SHARDED
+    // Shard i no core do perfil deslocado de i - o shard 0 roda na task do servidor
+    for (int i = 1; i < EVENT_LOOP_SHARDS; i++) {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "event_loop_%d", i);
+        if (xTaskCreatePinnedToCore(task_event_loop_shard, name, TCP_SERVER_TASK_STACK, &s_shards[i],
+                                    task_profile_get(TASK_PROFILE_ROLE_EVENT_LOOP)->priority, NULL,
+                                    task_profile_core(TASK_PROFILE_ROLE_EVENT_LOOP, i)) != pdPASS) {
+            ASYNC_LOGE(TAG_SOCKET, "Não foi possível criar a task do event loop %d", i);
+            return;
+        }
+    }
+#endif
+
+    event_loop_shard_run(&s_shards[0], sock_listen);
+}
@@ -0,0 +1,352 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "async_log.h"
+#include "task_profile.h"
+#include "boot_trace.h"
+
+#include "lwip/api.h"
+#include "lwip/tcp.h"
+#include "lwip/priv/tcp_priv.h"
+#include "lwip/priv/tcpip_priv.h"
+
+#include "tcp_server.h"
+
+// Menuconfig - Socket
+#define EXAMPLE_ESP_SOCKET_PORT         CONFIG_ESP_SOCKET_PORT
+#define EXAMPLE_KEEPALIVE_IDLE          CONFIG_KEEPALIVE_IDLE
+#define EXAMPLE_KEEPALIVE_INTERVAL      CONFIG_KEEPALIVE_INTERVAL
+#define EXAMPLE_KEEPALIVE_COUNT         CONFIG_KEEPALIVE_COUNT
+
+// Menuconfig - Netconn
+#define NETCONN_MAX_HELD_PBUFS          CONFIG_SOCKET_NETCONN_MAX_HELD_PBUFS
+#define NETCONN_IDLE_TIMEOUT_MS         CONFIG_SOCKET_IDLE_TIMEOUT_MS
+#define NETCONN_WRITE_TIMEOUT_MS        CONFIG_SOCKET_WRITE_TIMEOUT_MS
+
+// Espera pelo ACK dos dados presos antes de fechar a conexão
+#define NETCONN_ACK_POLL_MS             10
+#define NETCONN_CLOSE_ACK_TIMEOUT_MS    (NETCONN_WRITE_TIMEOUT_MS > 0 ? NETCONN_WRITE_TIMEOUT_MS : 5000)
+
+// Tags de depuração:
+static const char *TAG_SOCKET = "DEBUG - TCP-SOCKET";
+
+// Tabela de conexões - admissão (limite global e por IP) e handles para as tasks
+static conn_table_t s_conn_table;
+
+// Estado do echo sem cópia de uma conexão.
+// NETCONN_NOCOPY faz o lwIP apontar os segmentos para a memória do pbuf recebido, então o
+// pbuf só pode ser liberado quando nenhum segmento na fila do TCP o referenciar - até lá o lwIP
+// pode precisar retransmiti-lo. Os pbufs ficam encadeados em held, na ordem de envio.
+typedef struct {
+    struct netconn *conn;
+    struct pbuf *held;      // Pbufs enviados por referência e ainda não confirmados
+    uint32_t ack_base;      // snd_lbb do pcb antes do primeiro envio
+    uint32_t nocopy_sent;   // Bytes enviados por referência (posição do fim de held)
+    uint32_t released;      // Bytes confirmados e já liberados (posição do início de held)
+    uint32_t copied;        // Bytes enviados com cópia (limite de pbufs presos atingido)
+} netconn_echo_t;
+
+// O pcb pertence à task tcpip e pode ser liberado por ela a qualquer momento (RST, abort):
+// todo acesso passa por tcpip_api_call, que confere conn->pcb.tcp já dentro da task tcpip
+typedef struct {
+    struct tcpip_api_call_data call;
+    struct netconn *conn;
+    bool has_pcb;
+    uint32_t seqno;
+} netconn_tcp_msg_t;
+
+// Function - Enable keepalive and read the send base (tcpip thread)
+static err_t netconn_setup_fn(struct tcpip_api_call_data *call) {
+
+    netconn_tcp_msg_t *msg = (netconn_tcp_msg_t *)call;
+    struct tcp_pcb *pcb = msg->conn->pcb.tcp;
+
+    msg->has_pcb = pcb != NULL;
+    if (pcb != NULL) {
+        ip_set_option(pcb, SOF_KEEPALIVE);
+        pcb->keep_idle = EXAMPLE_KEEPALIVE_IDLE * 1000;
+        pcb->keep_intvl = EXAMPLE_KEEPALIVE_INTERVAL * 1000;
+        pcb->keep_cnt = EXAMPLE_KEEPALIVE_COUNT;
+        msg->seqno = pcb->snd_lbb;
+    }
+    return ERR_OK;
+}
+
+// Function - Oldest sequence number still referenced by the TCP queues (tcpip thread)
+// Um segmento só sai da fila com o ACK de todos os seus bytes e é retransmitido inteiro, mesmo
+// com ACK parcial - e pode juntar o fim de um pbuf ao início do seguinte. O início do segmento
+// mais antigo (em unacked ou, depois de uma retransmissão, em unsent) é o limite seguro
+static err_t netconn_queued_seqno_fn(struct tcpip_api_call_data *call) {
+
+    netconn_tcp_msg_t *msg = (netconn_tcp_msg_t *)call;
+    struct tcp_pcb *pcb = msg->conn->pcb.tcp;
+
+    msg->has_pcb = pcb != NULL;
+    if (pcb != NULL) {
+        uint32_t seqno = pcb->snd_lbb;
+        if (pcb->unsent != NULL) {
+            seqno = lwip_ntohl(pcb->unsent->tcphdr->seqno);
+        }
+        if (pcb->unacked != NULL && TCP_SEQ_LT(lwip_ntohl(pcb->unacked->tcphdr->seqno), seqno)) {
+            seqno = lwip_ntohl(pcb->unacked->tcphdr->seqno);
+        }
+        msg->seqno = seqno;
+    }
+    return ERR_OK;
+}
+
+// Bytes que nenhum segmento na fila do TCP referencia mais. Sem pcb (RST/abort) o lwIP já
+// liberou todos os segmentos
+static uint32_t netconn_echo_acked(netconn_echo_t *echo) {
+
+    netconn_tcp_msg_t msg = { .conn = echo->conn };
+    uint32_t total = echo->nocopy_sent + echo->copied;
+
+    tcpip_api_call(netconn_queued_seqno_fn, &msg.call);
+    if (!msg.has_pcb) {
+        return total;
+    }
+    uint32_t acked = msg.seqno - echo->ack_base;
+    return acked < total ? acked : total;
+}
+
+// Libera os pbufs presos cujos bytes já foram confirmados
+static void netconn_echo_release(netconn_echo_t *echo) {
+
+    if (echo->held == NULL) {
+        return;
+    }
+
+    // Os bytes copiados e os enviados por referência compartilham a mesma sequência TCP.
+    // Os copiados não precisam de ACK, então o limite é conservador: libera até o mínimo
+    uint32_t acked = netconn_echo_acked(echo);
+    uint32_t acked_nocopy = acked > echo->copied ? acked - echo->copied : 0;
+    if (acked_nocopy > echo->nocopy_sent) {
+        acked_nocopy = echo->nocopy_sent;
+    }
+
+    while (echo->held != NULL && acked_nocopy > echo->released) {
+        uint32_t step = acked_nocopy - echo->released;
+        if (step > UINT16_MAX) {
+            step = UINT16_MAX;
+        }
+        echo->held = pbuf_free_header(echo->held, (u16_t)step);
+        echo->released += step;
+    }
+}
+
+// Function - Abort the connection (tcpip thread): RST and free all queued segments
+static err_t netconn_abort_fn(struct tcpip_api_call_data *call) {
+
+    netconn_tcp_msg_t *msg = (netconn_tcp_msg_t *)call;
+    if (msg->conn->pcb.tcp != NULL) {
+        tcp_abort(msg->conn->pcb.tcp);
+    }
+    return ERR_OK;
+}
+
+// Function - Echo one received pbuf chain
+static err_t netconn_echo_chain(netconn_echo_t *echo, struct pbuf *p) {
+
+    err_t err = ERR_OK;
+
+    netconn_echo_release(echo);
+
+    // Acima do limite (ou tot_len de held perto do máximo de 16 bits) o echo copia
+    bool nocopy = NETCONN_MAX_HELD_PBUFS > 0 &&
+                  (echo->held == NULL || (pbuf_clen(echo->held) + pbuf_clen(p) <= NETCONN_MAX_HELD_PBUFS &&
+                                          (uint32_t)echo->held->tot_len + p->tot_len <= UINT16_MAX));
+
+    for (struct pbuf *q = p; q != NULL && err == ERR_OK; q = q->next) {
+        u8_t flags = (nocopy ? NETCONN_NOCOPY : NETCONN_COPY) | (q->next != NULL ? NETCONN_MORE : 0);
+        err = netconn_write(echo->conn, q->payload, q->len, flags);
+    }
+
+    if (nocopy) {
+        // A cadeia passa a pertencer a held mesmo com erro - parte dela pode estar na fila do TCP
+        echo->nocopy_sent += p->tot_len;
+        if (echo->held == NULL) {
+            echo->held = p;
+        } else {
+            pbuf_cat(echo->held, p);
+        }
+    } else {
+        echo->copied += p->tot_len;
+        pbuf_free(p);
+    }
+    return err;
+}
+
+// Function - Close the connection once the held pbufs are no longer referenced by the TCP queue
+static void netconn_echo_close(netconn_echo_t *echo, int index) {
+
+    uint32_t waited_ms = 0;
+
+    netconn_echo_release(echo);
+    while (echo->held != NULL && waited_ms < NETCONN_CLOSE_ACK_TIMEOUT_MS) {
+        vTaskDelay(pdMS_TO_TICKS(NETCONN_ACK_POLL_MS));
+        waited_ms += NETCONN_ACK_POLL_MS;
+        netconn_echo_release(echo);
+    }
+
+    if (echo->held != NULL) {
+        // Cliente não confirmou os dados - o close normal deixaria o pcb retransmitindo
+        // a partir dos pbufs presos. O abort descarta os segmentos antes de liberá-los
+        ASYNC_LOGW(TAG_SOCKET, "[CLIENT-%d] Dados sem ACK no fechamento, abortando conexão", index);
+        netconn_tcp_msg_t msg = { .conn = echo->conn };
+        tcpip_api_call(netconn_abort_fn, &msg.call);
+        pbuf_free(echo->held);
+        echo->held = NULL;
+    }
+
+    netconn_close(echo->conn);
+    netconn_delete(echo->conn);
+}
+
+// Function - Serve a netconn client until it disconnects (echo sem cópia)
+static void netconn_client_serve(Struct_Socket_clients *client) {
+
+    netconn_echo_t echo = {
+        .conn = client->netconn,
+    };
+
+    // Timeouts do menuconfig (0 = sem timeout, igual ao padrão do netconn)
+    netconn_set_recvtimeout(echo.conn, NETCONN_IDLE_TIMEOUT_MS);
+    netconn_set_sendtimeout(echo.conn, NETCONN_WRITE_TIMEOUT_MS);
+
+    // Set tcp keepalive option - no pcb, pela task tcpip, uma única vez
+    netconn_tcp_msg_t setup = { .conn = echo.conn };
+    tcpip_api_call(netconn_setup_fn, &setup.call);
+    echo.ack_base = setup.seqno;
+
+    for (;;) {
+        struct pbuf *p;
+
+        // receive data on the connected netconn - a cadeia de pbufs vem por referência
+        err_t err = netconn_recv_tcp_pbuf(echo.conn, &p);
+        if (err != ERR_OK) {
+            if (err == ERR_TIMEOUT) {
+                ASYNC_LOGW(TAG_SOCKET, "[CLIENT-%d] Timeout de inatividade", client->index);
+            } else if (err == ERR_CLSD) {
+                ASYNC_LOGI(TAG_SOCKET, "[CLIENT-%d] Conexão fechada", client->index);
+            } else {
+                ASYNC_LOGE(TAG_SOCKET, "[CLIENT-%d] Recv falhou: err %d", client->index, err);
+            }
+            break;
+        }
+
+        ASYNC_LOGI(TAG_SOCKET, "[CLIENT-%d] Recebidos [%d bytes]", client->index, p->tot_len);
+
+        // Echo back to sender
+        err = netconn_echo_chain(&echo, p);
+        if (err != ERR_OK) {
+            ASYNC_LOGE(TAG_SOCKET, "[CLIENT-%d] Send falhou: err %d", client->index, err);
+            break;
+        }
+    }
+
+    ASYNC_LOGI(TAG_SOCKET, "[CLIENT-%d] Encerrada - %u bytes sem cópia, %u copiados", client->index,
+               (unsigned)echo.nocopy_sent, (unsigned)echo.copied);
+    netconn_echo_close(&echo, client->index);
+    client->netconn = NULL;
+}
+
+// Task - Manager netconn clients
+static void task_netconn_client_handle(void* pvParameters) {
+
+    Struct_Socket_clients *client = conn_table_get(&s_conn_table, (conn_handle_t)(uintptr_t)pvParameters);
+
+    if (client != NULL) {
+        netconn_client_serve(client);
+        conn_table_release(&s_conn_table, client);
+    }
+    vTaskDelete(NULL);
+}
+
+// Task = Netconn TCP/IP Server
+void task_tcp_netconn_server(void* pvParameters) {
+
+    struct netconn *listener = netconn_new(NETCONN_TCP);
+    if (listener == NULL) {
+        ASYNC_LOGE(TAG_SOCKET, "Não foi possível criar o netconn");
+        tcp_server_listen_done(ESP_FAIL);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    err_t err = netconn_bind(listener, IP_ADDR_ANY, EXAMPLE_ESP_SOCKET_PORT);
+    if (err == ERR_OK) {
+        err = netconn_listen(listener);
+    }
+    if (err != ERR_OK) {
+        ASYNC_LOGE(TAG_SOCKET, "Netconn incapaz de escutar: err %d", err);
+        netconn_delete(listener);
+        tcp_server_listen_done(ESP_FAIL);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    ASYNC_LOGI(TAG_SOCKET, "Netconn escutando na porta %d", EXAMPLE_ESP_SOCKET_PORT);
+
+    // Linha do tempo do boot e estágio dos listeners
+    boot_trace_mark(BOOT_TRACE_LISTEN);
+    tcp_server_listen_done(ESP_OK);
+
+    conn_table_init(&s_conn_table);
+
+    for (;;) {
+        struct netconn *conn;
+
+        err = netconn_accept(listener, &conn);
+        if (err != ERR_OK) {
+            // ERR_ABRT/ERR_MEM: conexão perdida antes do accept, o listener continua válido
+            if (err == ERR_ABRT || err == ERR_MEM) {
+                continue;
+            }
+            ASYNC_LOGE(TAG_SOCKET, "Não foi possível aceitar a conexão: err %d", err);
+            break;
+        }
+
+        ip_addr_t addr;
+        u16_t port;
+        netconn_getaddr(conn, &addr, &port, 0);
+        struct sockaddr_in client_addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons(port),
+            .sin_addr.s_addr = ip_2_ip4(&addr)->addr,
+        };
+
+        // Admissão - reserva uma posição na tabela de conexões (limite global e por IP)
+        conn_admit_t admit;
+        Struct_Socket_clients *client = conn_table_alloc(&s_conn_table, &client_addr, &admit);
+        if (client == NULL) {
+            ASYNC_LOGW(TAG_SOCKET, "%s, conexão recusada",
+                       admit == CONN_ADMIT_IP_LIMIT ? "Limite de conexões por IP atingido" : "Tabela de conexões cheia");
+            netconn_close(conn);
+            netconn_delete(conn);
+            continue;
+        }
+        client->netconn = conn;
+
+        // Log - Debug (IP como inteiros - o log assíncrono não pode guardar ponteiro para a stack)
+        uint32_t ip = ntohl(client_addr.sin_addr.s_addr);
+        ASYNC_LOGI(TAG_SOCKET, "[CLIENT-%d] Endereço IP aceito pelo Netconn: %d.%d.%d.%d", client->index,
+                   (int)(ip >> 24), (int)((ip >> 16) & 0xFF), (int)((ip >> 8) & 0xFF), (int)(ip & 0xFF));
+
+        conn_handle_t handle = conn_table_handle(client);
+        if (task_profile_create(task_netconn_client_handle, "netconn_client", TCP_SERVER_TASK_STACK, (void*)(uintptr_t)handle,
+                                TASK_PROFILE_ROLE_CLIENT, NULL) != pdPASS) {
+            ASYNC_LOGE(TAG_SOCKET, "[CLIENT-%d] Não foi possível criar a task do cliente", client->index);
+            netconn_close(conn);
+            netconn_delete(conn);
+            conn_table_release(&s_conn_table, client);
+        }
+    }
+
+    // Task error
+    ASYNC_LOGE(TAG_SOCKET, "1 - Desligando o netconn e reiniciando...");
+    netconn_close(listener);
+    netconn_delete(listener);
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "net_sockets.h"
+
+#include "conn_io.h"
+
+// Stack das tasks do servidor. Na build linux as tasks são pthreads e o mínimo é PTHREAD_STACK_MIN
+#if CONFIG_IDF_TARGET_LINUX
+#define TCP_SERVER_TASK_STACK           16384
+#else
+#define TCP_SERVER_TASK_STACK           4096
+#endif
+
+// Event loop - atende o socket de escuta e todos os clientes em uma única task
+// (com SOCKET_EVENT_LOOP_SHARDED, cria também os event loops dos demais shards).
+// As conexões aceitas usam o handler do listener
+void tcp_event_loop_run(int sock_listen, const conn_listener_t *listener);
+
+// Orquestrador de inicialização - a task do servidor fecha o estágio dos listeners no listen
+// (ESP_OK) ou na falha antes dele
+void tcp_server_listen_done(esp_err_t err);
+
+// Atende um cliente conectado com o handler do listener até a conexão ser encerrada e fecha o socket
+void socket_client_serve(Struct_Socket_clients *client);
+
+// Pool de workers - cria as tasks (stacks estáticas) e a fila de conexões
+void tcp_worker_pool_init(conn_table_t *table);
+
+// Entrega uma conexão aceita ao pool. Retorna false se a fila estiver cheia
+bool tcp_worker_pool_dispatch(conn_handle_t handle);
+
+// Modo netconn - task do servidor: escuta com a API netconn e cria uma task por cliente
+void task_tcp_netconn_server(void* pvParameters);
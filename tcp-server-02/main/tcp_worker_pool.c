@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "async_log.h"
+#include "task_profile.h"
+
+#include "tcp_server.h"
+
+// Menuconfig - Worker pool
+#define WORKER_POOL_SIZE                CONFIG_SOCKET_WORKER_POOL_SIZE
+#define WORKER_QUEUE_LEN                CONFIG_SOCKET_WORKER_QUEUE_LEN
+#define WORKER_STACK_SIZE               TCP_SERVER_TASK_STACK
+
+// Tags de depuração:
+static const char *TAG_SOCKET = "DEBUG - TCP-SOCKET";
+
+// Stacks e TCBs alocados estaticamente - nenhuma alocação no caminho do accept()
+static StackType_t s_worker_stacks[WORKER_POOL_SIZE][WORKER_STACK_SIZE];
+static StaticTask_t s_worker_tcbs[WORKER_POOL_SIZE];
+
+// Fila de conexões aceitas aguardando um worker livre
+static uint8_t s_queue_storage[WORKER_QUEUE_LEN * sizeof(conn_handle_t)];
+static StaticQueue_t s_queue_struct;
+static QueueHandle_t s_client_queue;
+
+// Tabela de conexões dona dos clientes entregues ao pool
+static conn_table_t *s_conn_table;
+
+// Task - Worker: atende uma conexão por vez, retirada da fila
+static void task_socket_worker(void* pvParameters) {
+
+    conn_handle_t handle;
+
+    for (;;) {
+        if (xQueueReceive(s_client_queue, &handle, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        Struct_Socket_clients *Struct_Socket_client_x = conn_table_get(s_conn_table, handle);
+        if (Struct_Socket_client_x != NULL) {
+            socket_client_serve(Struct_Socket_client_x);
+            conn_table_release(s_conn_table, Struct_Socket_client_x);
+        }
+    }
+}
+
+void tcp_worker_pool_init(conn_table_t *table) {
+
+    s_conn_table = table;
+    s_client_queue = xQueueCreateStatic(WORKER_QUEUE_LEN, sizeof(conn_handle_t), s_queue_storage, &s_queue_struct);
+
+    // Workers atendem clientes - core e prioridade do papel "clientes" do perfil
+    const task_profile_t *profile = task_profile_get(TASK_PROFILE_ROLE_CLIENT);
+    for (int i = 0; i < WORKER_POOL_SIZE; i++) {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "sock_worker_%d", i);
+        xTaskCreateStaticPinnedToCore(task_socket_worker, name, WORKER_STACK_SIZE, NULL, profile->priority,
+                                      s_worker_stacks[i], &s_worker_tcbs[i], profile->core);
+    }
+
+    ASYNC_LOGI(TAG_SOCKET, "Pool de workers iniciado - %d workers, fila de %d conexões", WORKER_POOL_SIZE, WORKER_QUEUE_LEN);
+}
+
+bool tcp_worker_pool_dispatch(conn_handle_t handle) {
+
+    // Timeout zero - o accept nunca bloqueia esperando um worker
+    return xQueueSend(s_client_queue, &handle, 0) == pdTRUE;
+}
@@ -0,0 +1,135 @@
+#include "timer_wheel.h"
+
+#define TIMER_WHEEL_MASK                (TIMER_WHEEL_SLOTS - 1)
+
+_Static_assert((TIMER_WHEEL_SLOTS & TIMER_WHEEL_MASK) == 0, "TIMER_WHEEL_SLOTS must be a power of two");
+
+static void link_init(timer_wheel_link_t *head) {
+
+    head->next = head;
+    head->prev = head;
+}
+
+static void link_insert(timer_wheel_link_t *head, timer_wheel_link_t *link) {
+
+    link->prev = head->prev;
+    link->next = head;
+    head->prev->next = link;
+    head->prev = link;
+}
+
+static void link_remove(timer_wheel_link_t *link) {
+
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->next = NULL;
+    link->prev = NULL;
+}
+
+void timer_wheel_init(timer_wheel_t *wheel, uint32_t tick_ms, uint32_t now_ms) {
+
+    for (int i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        link_init(&wheel->slots[i]);
+    }
+    wheel->tick_ms = tick_ms;
+    wheel->current = 0;
+    wheel->last_ms = now_ms;
+    wheel->armed = 0;
+}
+
+void timer_wheel_node_init(timer_wheel_node_t *node, void *owner, uint8_t kind) {
+
+    node->link.next = NULL;
+    node->link.prev = NULL;
+    node->expires = 0;
+    node->owner = owner;
+    node->kind = kind;
+}
+
+void timer_wheel_schedule(timer_wheel_t *wheel, timer_wheel_node_t *node, uint32_t now_ms, uint32_t timeout_ms) {
+
+    if (timer_wheel_node_armed(node)) {
+        link_remove(&node->link);
+    } else {
+        wheel->armed++;
+    }
+
+    // Relativo ao tick current: conta o que já passou dele (advance ainda não chamado) e arredonda
+    // para cima - nunca vence antes e nunca cai no tick atual ou já processado
+    int32_t behind_ms = (int32_t)(now_ms - wheel->last_ms);
+    uint64_t delay_ms = (uint64_t)(behind_ms > 0 ? behind_ms : 0) + timeout_ms;
+    uint64_t ticks = (delay_ms + wheel->tick_ms - 1) / wheel->tick_ms;
+    if (ticks == 0) {
+        ticks = 1;
+    }
+    if (ticks > INT32_MAX) {
+        ticks = INT32_MAX;
+    }
+    uint32_t expires = wheel->current + (uint32_t)ticks;
+
+    node->expires = expires;
+    link_insert(&wheel->slots[expires & TIMER_WHEEL_MASK], &node->link);
+}
+
+void timer_wheel_cancel(timer_wheel_t *wheel, timer_wheel_node_t *node) {
+
+    if (timer_wheel_node_armed(node)) {
+        link_remove(&node->link);
+        wheel->armed--;
+    }
+}
+
+uint32_t timer_wheel_advance(timer_wheel_t *wheel, uint32_t now_ms, timer_wheel_expired_t expired, void *ctx) {
+
+    // Diferença em uint32 - correta através da volta do relógio em ms
+    int32_t elapsed_ms = (int32_t)(now_ms - wheel->last_ms);
+    uint32_t fired = 0;
+
+    if (elapsed_ms < (int32_t)wheel->tick_ms) {
+        return 0;
+    }
+    uint32_t steps = (uint32_t)elapsed_ms / wheel->tick_ms;
+    uint32_t base = wheel->current;
+    uint32_t target = base + steps;
+
+    // Já no tick novo - um nó reagendado pelo callback conta a partir de agora
+    wheel->current = target;
+    wheel->last_ms += steps * wheel->tick_ms;
+
+    // Atraso maior que uma volta: cada slot é visitado uma vez, comparando com o tick atual
+    if (steps > TIMER_WHEEL_SLOTS) {
+        steps = TIMER_WHEEL_SLOTS;
+    }
+
+    for (uint32_t i = 1; i <= steps; i++) {
+        timer_wheel_link_t *slot = &wheel->slots[(base + i) & TIMER_WHEEL_MASK];
+
+        // Move o slot para uma lista local - o callback pode cancelar ou reagendar qualquer nó
+        timer_wheel_link_t pending;
+        if (slot->next == slot) {
+            continue;
+        }
+        pending.next = slot->next;
+        pending.prev = slot->prev;
+        pending.next->prev = &pending;
+        pending.prev->next = &pending;
+        link_init(slot);
+
+        while (pending.next != &pending) {
+            timer_wheel_node_t *node = (timer_wheel_node_t *)pending.next;
+            link_remove(&node->link);
+
+            if ((int32_t)(node->expires - target) > 0) {
+                // Ainda faltam voltas
+                link_insert(&wheel->slots[node->expires & TIMER_WHEEL_MASK], &node->link);
+                continue;
+            }
+
+            wheel->armed--;
+            fired++;
+            expired(node, ctx);
+        }
+    }
+
+    return fired;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Timer wheel hasheado: agendar, cancelar e reagendar em O(1). Cada slot cobre um tick;
+// prazos maiores que uma volta ficam no slot e esperam as voltas seguintes.
+// Os ticks são contados pelo próprio wheel a partir da diferença entre chamadas: o relógio em ms
+// pode dar a volta em 2^32 (49,7 dias) sem mover os prazos.
+// Não é thread-safe - pertence à task que o avança.
+#define TIMER_WHEEL_SLOTS               64
+
+// Elo da lista circular de cada slot
+typedef struct timer_wheel_link {
+    struct timer_wheel_link *next;
+    struct timer_wheel_link *prev;
+} timer_wheel_link_t;
+
+// Nó embutido no dono (ex.: um por prazo de cada conexão)
+typedef struct {
+    timer_wheel_link_t link;    // Primeiro campo - link.next == NULL indica nó desarmado
+    uint32_t expires;           // Tick de expiração, no contador do wheel
+    void *owner;
+    uint8_t kind;
+} timer_wheel_node_t;
+
+typedef struct {
+    timer_wheel_link_t slots[TIMER_WHEEL_SLOTS];
+    uint32_t tick_ms;
+    uint32_t current;           // Ticks processados desde o init - comparados por diferença com sinal
+    uint32_t last_ms;           // Instante do tick current - o resto de um advance fica para o próximo
+    uint32_t armed;             // Nós agendados
+} timer_wheel_t;
+
+// Chamado para cada nó vencido, já desarmado - pode reagendar ou cancelar qualquer nó
+typedef void (*timer_wheel_expired_t)(timer_wheel_node_t *node, void *ctx);
+
+void timer_wheel_init(timer_wheel_t *wheel, uint32_t tick_ms, uint32_t now_ms);
+
+// Prepara o nó (desarmado) com o dono e o tipo devolvidos no callback
+void timer_wheel_node_init(timer_wheel_node_t *node, void *owner, uint8_t kind);
+
+// Agenda (ou reagenda) o nó para now_ms + timeout_ms, arredondado para cima até o próximo tick
+void timer_wheel_schedule(timer_wheel_t *wheel, timer_wheel_node_t *node, uint32_t now_ms, uint32_t timeout_ms);
+
+// Desarma o nó. Sem efeito se ele não estiver agendado
+void timer_wheel_cancel(timer_wheel_t *wheel, timer_wheel_node_t *node);
+
+// Processa os ticks até now_ms e chama o callback para os nós vencidos. Retorna quantos venceram
+uint32_t timer_wheel_advance(timer_wheel_t *wheel, uint32_t now_ms, timer_wheel_expired_t expired, void *ctx);
+
+static inline bool timer_wheel_node_armed(const timer_wheel_node_t *node) {
+    return node->link.next != NULL;
+}
+
+static inline bool timer_wheel_is_empty(const timer_wheel_t *wheel) {
+    return wheel->armed == 0;
+}
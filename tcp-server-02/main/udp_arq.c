@@ -0,0 +1,368 @@
+#include <string.h>
+#include <sys/param.h>
+
+#include "udp_arq.h"
+
+// Segmento sem ACK após este número de envios encerra a sessão
+#define UDP_ARQ_DEAD_LINK               20
+#define UDP_ARQ_INITIAL_RTO_MS          200
+#define UDP_ARQ_MAX_RTO_MS              60000
+// Intervalo das perguntas de janela enquanto o par anunciar zero
+#define UDP_ARQ_PROBE_MS                500
+
+_Static_assert(UDP_ARQ_MSS > 0, "SOCKET_UDP_MTU must be larger than the ARQ header");
+_Static_assert(UDP_ARQ_MSS <= UINT16_MAX, "SOCKET_UDP_MTU must fit the 16-bit segment length");
+
+typedef struct {
+    uint32_t conv;
+    uint8_t cmd;
+    uint16_t wnd;
+    uint32_t ts;
+    uint32_t sn;
+    uint32_t una;
+    uint32_t off;
+    uint16_t len;
+} udp_arq_header_t;
+
+// Datagrama em montagem - sai pelo output quando o próximo segmento não couber
+typedef struct {
+    uint8_t *buf;
+    uint32_t len;
+    udp_arq_output_t output;
+    void *ctx;
+} udp_arq_out_t;
+
+static uint8_t *arq_put16(uint8_t *p, uint16_t value) {
+
+    p[0] = value >> 8;
+    p[1] = value;
+    return p + 2;
+}
+
+static uint8_t *arq_put32(uint8_t *p, uint32_t value) {
+
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+    return p + 4;
+}
+
+static inline uint16_t arq_get16(const uint8_t *p) {
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static inline uint32_t arq_get32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static uint8_t *arq_encode(uint8_t *p, const udp_arq_header_t *h) {
+
+    p = arq_put32(p, h->conv);
+    *p++ = h->cmd;
+    *p++ = 0;
+    p = arq_put16(p, h->wnd);
+    p = arq_put32(p, h->ts);
+    p = arq_put32(p, h->sn);
+    p = arq_put32(p, h->una);
+    p = arq_put32(p, h->off);
+    return arq_put16(p, h->len);
+}
+
+static void arq_decode(const uint8_t *p, udp_arq_header_t *h) {
+
+    h->conv = arq_get32(p);
+    h->cmd = p[4];
+    h->wnd = arq_get16(p + 6);
+    h->ts = arq_get32(p + 8);
+    h->sn = arq_get32(p + 12);
+    h->una = arq_get32(p + 16);
+    h->off = arq_get32(p + 20);
+    h->len = arq_get16(p + 24);
+}
+
+static void arq_out_emit(udp_arq_out_t *out) {
+
+    if (out->len > 0) {
+        out->output(out->buf, out->len, out->ctx);
+        out->len = 0;
+    }
+}
+
+// Function - Room for one more segment in the datagram, emitting the current one if needed
+static uint8_t *arq_out_reserve(udp_arq_out_t *out, uint32_t len) {
+
+    if (out->len + len > UDP_ARQ_MTU) {
+        arq_out_emit(out);
+    }
+    uint8_t *p = out->buf + out->len;
+    out->len += len;
+    return p;
+}
+
+void udp_arq_init(udp_arq_t *arq, uint32_t conv) {
+
+    memset(arq, 0, sizeof(*arq));
+    arq->conv = conv;
+    arq->rto = UDP_ARQ_INITIAL_RTO_MS;
+    // Até o par anunciar a janela, um segmento por vez
+    arq->rmt_wnd = UDP_ARQ_MSS;
+}
+
+bool udp_arq_peek_conv(const uint8_t *data, uint32_t len, uint32_t *conv) {
+
+    if (len < UDP_ARQ_HEADER_LEN) {
+        return false;
+    }
+    *conv = arq_get32(data);
+    return true;
+}
+
+// Function - Slide snd_una over the acknowledged segments and release their bytes
+static void arq_advance_una(udp_arq_t *arq, ring_buffer_t *tx) {
+
+    while (arq->snd_una != arq->snd_nxt && arq->snd[arq->snd_una % UDP_ARQ_WINDOW].acked) {
+        arq->snd_una++;
+    }
+    // Bytes do TX ring só saem com o ACK cumulativo - até lá podem ser retransmitidos
+    uint32_t tail = arq->snd_una == arq->snd_nxt ? arq->snd_end : arq->snd[arq->snd_una % UDP_ARQ_WINDOW].off;
+    ring_buffer_consume(tx, tail - tx->tail);
+}
+
+// Function - Cumulative ACK: every segment before una arrived
+static void arq_ack_until(udp_arq_t *arq, ring_buffer_t *tx, uint32_t una) {
+
+    if ((int32_t)(una - arq->snd_una) <= 0 || (int32_t)(una - arq->snd_nxt) > 0) {
+        return;
+    }
+    for (uint32_t sn = arq->snd_una; sn != una; sn++) {
+        arq->snd[sn % UDP_ARQ_WINDOW].acked = true;
+    }
+    arq_advance_una(arq, tx);
+}
+
+// Function - Selective ACK of one segment
+static void arq_ack_one(udp_arq_t *arq, ring_buffer_t *tx, uint32_t sn) {
+
+    if ((int32_t)(sn - arq->snd_una) < 0 || (int32_t)(sn - arq->snd_nxt) >= 0) {
+        return;
+    }
+    arq->snd[sn % UDP_ARQ_WINDOW].acked = true;
+    arq_advance_una(arq, tx);
+}
+
+// Function - Count the ACKs that skipped over each older segment (retransmissão rápida)
+static void arq_fastack(udp_arq_t *arq, uint32_t maxack) {
+
+    for (uint32_t sn = arq->snd_una; (int32_t)(maxack - sn) > 0; sn++) {
+        udp_arq_seg_t *seg = &arq->snd[sn % UDP_ARQ_WINDOW];
+        if (!seg->acked && seg->xmit > 0 && seg->fastack < UINT8_MAX) {
+            seg->fastack++;
+        }
+    }
+}
+
+static inline bool arq_fast_resend_due(const udp_arq_seg_t *seg) {
+
+#if UDP_ARQ_FAST_RESEND > 0
+    return seg->fastack >= UDP_ARQ_FAST_RESEND;
+#else
+    return false;
+#endif
+}
+
+// Function - RTT sample from an echoed timestamp (estimador do TCP, como no KCP)
+static void arq_update_rtt(udp_arq_t *arq, uint32_t rtt) {
+
+    if (arq->srtt == 0) {
+        arq->srtt = rtt;
+        arq->rttvar = rtt / 2;
+    } else {
+        uint32_t delta = rtt > arq->srtt ? rtt - arq->srtt : arq->srtt - rtt;
+        arq->rttvar = (3 * arq->rttvar + delta) / 4;
+        arq->srtt = MAX(1, (7 * arq->srtt + rtt) / 8);
+    }
+    uint32_t rto = arq->srtt + MAX(UDP_ARQ_INTERVAL_MS, 4 * arq->rttvar);
+    arq->rto = MIN(MAX(rto, UDP_ARQ_MIN_RTO_MS), UDP_ARQ_MAX_RTO_MS);
+}
+
+// Function - Place a data segment in the RX ring and queue its ACK
+static void arq_receive(udp_arq_t *arq, ring_buffer_t *rx, const udp_arq_header_t *h, const uint8_t *payload) {
+
+    uint32_t sn = h->sn;
+    uint32_t slot = sn % UDP_ARQ_WINDOW;
+
+    // Além da janela - sem ACK, o par retransmite depois
+    if ((int32_t)(sn - (arq->rcv_nxt + UDP_ARQ_WINDOW)) >= 0 || h->len == 0) {
+        return;
+    }
+
+    // Novo: grava direto na posição do fluxo. Sem espaço no RX ring também fica sem ACK
+    bool duplicate = (int32_t)(sn - arq->rcv_nxt) < 0 || arq->rcv_len[slot] != 0;
+    if (!duplicate) {
+        uint32_t offset = h->off - rx->head;
+        if ((int32_t)offset < 0 || (sn == arq->rcv_nxt && offset != 0) || !ring_buffer_write_at(rx, offset, payload, h->len)) {
+            return;
+        }
+        arq->rcv_len[slot] = h->len;
+    }
+
+    // Duplicado também é confirmado - o ACK anterior pode ter se perdido
+    if (arq->ack_count < UDP_ARQ_WINDOW) {
+        arq->ack_sn[arq->ack_count] = sn;
+        arq->ack_ts[arq->ack_count] = h->ts;
+        arq->ack_count++;
+    }
+
+    // Entrega em ordem tudo o que ficou contíguo
+    while (arq->rcv_len[arq->rcv_nxt % UDP_ARQ_WINDOW] != 0) {
+        ring_buffer_produce(rx, arq->rcv_len[arq->rcv_nxt % UDP_ARQ_WINDOW]);
+        arq->rcv_len[arq->rcv_nxt % UDP_ARQ_WINDOW] = 0;
+        arq->rcv_nxt++;
+    }
+}
+
+bool udp_arq_input(udp_arq_t *arq, ring_buffer_t *rx, ring_buffer_t *tx, const uint8_t *data, uint32_t len, uint32_t now_ms) {
+
+    bool has_ack = false;
+    uint32_t maxack = 0;
+
+    while (len > 0) {
+        udp_arq_header_t h;
+        if (len < UDP_ARQ_HEADER_LEN) {
+            return false;
+        }
+        arq_decode(data, &h);
+        if (h.conv != arq->conv || h.cmd < UDP_ARQ_CMD_PUSH || h.cmd > UDP_ARQ_CMD_WINS ||
+            h.len > len - UDP_ARQ_HEADER_LEN || (h.cmd != UDP_ARQ_CMD_PUSH && h.len != 0)) {
+            return false;
+        }
+
+        // Todo segmento traz a janela e o ACK cumulativo de quem enviou
+        arq->rmt_wnd = h.wnd;
+        arq_ack_until(arq, tx, h.una);
+
+        switch (h.cmd) {
+        case UDP_ARQ_CMD_ACK:
+            if ((int32_t)(now_ms - h.ts) >= 0) {
+                arq_update_rtt(arq, now_ms - h.ts);
+            }
+            arq_ack_one(arq, tx, h.sn);
+            if (!has_ack || (int32_t)(h.sn - maxack) > 0) {
+                maxack = h.sn;
+                has_ack = true;
+            }
+            break;
+        case UDP_ARQ_CMD_PUSH:
+            arq_receive(arq, rx, &h, data + UDP_ARQ_HEADER_LEN);
+            break;
+        case UDP_ARQ_CMD_WASK:
+            arq->send_wins = true;
+            break;
+        default:
+            break;
+        }
+
+        data += UDP_ARQ_HEADER_LEN + h.len;
+        len -= UDP_ARQ_HEADER_LEN + h.len;
+    }
+
+    if (has_ack) {
+        arq_fastack(arq, maxack);
+    }
+    return true;
+}
+
+void udp_arq_flush(udp_arq_t *arq, const ring_buffer_t *rx, const ring_buffer_t *tx, uint32_t now_ms,
+                   uint8_t *buf, udp_arq_output_t output, void *ctx) {
+
+    udp_arq_out_t out = { .buf = buf, .len = 0, .output = output, .ctx = ctx };
+    udp_arq_header_t h = {
+        .conv = arq->conv,
+        .wnd = MIN(ring_buffer_free(rx), UINT16_MAX),
+        .una = arq->rcv_nxt,
+    };
+
+    // ACKs seletivos, vários por datagrama
+    h.cmd = UDP_ARQ_CMD_ACK;
+    for (uint16_t i = 0; i < arq->ack_count; i++) {
+        h.sn = arq->ack_sn[i];
+        h.ts = arq->ack_ts[i];
+        arq_encode(arq_out_reserve(&out, UDP_ARQ_HEADER_LEN), &h);
+    }
+    arq->ack_count = 0;
+    h.sn = 0;
+    h.ts = now_ms;
+
+    // Janela do par zerada com dados esperando - pergunta de tempos em tempos
+    if (arq->rmt_wnd == 0 && tx->head != arq->snd_end && arq->snd_una == arq->snd_nxt) {
+        if (arq->probe_at == 0) {
+            arq->probe_at = now_ms + UDP_ARQ_PROBE_MS;
+        } else if ((int32_t)(now_ms - arq->probe_at) >= 0) {
+            h.cmd = UDP_ARQ_CMD_WASK;
+            arq_encode(arq_out_reserve(&out, UDP_ARQ_HEADER_LEN), &h);
+            arq->probe_at = now_ms + UDP_ARQ_PROBE_MS;
+        }
+    } else {
+        arq->probe_at = 0;
+    }
+
+    // A nossa janela reabriu depois de anunciada zero (ou o par perguntou) - avisa sem esperar
+    if (arq->send_wins || (arq->wnd_closed && h.wnd > 0)) {
+        h.cmd = UDP_ARQ_CMD_WINS;
+        arq_encode(arq_out_reserve(&out, UDP_ARQ_HEADER_LEN), &h);
+        arq->send_wins = false;
+    }
+    arq->wnd_closed = h.wnd == 0;
+
+    // Segmenta os bytes novos do TX ring, limitado pela janela de segmentos e pela do par
+    uint32_t limit = tx->tail + arq->rmt_wnd;
+    while (arq->snd_nxt - arq->snd_una < UDP_ARQ_WINDOW) {
+        uint32_t room = (int32_t)(limit - arq->snd_end) > 0 ? limit - arq->snd_end : 0;
+        uint32_t len = MIN(UDP_ARQ_MSS, MIN(tx->head - arq->snd_end, room));
+        if (len == 0) {
+            break;
+        }
+        arq->snd[arq->snd_nxt % UDP_ARQ_WINDOW] = (udp_arq_seg_t){ .off = arq->snd_end, .len = len };
+        arq->snd_end += len;
+        arq->snd_nxt++;
+    }
+
+    // Primeiro envio, retransmissão por RTO vencido ou rápida (ACKs posteriores)
+    h.cmd = UDP_ARQ_CMD_PUSH;
+    for (uint32_t sn = arq->snd_una; sn != arq->snd_nxt; sn++) {
+        udp_arq_seg_t *seg = &arq->snd[sn % UDP_ARQ_WINDOW];
+        if (seg->acked) {
+            continue;
+        }
+        if (seg->xmit == 0) {
+            seg->rto = arq->rto;
+        } else if ((int32_t)(now_ms - seg->resend) >= 0) {
+            // Perda - RTO cresce 1,5x, não 2x, para recuperar rápido em enlaces com perda
+            seg->rto = MIN(seg->rto + seg->rto / 2, UDP_ARQ_MAX_RTO_MS);
+        } else if (!arq_fast_resend_due(seg)) {
+            continue;
+        }
+
+        seg->xmit++;
+        seg->fastack = 0;
+        seg->ts = now_ms;
+        seg->resend = now_ms + seg->rto;
+        if (seg->xmit >= UDP_ARQ_DEAD_LINK) {
+            arq->dead = true;
+        }
+
+        h.sn = sn;
+        h.off = seg->off;
+        h.len = seg->len;
+        uint8_t *p = arq_out_reserve(&out, UDP_ARQ_HEADER_LEN + seg->len);
+        ring_buffer_peek(tx, seg->off - tx->tail, arq_encode(p, &h), seg->len);
+    }
+
+    arq_out_emit(&out);
+}
+
+bool udp_arq_is_idle(const udp_arq_t *arq, const ring_buffer_t *tx) {
+
+    return arq->ack_count == 0 && arq->snd_una == arq->snd_nxt && tx->head == arq->snd_end && !arq->send_wins;
+}
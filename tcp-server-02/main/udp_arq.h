@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ring_buffer.h"
+
+// Camada de confiabilidade sobre UDP, no estilo do KCP: fluxo de bytes ordenado e confiável
+// por sessão, com ACK seletivo (um ACK por segmento + o cumulativo una em todo segmento),
+// retransmissão rápida (segmento pulado por FAST_RESEND ACKs posteriores sai de novo sem
+// esperar o RTO), RTO curto calculado do RTT e janela configurável. Sem controle de
+// congestionamento: a janela é o limite, como o modo "nodelay" do KCP.
+//
+// Sem cópias próprias: os bytes enviados ficam no TX ring até o ACK cumulativo e os
+// recebidos fora de ordem vão direto para a posição deles no RX ring. As posições no fluxo
+// são os próprios contadores livres dos rings (zerados no início da sessão).
+// Não depende de sockets nem do FreeRTOS - a mesma fonte roda no cliente do bench.
+//
+// Datagrama: um ou mais segmentos, cada um com cabeçalho de 26 bytes (big-endian) + payload:
+//   conv u32 | cmd u8 | 0 u8 | wnd u16 | ts u32 | sn u32 | una u32 | off u32 | len u16
+//   conv: sessão, escolhida pelo cliente     wnd: bytes livres no RX ring de quem envia
+//   ts:   envio (PUSH) ou ecoado (ACK)       una: próximo sn esperado por quem envia
+//   off:  posição do payload no fluxo        len: bytes de payload (só PUSH)
+
+#define UDP_ARQ_MTU                     CONFIG_SOCKET_UDP_MTU
+#define UDP_ARQ_WINDOW                  CONFIG_SOCKET_UDP_ARQ_WINDOW
+#define UDP_ARQ_INTERVAL_MS             CONFIG_SOCKET_UDP_ARQ_INTERVAL_MS
+#define UDP_ARQ_MIN_RTO_MS              CONFIG_SOCKET_UDP_ARQ_MIN_RTO_MS
+#define UDP_ARQ_FAST_RESEND             CONFIG_SOCKET_UDP_ARQ_FAST_RESEND
+
+#define UDP_ARQ_HEADER_LEN              26
+#define UDP_ARQ_MSS                     (UDP_ARQ_MTU - UDP_ARQ_HEADER_LEN)
+
+// Tipos de segmento
+typedef enum {
+    UDP_ARQ_CMD_PUSH = 1,   // Dados
+    UDP_ARQ_CMD_ACK = 2,    // Confirma um segmento (seletivo)
+    UDP_ARQ_CMD_WASK = 3,   // Pergunta a janela (a do par estava zerada)
+    UDP_ARQ_CMD_WINS = 4,   // Anuncia a janela
+} udp_arq_cmd_t;
+
+// Segmento enviado e ainda sem ACK cumulativo
+typedef struct {
+    uint32_t off;           // Posição no fluxo (contador do TX ring)
+    uint32_t ts;            // Último envio
+    uint32_t resend;        // Prazo da retransmissão
+    uint32_t rto;
+    uint16_t len;
+    uint8_t xmit;           // Envios - 0 = ainda não enviado
+    uint8_t fastack;        // ACKs de segmentos posteriores desde o último envio
+    bool acked;             // ACK seletivo recebido
+} udp_arq_seg_t;
+
+typedef struct {
+    uint32_t conv;
+
+    // Envio - segmentos em [snd_una, snd_nxt); bytes já segmentados até snd_end
+    uint32_t snd_una;
+    uint32_t snd_nxt;
+    uint32_t snd_end;
+    uint32_t rmt_wnd;       // Bytes livres anunciados pelo par, a partir do una
+    udp_arq_seg_t snd[UDP_ARQ_WINDOW];
+
+    // Recepção - rcv_len[sn % janela] != 0: segmento recebido, esperando os anteriores
+    uint32_t rcv_nxt;
+    uint16_t rcv_len[UDP_ARQ_WINDOW];
+
+    // ACKs a enviar no próximo flush
+    uint32_t ack_sn[UDP_ARQ_WINDOW];
+    uint32_t ack_ts[UDP_ARQ_WINDOW];
+    uint16_t ack_count;
+
+    // RTT e RTO (ms)
+    uint32_t srtt;
+    uint32_t rttvar;
+    uint32_t rto;
+
+    // Janela zerada: o par pergunta (WASK) e quem reabre avisa (WINS)
+    uint32_t probe_at;
+    bool send_wins;
+    bool wnd_closed;        // Última janela anunciada era zero
+
+    bool dead;              // Segmento sem ACK após UDP_ARQ_DEAD_LINK envios
+} udp_arq_t;
+
+// Entrega um datagrama pronto ao transporte
+typedef void (*udp_arq_output_t)(const uint8_t *data, uint32_t len, void *ctx);
+
+// Nova sessão. rx e tx devem estar vazios (contadores zerados)
+void udp_arq_init(udp_arq_t *arq, uint32_t conv);
+
+// Sessão do datagrama (conv do primeiro segmento). Retorna false se for curto demais
+bool udp_arq_peek_conv(const uint8_t *data, uint32_t len, uint32_t *conv);
+
+// Processa um datagrama: dados em ordem vão para o RX ring (produzidos), ACKs liberam o TX
+// ring (consumido). Retorna false se o datagrama estiver malformado ou for de outra sessão
+bool udp_arq_input(udp_arq_t *arq, ring_buffer_t *rx, ring_buffer_t *tx, const uint8_t *data, uint32_t len, uint32_t now_ms);
+
+// Envia o que estiver pendente: ACKs, sondas de janela, dados novos do TX ring e
+// retransmissões vencidas ou rápidas. buf: UDP_ARQ_MTU bytes de rascunho
+void udp_arq_flush(udp_arq_t *arq, const ring_buffer_t *rx, const ring_buffer_t *tx, uint32_t now_ms,
+                   uint8_t *buf, udp_arq_output_t output, void *ctx);
+
+// Nada em voo, nada a enviar - quem chama pode dormir mais que UDP_ARQ_INTERVAL_MS
+bool udp_arq_is_idle(const udp_arq_t *arq, const ring_buffer_t *tx);
+
+static inline bool udp_arq_is_dead(const udp_arq_t *arq) {
+    return arq->dead;
+}
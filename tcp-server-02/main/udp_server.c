@@ -0,0 +1,337 @@
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "async_log.h"
+
+#include "net_sockets.h"
+
+#include "udp_server.h"
+#if CONFIG_SOCKET_UDP_RELIABLE
+#include "udp_arq.h"
+#endif
+
+// Menuconfig - Listener UDP
+#define UDP_SERVER_MTU                  CONFIG_SOCKET_UDP_MTU
+#define UDP_SERVER_IDLE_TIMEOUT_MS      CONFIG_SOCKET_UDP_IDLE_TIMEOUT_MS
+#if CONFIG_SOCKET_UDP_RELIABLE
+#define UDP_SERVER_INTERVAL_MS          UDP_ARQ_INTERVAL_MS
+#define UDP_SERVER_MODE_NAME            "com confiabilidade"
+#else
+#define UDP_SERVER_INTERVAL_MS          10
+#define UDP_SERVER_MODE_NAME            "sem confiabilidade"
+#endif
+// Sessões sem nada em voo - o loop acorda só para os timeouts de inatividade
+#define UDP_SERVER_IDLE_CHECK_MS        1000
+
+// Tags de depuração:
+static const char *TAG_UDP = "DEBUG - UDP-SOCKET";
+
+// Estado de cada sessão além do Struct_Socket_clients (mesmo índice da tabela)
+typedef struct {
+    uint32_t last_rx_ms;
+#if CONFIG_SOCKET_UDP_RELIABLE
+    udp_arq_t arq;
+#endif
+} udp_session_t;
+
+// Tabela própria - sessões UDP não disputam posições com as conexões TCP
+static conn_table_t s_udp_table;
+static udp_session_t s_sessions[CONN_TABLE_CAPACITY];
+static const conn_listener_t *s_listener;
+static int s_sock = -1;
+
+// O par só é conhecido depois do recvfrom - o datagrama passa por este buffer antes do RX ring
+static uint8_t s_rx_datagram[UDP_SERVER_MTU];
+#if CONFIG_SOCKET_UDP_RELIABLE
+static uint8_t s_tx_datagram[UDP_SERVER_MTU];
+#endif
+
+static inline uint32_t udp_now_ms(void) {
+    return pdTICKS_TO_MS(xTaskGetTickCount());
+}
+
+// Function - Session of a peer (IP e porta) - busca linear, a tabela é pequena
+static Struct_Socket_clients *udp_session_find(const struct sockaddr_in *addr) {
+
+    for (int i = 0; i < CONN_TABLE_CAPACITY; i++) {
+        Struct_Socket_clients *client = &s_udp_table.entries[i];
+        if (client->in_use && client->client_addr.sin_addr.s_addr == addr->sin_addr.s_addr &&
+            client->client_addr.sin_port == addr->sin_port) {
+            return client;
+        }
+    }
+    return NULL;
+}
+
+// Function - Admit a new peer: posição na tabela e on_accept do handler
+static Struct_Socket_clients *udp_session_open(const struct sockaddr_in *addr, uint32_t conv, uint32_t now_ms) {
+
+    uint32_t ip = ntohl(addr->sin_addr.s_addr);
+    conn_admit_t admit;
+    Struct_Socket_clients *client = conn_table_alloc(&s_udp_table, addr, &admit);
+
+    if (client == NULL) {
+        ASYNC_LOGW(TAG_UDP, "%d.%d.%d.%d:%d - %s, datagrama descartado", (int)(ip >> 24), (int)((ip >> 16) & 0xFF),
+                   (int)((ip >> 8) & 0xFF), (int)(ip & 0xFF), ntohs(addr->sin_port),
+                   admit == CONN_ADMIT_IP_LIMIT ? "Limite de conexões por IP atingido" : "Limite de sessões atingido");
+        return NULL;
+    }
+    // Socket compartilhado por todas as sessões - no cliente serve só para os logs
+    client->sock_client = s_sock;
+    s_sessions[client->index].last_rx_ms = now_ms;
+#if CONFIG_SOCKET_UDP_RELIABLE
+    udp_arq_init(&s_sessions[client->index].arq, conv);
+#endif
+
+    if (!conn_io_open(client, s_listener)) {
+        conn_table_release(&s_udp_table, client);
+        return NULL;
+    }
+    ASYNC_LOGI(TAG_UDP, "[SESSION-%d] Nova sessão: %d.%d.%d.%d:%d", client->index, (int)(ip >> 24), (int)((ip >> 16) & 0xFF),
+               (int)((ip >> 8) & 0xFF), (int)(ip & 0xFF), ntohs(addr->sin_port));
+    return client;
+}
+
+static void udp_session_close(Struct_Socket_clients *client, const char *reason) {
+
+    ASYNC_LOGI(TAG_UDP, "[SESSION-%d] Sessão encerrada: %s", client->index, reason);
+    conn_io_close(client);
+    conn_table_release(&s_udp_table, client);
+}
+
+// Function - Handler callback after the TX ring drained (enviado ou confirmado pelo par)
+static void udp_session_writable(Struct_Socket_clients *client, bool tx_pending) {
+
+    const conn_listener_t *listener = client->listener;
+
+    if (tx_pending && ring_buffer_is_empty(&client->tx) && listener->handler->on_writable != NULL) {
+        listener->handler->on_writable(client, listener->ctx);
+    }
+}
+
+#if CONFIG_SOCKET_UDP_RELIABLE
+// Datagramas montados pela camada de confiabilidade
+static void udp_session_output(const uint8_t *data, uint32_t len, void *ctx) {
+
+    Struct_Socket_clients *client = ctx;
+
+    sendto(s_sock, data, len, 0, (struct sockaddr *)&client->client_addr, sizeof(client->client_addr));
+}
+#else
+// Function - Send the TX ring as datagrams of up to UDP_SERVER_MTU bytes (sem retransmissão)
+static void udp_session_send(Struct_Socket_clients *client) {
+
+    bool tx_pending = !ring_buffer_is_empty(&client->tx);
+
+    while (!ring_buffer_is_empty(&client->tx)) {
+        // Os dois segmentos do ring em um único datagrama, direto do TX ring
+        ring_buffer_view_t view;
+        ring_buffer_view(&client->tx, 0, MIN(ring_buffer_used(&client->tx), UDP_SERVER_MTU), &view);
+        struct iovec iov[2] = {
+            { .iov_base = (void *)view.ptr[0], .iov_len = view.len[0] },
+            { .iov_base = (void *)view.ptr[1], .iov_len = view.len[1] },
+        };
+        struct msghdr msg = {
+            .msg_name = &client->client_addr,
+            .msg_namelen = sizeof(client->client_addr),
+            .msg_iov = iov,
+            .msg_iovlen = view.len[1] > 0 ? 2 : 1,
+        };
+        // Sem memória para o datagrama (ENOMEM no lwIP) - tenta de novo no próximo intervalo
+        if (sendmsg(s_sock, &msg, 0) < 0) {
+            break;
+        }
+        ring_buffer_consume(&client->tx, ring_buffer_view_len(&view));
+    }
+    udp_session_writable(client, tx_pending);
+}
+#endif
+
+// Function - Run the handler over the RX ring and send what it wrote
+// Retorna false se a sessão foi encerrada
+static bool udp_session_service(Struct_Socket_clients *client, uint32_t now_ms) {
+
+    if (conn_io_process(client) != CONN_IO_OK) {
+        udp_session_close(client, "encerrada pelo handler");
+        return false;
+    }
+
+#if CONFIG_SOCKET_UDP_RELIABLE
+    udp_arq_t *arq = &s_sessions[client->index].arq;
+    udp_arq_flush(arq, &client->rx, &client->tx, now_ms, s_tx_datagram, udp_session_output, client);
+    if (udp_arq_is_dead(arq)) {
+        udp_session_close(client, "par sem resposta");
+        return false;
+    }
+#else
+    udp_session_send(client);
+#endif
+    return true;
+}
+
+// Function - Deliver one datagram to its session (criando a sessão no primeiro)
+static void udp_server_receive(uint32_t len, const struct sockaddr_in *addr, uint32_t now_ms) {
+
+    Struct_Socket_clients *client = udp_session_find(addr);
+    uint32_t conv = 0;
+
+#if CONFIG_SOCKET_UDP_RELIABLE
+    if (!udp_arq_peek_conv(s_rx_datagram, len, &conv)) {
+        return;
+    }
+    // Par reiniciado - nova sessão na mesma porta
+    if (client != NULL && s_sessions[client->index].arq.conv != conv) {
+        udp_session_close(client, "nova sessão do par");
+        client = NULL;
+    }
+#endif
+    if (client == NULL && (client = udp_session_open(addr, conv, now_ms)) == NULL) {
+        return;
+    }
+
+    udp_session_t *session = &s_sessions[client->index];
+    bool tx_pending = !ring_buffer_is_empty(&client->tx);
+
+#if CONFIG_SOCKET_UDP_RELIABLE
+    // Segmento inválido é descartado sem derrubar a sessão - pode nem ser do par
+    if (!udp_arq_input(&session->arq, &client->rx, &client->tx, s_rx_datagram, len, now_ms)) {
+        ASYNC_LOGW(TAG_UDP, "[SESSION-%d] Datagrama inválido descartado", client->index);
+        return;
+    }
+    udp_session_writable(client, tx_pending);
+#else
+    // Datagrama inteiro ou nada - sem espaço no RX ring ele se perde, como na rede
+    if (len > CONN_RX_RING_SIZE) {
+        ASYNC_LOGW(TAG_UDP, "[SESSION-%d] Datagrama de %" PRIu32 " bytes maior que o RX ring, descartado", client->index, len);
+        return;
+    }
+    if (ring_buffer_free(&client->rx) < len) {
+        ASYNC_LOGW(TAG_UDP, "[SESSION-%d] RX ring cheio, datagrama descartado", client->index);
+        return;
+    }
+    ring_buffer_write(&client->rx, s_rx_datagram, len);
+#endif
+    session->last_rx_ms = now_ms;
+    udp_session_service(client, now_ms);
+}
+
+// Function - Idle timeouts and periodic service (retransmissões, dados que esperavam espaço)
+static void udp_server_tick(uint32_t now_ms) {
+
+    for (int i = 0; i < CONN_TABLE_CAPACITY; i++) {
+        Struct_Socket_clients *client = &s_udp_table.entries[i];
+        if (!client->in_use) {
+            continue;
+        }
+        if (UDP_SERVER_IDLE_TIMEOUT_MS > 0 && now_ms - s_sessions[i].last_rx_ms >= UDP_SERVER_IDLE_TIMEOUT_MS) {
+            udp_session_close(client, "inatividade");
+            continue;
+        }
+        udp_session_service(client, now_ms);
+    }
+}
+
+// Function - How long the loop may sleep (UINT32_MAX = sem sessões)
+static uint32_t udp_server_wait_ms(void) {
+
+    uint32_t wait_ms = UINT32_MAX;
+
+    for (int i = 0; i < CONN_TABLE_CAPACITY; i++) {
+        const Struct_Socket_clients *client = &s_udp_table.entries[i];
+        if (!client->in_use) {
+            continue;
+        }
+#if CONFIG_SOCKET_UDP_RELIABLE
+        bool busy = !udp_arq_is_idle(&s_sessions[i].arq, &client->tx);
+#else
+        bool busy = !ring_buffer_is_empty(&client->tx);
+#endif
+        if (busy) {
+            return UDP_SERVER_INTERVAL_MS;
+        }
+        wait_ms = UDP_SERVER_IDLE_CHECK_MS;
+    }
+    return wait_ms;
+}
+
+// Task - UDP listener
+void task_udp_server(void* pvParameters) {
+
+    s_listener = pvParameters;
+
+    s_sock = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s_sock == -1) {
+        ASYNC_LOGE(TAG_UDP, "Não foi possível criar o Socket UDP: errno %d", errno);
+        udp_server_listen_done(ESP_FAIL);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    struct sockaddr_in socket_adr = {
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+        .sin_family = PF_INET,
+        .sin_port = htons(s_listener->port)
+    };
+    if (bind(s_sock, (struct sockaddr *)&socket_adr, sizeof(socket_adr)) != 0) {
+        ASYNC_LOGE(TAG_UDP, "Socket UDP incapaz de vincular: errno %d", errno);
+        close(s_sock);
+        udp_server_listen_done(ESP_FAIL);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // Recebe até esvaziar a fila do socket sem bloquear a task
+    fcntl(s_sock, F_SETFL, fcntl(s_sock, F_GETFL, 0) | O_NONBLOCK);
+    conn_table_init(&s_udp_table);
+
+    ASYNC_LOGI(TAG_UDP, "Escutando UDP na porta %d (%s)", s_listener->port, UDP_SERVER_MODE_NAME);
+    udp_server_listen_done(ESP_OK);
+
+    for (;;) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(s_sock, &read_fds);
+
+        uint32_t wait_ms = udp_server_wait_ms();
+        struct timeval timeout = {
+            .tv_sec = wait_ms / 1000,
+            .tv_usec = (wait_ms % 1000) * 1000,
+        };
+        int ready = select(s_sock + 1, &read_fds, NULL, NULL, wait_ms == UINT32_MAX ? NULL : &timeout);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ASYNC_LOGE(TAG_UDP, "Select falhou: errno %d", errno);
+            break;
+        }
+
+        uint32_t now_ms = udp_now_ms();
+        while (ready > 0) {
+            struct sockaddr_in client_addr;
+            socklen_t client_addr_len = sizeof(client_addr);
+            int len = recvfrom(s_sock, s_rx_datagram, sizeof(s_rx_datagram), 0, (struct sockaddr *)&client_addr, &client_addr_len);
+            if (len < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    ASYNC_LOGE(TAG_UDP, "Recvfrom falhou: errno %d", errno);
+                }
+                break;
+            }
+            udp_server_receive(len, &client_addr, now_ms);
+        }
+
+        udp_server_tick(now_ms);
+    }
+
+    // Task error - encerra as sessões
+    for (int i = 0; i < CONN_TABLE_CAPACITY; i++) {
+        if (s_udp_table.entries[i].in_use) {
+            udp_session_close(&s_udp_table.entries[i], "listener encerrado");
+        }
+    }
+    close(s_sock);
+    vTaskDelete(NULL);
+}
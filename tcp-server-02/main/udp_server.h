@@ -0,0 +1,21 @@
+#pragma once
+
+#include "esp_err.h"
+
+#include "conn_io.h"
+
+// Listener UDP - uma única task atende todos os pares. Cada par (IP, porta) vira uma sessão
+// com uma posição em uma tabela de conexões própria (mesmos rings, limite por IP e handlers
+// do TCP): o handler do listener recebe on_accept no primeiro datagrama, on_data com o RX
+// ring e on_close quando a sessão expira por inatividade.
+//
+// Sem SOCKET_UDP_RELIABLE cada datagrama recebido é acrescentado ao RX ring (inteiro ou
+// descartado) e o TX ring sai em datagramas de até SOCKET_UDP_MTU bytes, sem retransmissão.
+// Com SOCKET_UDP_RELIABLE o fluxo passa pela camada de confiabilidade (udp_arq.h).
+
+// Task do listener - pvParameters: const conn_listener_t * (porta e handler)
+void task_udp_server(void* pvParameters);
+
+// Orquestrador de inicialização - a task avisa o bind (ESP_OK) ou a falha antes dele; o estágio
+// dos listeners só fecha depois do TCP e do UDP
+void udp_server_listen_done(esp_err_t err);